@@ -83,61 +83,29 @@ bool scanRays(const Bitboards& bb, int8_t from, Piece piece, uint64_t occAll) {
 }
 
 // Used for returning occupancy of piece attacks on sq
+// Attacks are symmetric, so the pieces attacking sq are those sq would attack as the same piece
+// (pawns: as a pawn of the other color).
 uint64_t scanAttacks(const Bitboards& bb, int8_t sq, Piece piece, uint64_t occAll) {
-    const int8_t* DELTAS = nullptr; uint8_t NUM_DELTAS; uint8_t maxSteps = 0;
-    getDeltasAndSteps(piece, DELTAS, NUM_DELTAS, maxSteps);
-
-    uint64_t attacksByPiece = 0;
-
-    // Knights
-    if (isKnight(piece)) {
-        for (size_t i = 0; i < NUM_DELTAS; ++i) {
-            int8_t to = sq + DELTAS[i];
-            if (squareInBoard(to) && knightHopValid(sq, to) &&
-                (bb[to_u(piece)] & (1ULL << to)))
-                attacksByPiece |= (1ULL << to);
-            }
-        return attacksByPiece;
-    }
-    // Pawns, reverse direction (same in scanRays)
-    if (isPawn(piece)) {
-        for (size_t i = 0; i < NUM_DELTAS; ++i) {
-            int8_t to = sq - DELTAS[i];
-            if (squareInBoard(to) && diagHopValid(sq, to) &&
-                (bb[to_u(piece)] & (1ULL << to)))
-                attacksByPiece |= (1ULL << to);
-            }
-        return attacksByPiece;
-    }
+    if (isPawn(piece)) return pawnAttacks(!isWhite(piece), sq) & bb[to_u(piece)];
+    return attacksFrom(piece, sq, occAll) & bb[to_u(piece)];
+}
 
-    for (size_t i = 0; i < NUM_DELTAS; ++i) {
-        int8_t dx = dxStepFromDelta(DELTAS[i]);
-        int8_t prevSq = sq;
-        int8_t nextSq = sq;
-        for (size_t step = 0; step < maxSteps; ++step) {
-            nextSq += DELTAS[i];
-            if (!squareInBoard(nextSq) || wrapped(prevSq, nextSq, DELTAS[i])) break; // out of bounds
-            if (bb[to_u(piece)] & (1ULL << nextSq)) {// piece occupies this square
-                attacksByPiece |= (1ULL << nextSq);
-                break;
-            }
-            if (occupied(occAll, nextSq)) // blocked by any piece
-                break;
-            prevSq += DELTAS[i];
-        }
+uint64_t attacksFrom(Piece piece, uint8_t sq, uint64_t occAll) {
+    switch (piece) {
+        case WP: case BP: return pawnAttacks(isWhite(piece), sq);
+        case WN: case BN: return knightAttacks(sq);
+        case WB: case BB: return bishopAttacks(sq, occAll);
+        case WR: case BR: return rookAttacks(sq, occAll);
+        case WQ: case BQ: return queenAttacks(sq, occAll);
+        case WK: case BK: return kingAttacks(sq);
+        default: return 0;
     }
-    return attacksByPiece;
 }
 
-bool isSquareAttacked(Bitboards& bb, uint8_t sq, bool meWhite, uint64_t occAll) {
+bool isSquareAttacked(const Bitboards& bb, uint8_t sq, bool meWhite, uint64_t occAll) {
     return attackersTo(bb, sq, meWhite, occAll) != 0;
 }
 
-uint64_t attackersTo(Bitboards& bb, uint8_t kingSq, bool meWhite, uint64_t occAll) {
-    return scanAttacks(bb, kingSq, getEnemyPawn(meWhite),   occAll)
-         | scanAttacks(bb, kingSq, getEnemyRook(meWhite),   occAll)
-         | scanAttacks(bb, kingSq, getEnemyKnight(meWhite), occAll)
-         | scanAttacks(bb, kingSq, getEnemyBishop(meWhite), occAll)
-         | scanAttacks(bb, kingSq, getEnemyQueen(meWhite),  occAll)
-         | scanAttacks(bb, kingSq, getEnemyKing(meWhite),   occAll);
+uint64_t attackersTo(const Bitboards& bb, uint8_t kingSq, bool meWhite, uint64_t occAll) {
+    return meWhite ? attackersTo<Color::White>(bb, kingSq, occAll) : attackersTo<Color::Black>(bb, kingSq, occAll);
 }
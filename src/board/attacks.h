@@ -5,14 +5,122 @@
 #ifndef TEMPO_CHECK_H
 #define TEMPO_CHECK_H
 
+#include "stats.h"
 #include "types.h"
 #include "utils.h"
+#include <bit>
 #include <vector>
 #include <span>
 
 using enum Piece;
 using Bitboards = std::array<uint64_t, 12>;
 
+// ---------- Attack Tables ----------
+// Leapers read their attack set from a per-square table. Sliders use a ray per direction: the
+// attack set is the ray cut at its first blocker, found with a bitscan in the ray's direction.
+
+// (file, rank) steps; the first four increase the square index, the last four decrease it
+inline constexpr std::array<std::array<int8_t, 2>, 8> RAY_STEPS = {{
+    { 0, +1 }, { +1, 0 }, { +1, +1 }, { -1, +1 },
+    { 0, -1 }, { -1, 0 }, { -1, -1 }, { +1, -1 },
+}};
+inline constexpr std::array<uint8_t, 4> ROOK_RAYS = { 0, 1, 4, 5 };
+inline constexpr std::array<uint8_t, 4> BISHOP_RAYS = { 2, 3, 6, 7 };
+
+using SquareTable = std::array<uint64_t, NUM_SQUARES>;
+
+constexpr SquareTable buildLeaperTable(std::span<const std::array<int8_t, 2>> steps) {
+    SquareTable table{};
+    for (uint8_t s = 0; s < NUM_SQUARES; ++s)
+        for (auto [df, dr] : steps) {
+            const int f = fileOf(s) + df, r = rankOf(s) + dr;
+            if (0 <= f && f < NUM_SQUARES_IN_ROW && 0 <= r && r < NUM_SQUARES_IN_ROW) table[s] |= 1ULL << sq(f, r);
+        }
+    return table;
+}
+
+inline constexpr std::array<std::array<int8_t, 2>, 8> KNIGHT_STEPS = {{
+    { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 },
+}};
+inline constexpr std::array<std::array<int8_t, 2>, 2> WHITE_PAWN_STEPS = {{ { 1, 1 }, { -1, 1 } }};
+inline constexpr std::array<std::array<int8_t, 2>, 2> BLACK_PAWN_STEPS = {{ { 1, -1 }, { -1, -1 } }};
+
+inline constexpr SquareTable KNIGHT_ATTACKS = buildLeaperTable(KNIGHT_STEPS);
+inline constexpr SquareTable KING_ATTACKS = buildLeaperTable(RAY_STEPS);
+inline constexpr std::array<SquareTable, 2> PAWN_ATTACKS = { buildLeaperTable(WHITE_PAWN_STEPS), buildLeaperTable(BLACK_PAWN_STEPS) };
+
+inline constexpr std::array<SquareTable, 8> RAYS = [] {
+    std::array<SquareTable, 8> rays{};
+    for (size_t dir = 0; dir < RAY_STEPS.size(); ++dir)
+        for (uint8_t s = 0; s < NUM_SQUARES; ++s) {
+            int f = fileOf(s) + RAY_STEPS[dir][0], r = rankOf(s) + RAY_STEPS[dir][1];
+            for (; 0 <= f && f < NUM_SQUARES_IN_ROW && 0 <= r && r < NUM_SQUARES_IN_ROW; f += RAY_STEPS[dir][0], r += RAY_STEPS[dir][1])
+                rays[dir][s] |= 1ULL << sq(f, r);
+        }
+    return rays;
+}();
+
+inline uint64_t rayAttacks(uint8_t dir, uint8_t square, uint64_t occAll) {
+    const uint64_t ray = RAYS[dir][square];
+    const uint64_t blockers = ray & occAll;
+    if (!blockers) return ray;
+    const int blocker = dir < 4 ? std::countr_zero(blockers) : 63 - std::countl_zero(blockers);
+    return ray ^ RAYS[dir][blocker];
+}
+
+// Squares strictly between two squares on a common rank, file or diagonal, and the full line through
+// them (both ends included); 0 when the squares are not aligned
+inline constexpr std::array<SquareTable, NUM_SQUARES> BETWEEN = [] {
+    std::array<SquareTable, NUM_SQUARES> between{};
+    for (uint8_t a = 0; a < NUM_SQUARES; ++a)
+        for (size_t dir = 0; dir < RAY_STEPS.size(); ++dir)
+            for (uint64_t ray = RAYS[dir][a]; ray; ray &= ray - 1) {
+                const int b = std::countr_zero(ray);
+                between[a][b] = RAYS[dir][a] & RAYS[(dir + 4) % 8][b];
+            }
+    return between;
+}();
+
+inline constexpr std::array<SquareTable, NUM_SQUARES> LINE = [] {
+    std::array<SquareTable, NUM_SQUARES> line{};
+    for (uint8_t a = 0; a < NUM_SQUARES; ++a)
+        for (size_t dir = 0; dir < RAY_STEPS.size(); ++dir)
+            for (uint64_t ray = RAYS[dir][a]; ray; ray &= ray - 1)
+                line[a][std::countr_zero(ray)] = RAYS[dir][a] | RAYS[(dir + 4) % 8][a] | (1ULL << a);
+    return line;
+}();
+
+inline uint64_t betweenSquares(uint8_t a, uint8_t b) { return BETWEEN[a][b]; }
+inline uint64_t lineThrough(uint8_t a, uint8_t b) { return LINE[a][b]; }
+
+inline uint64_t pawnAttacks(bool meWhite, uint8_t square) { return PAWN_ATTACKS[meWhite ? 0 : 1][square]; }
+inline uint64_t knightAttacks(uint8_t square) { return KNIGHT_ATTACKS[square]; }
+inline uint64_t kingAttacks(uint8_t square) { return KING_ATTACKS[square]; }
+inline uint64_t rookAttacks(uint8_t square, uint64_t occAll) {
+    return rayAttacks(0, square, occAll) | rayAttacks(1, square, occAll) | rayAttacks(4, square, occAll) | rayAttacks(5, square, occAll);
+}
+inline uint64_t bishopAttacks(uint8_t square, uint64_t occAll) {
+    return rayAttacks(2, square, occAll) | rayAttacks(3, square, occAll) | rayAttacks(6, square, occAll) | rayAttacks(7, square, occAll);
+}
+inline uint64_t queenAttacks(uint8_t square, uint64_t occAll) { return rookAttacks(square, occAll) | bishopAttacks(square, occAll); }
+
+// Squares attacked by a whole set of pawns
+template <Color Us>
+inline uint64_t pawnSetAttacks(uint64_t pawns) {
+    constexpr bool white = Us == Color::White;
+    return shift<white ? 9 : -7>(pawns & ~FILE_A_MASK) | shift<white ? 7 : -9>(pawns & ~FILE_H_MASK);
+}
+
+// Attacks of a piece known at compile time, either color; pawns take their color through pawnAttacks
+template <Piece P>
+inline uint64_t pieceAttacks(uint8_t square, uint64_t occAll) {
+    if constexpr (P == WN || P == BN) return knightAttacks(square);
+    else if constexpr (P == WB || P == BB) return bishopAttacks(square, occAll);
+    else if constexpr (P == WR || P == BR) return rookAttacks(square, occAll);
+    else if constexpr (P == WQ || P == BQ) return queenAttacks(square, occAll);
+    else { static_assert(P == WK || P == BK, "pieceAttacks excludes pawns"); return kingAttacks(square); }
+}
+
 void getDeltasAndSteps(Piece piece, const int8_t*& DELTAS, uint8_t& NUM_DELTAS, uint8_t& maxSteps);
 
 // Used for detecting rays of piece attacks on from
@@ -21,8 +129,24 @@ bool scanRays(const Bitboards& bb, int8_t from, Piece piece, uint64_t occAll);
 // Used for returning occupancy of piece attacks on sq
 uint64_t scanAttacks(const Bitboards& bb, int8_t sq, Piece piece, uint64_t occAll);
 
-bool isSquareAttacked(Bitboards& bb, uint8_t sq, bool meWhite, uint64_t occAll);
+// Squares attacked by piece standing on sq, blockers included (pawns: capture squares only)
+uint64_t attacksFrom(Piece piece, uint8_t sq, uint64_t occAll);
+
+// Enemy pieces (of the side that is not Us) attacking sq
+template <Color Us>
+inline uint64_t attackersTo(const Bitboards& bb, uint8_t sq, uint64_t occAll) {
+    TEMPO_STAT(AttackersTo);
+    constexpr size_t them = Us == Color::White ? BP_CODE : WP_CODE;
+    return (pawnAttacks(Us == Color::White, sq) & bb[them + WP_CODE])
+         | (knightAttacks(sq) & bb[them + WN_CODE])
+         | (kingAttacks(sq) & bb[them + WK_CODE])
+         | (rookAttacks(sq, occAll) & (bb[them + WR_CODE] | bb[them + WQ_CODE]))
+         | (bishopAttacks(sq, occAll) & (bb[them + WB_CODE] | bb[them + WQ_CODE]));
+}
+
+bool isSquareAttacked(const Bitboards& bb, uint8_t sq, bool meWhite, uint64_t occAll);
 
-uint64_t attackersTo(Bitboards& bb, uint8_t kingSq, bool meWhite, uint64_t occAll);
+// Enemy pieces (of the side that is not meWhite) attacking sq
+uint64_t attackersTo(const Bitboards& bb, uint8_t kingSq, bool meWhite, uint64_t occAll);
 
 #endif //TEMPO_CHECK_H
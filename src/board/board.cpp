@@ -4,12 +4,18 @@
 
 #include "attacks.h"
 #include "board.h"
+#include "fill.h"
 #include "utils.h"
 #include "movegen.h"
 #include "move.h"
+#include "stats.h"
 #include "types.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
 #include <iostream>
 #include <queue>
+#include <string>
 
 // file and rank is [0,7]
 
@@ -18,244 +24,783 @@ using enum Piece;
 void Board::calcOcc() {
     occWhite = bb[to_u(WP)] | bb[to_u(WR)] | bb[to_u(WN)] | bb[to_u(WB)] |
                bb[to_u(WQ)] | bb[to_u(WK)];
-    occBlack = bb[to_u(BP)] | bb[to_u(BR)] | bb[to_u(BN)] | bb[to_u(BB)] |
-               bb[to_u(BQ)] | bb[to_u(BK)];
-    occAll = occWhite | occBlack;
+    occAll = occWhite | bb[to_u(BP)] | bb[to_u(BR)] | bb[to_u(BN)] | bb[to_u(BB)] |
+             bb[to_u(BQ)] | bb[to_u(BK)];
+    attackCacheValid = 0; // every change of the pieces goes through here
 }
 
 inline void Board::removeCastlingFlag (uint8_t flag) {
     if (!(castling & flag)) return;
-    uint8_t idx =
-        (flag == W_K_FLAG) ? 0 :
-        (flag == W_Q_FLAG) ? 1 :
-        (flag == B_K_FLAG) ? 2 : 3; // flag == B_Q_FLAG
-    key ^= zobrist.castling[idx];
+    key ^= zobrist->castling[std::countr_zero(flag)];
     castling &= ~flag;
 }
 
-void Board::move(uint32_t move) {
+// Rook squares of a castling king move
+static void castlingRookSquares(uint8_t from, uint8_t to, uint8_t& rookFrom, uint8_t& rookTo) {
+    const bool kingSide = fileOf(to) < fileOf(from);
+    rookFrom = sq(fileOf(to) + (kingSide ? -1 : +2), rankOf(from));
+    rookTo = sq(fileOf(to) + (kingSide ? +1 : -1), rankOf(from));
+}
+
+// Square of the pawn taken by an en passant capture landing on to
+static uint8_t epVictimSquare(uint8_t to, bool meWhite) {
+    return meWhite ? to - NUM_SQUARES_IN_ROW : to + NUM_SQUARES_IN_ROW;
+}
+
+template <Color Us>
+void Board::doMove(uint32_t move) {
+    constexpr bool white = Us == Color::White;
+    constexpr uint8_t pawnCode = to_u(colored(WP, Us));
+    constexpr uint8_t rookCode = to_u(colored(WR, Us));
+    constexpr uint8_t kingCode = to_u(colored(WK, Us));
+    constexpr uint8_t theirRookCode = to_u(colored(WR, ~Us));
+    constexpr uint8_t kingSideFlag = white ? W_K_FLAG : B_K_FLAG, queenSideFlag = white ? W_Q_FLAG : B_Q_FLAG;
+    constexpr uint8_t theirKingSideFlag = white ? B_K_FLAG : W_K_FLAG, theirQueenSideFlag = white ? B_Q_FLAG : W_Q_FLAG;
+    constexpr uint8_t kingSideRook = white ? h1 : h8, queenSideRook = white ? a1 : a8;
+    constexpr uint8_t theirKingSideRook = white ? h8 : h1, theirQueenSideRook = white ? a8 : a1;
+
     const auto from = Move::from(move);
     const auto to = Move::to(move);
     const auto movedCode = Move::movedCode(move);
     const auto isCapture = Move::isCapture(move);
-    const auto isCastle = Move::isCastle(move);
-    const auto isDPP = Move::isDPP(move);
-    const auto isEP = Move::isEP(move);
     const auto promoCode = Move::promo(move);
     const auto capturedCode = Move::capturedCode(move);
 
-    State st{key, castling, epSquare, halfMoveClock, capturedCode};
-    gameRecord.push(st);
+    TEMPO_STAT(MakeMove);
+    State st{key, castling, epSquare, halfMoveClock, pliesFromNull, capturedCode};
+    gameRecord.push_back(st);
 
     // 1) If En Passant square is set, clear it
     if (epSquare != NUM_SQUARES) {
-        key ^= zobrist.epFile[fileOf(epSquare)];  // assuming ep hash is file-based
+        key ^= zobrist->epFile[fileOf(epSquare)];  // assuming ep hash is file-based
         epSquare = NUM_SQUARES;
     }
 
     // 2) Move current piece
-    key ^= zobrist.pieces[movedCode][from];
-    key ^= zobrist.pieces[movedCode][to];
-    bb[movedCode] ^= (1ULL << from);
-    bb[movedCode] ^= (1ULL << to);
+    key ^= zobrist->pieces[movedCode][from];
+    key ^= zobrist->pieces[movedCode][to];
+    bb[movedCode] ^= (1ULL << from) | (1ULL << to);
 
     // 3) Capture
     if (isCapture) {
-        uint8_t captureSq = to;
-        if (isEP)
-            captureSq = (movedCode == to_u(WP))
-                    ? (to - NUM_SQUARES_IN_ROW)
-                    : (to + NUM_SQUARES_IN_ROW);
-        key ^= zobrist.pieces[capturedCode][captureSq];
+        const uint8_t captureSq = Move::isEP(move) ? epVictimSquare(to, white) : to;
+        key ^= zobrist->pieces[capturedCode][captureSq];
         bb[capturedCode] ^= (1ULL << captureSq);
     }
 
     // 4) Castling, move the rook
-    if (isCastle) {
-        const uint8_t r = rankOf(from);
-        const uint8_t fFrom = fileOf(from);
-        const uint8_t fTo = fileOf(to);
-        bool kingSide = (fTo < fFrom);
-
-        const uint8_t rookFromSq = sq(fTo + (kingSide ? -1 : +2), r);
-        const uint8_t rookToSq   = sq(fTo + (kingSide ? +1 : -1), r);
-        const auto rookCode = isWhite(static_cast<Piece>(movedCode)) ? to_u(WR) : to_u(BR);
-
-        key ^= zobrist.pieces[rookCode][rookFromSq];
-        key ^= zobrist.pieces[rookCode][rookToSq];
-        bb[rookCode] ^= (1ULL << rookFromSq);
-        bb[rookCode] ^= (1ULL << rookToSq);
+    if (Move::isCastle(move)) {
+        uint8_t rookFromSq, rookToSq;
+        castlingRookSquares(from, to, rookFromSq, rookToSq);
+        key ^= zobrist->pieces[rookCode][rookFromSq];
+        key ^= zobrist->pieces[rookCode][rookToSq];
+        bb[rookCode] ^= (1ULL << rookFromSq) | (1ULL << rookToSq);
     }
 
     // 5) Double pawn push, set en passant square
-    if (isDPP) {
-        epSquare = (movedCode == to_u(WP))
-                ? (to - NUM_SQUARES_IN_ROW)
-                : (to + NUM_SQUARES_IN_ROW);
-        key ^= zobrist.epFile[fileOf(epSquare)];
+    if (Move::isDPP(move)) {
+        epSquare = white ? to - NUM_SQUARES_IN_ROW : to + NUM_SQUARES_IN_ROW; // the square passed over
+        key ^= zobrist->epFile[fileOf(epSquare)];
     }
 
     // 6) Promotion
-    if (promoCode != 0x7) {
-        key ^= zobrist.pieces[movedCode][to];
-        key ^= zobrist.pieces[promoCode][to];
+    if (promoCode != Move::PROMO_MASK) {
+        const auto promoPiece = promoPieceCode(promoCode, white);
+        key ^= zobrist->pieces[movedCode][to];
+        key ^= zobrist->pieces[promoPiece][to];
         bb[movedCode] ^= (1ULL << to);
-        bb[promoCode] ^= (1ULL << to);
+        bb[promoPiece] ^= (1ULL << to);
     }
 
-    // 7) Castling flag logic
-
-    // If a king moved
-    if (movedCode == to_u(WK)) { removeCastlingFlag(W_K_FLAG); removeCastlingFlag(W_Q_FLAG); }
-    if (movedCode == to_u(BK)) { removeCastlingFlag(B_K_FLAG); removeCastlingFlag(B_Q_FLAG); }
-
-    // If a rook moved from its original square
-    if (movedCode == to_u(WR)) {
-        if (from == h1) removeCastlingFlag(W_K_FLAG);
-        if (from == a1) removeCastlingFlag(W_Q_FLAG);
-    }
-    if (movedCode == to_u(BR)) {
-        if (from == h8) removeCastlingFlag(B_K_FLAG);
-        if (from == a8) removeCastlingFlag(B_Q_FLAG);
-    }
-
-    // If a rook was captured on its original square
-    if (isCapture) {
-        if (capturedCode == to_u(WR)) {
-            if (to == h1) removeCastlingFlag(W_K_FLAG);
-            if (to == a1) removeCastlingFlag(W_Q_FLAG);
-        } else if (capturedCode == to_u(BR)) {
-            if (to == h8) removeCastlingFlag(B_K_FLAG);
-            if (to == a8) removeCastlingFlag(B_Q_FLAG);
+    // 7) Castling flag logic: a king move, a rook leaving home or a rook captured at home
+    if (castling) {
+        if (movedCode == kingCode) { removeCastlingFlag(kingSideFlag); removeCastlingFlag(queenSideFlag); }
+        if (movedCode == rookCode) {
+            if (from == kingSideRook) removeCastlingFlag(kingSideFlag);
+            if (from == queenSideRook) removeCastlingFlag(queenSideFlag);
+        }
+        if (capturedCode == theirRookCode) {
+            if (to == theirKingSideRook) removeCastlingFlag(theirKingSideFlag);
+            if (to == theirQueenSideRook) removeCastlingFlag(theirQueenSideFlag);
         }
     }
 
-    // 8) Side to move
-    whiteToMove = !whiteToMove;
-    key ^= zobrist.blackToMove;
+    // 8) Move counters
+    if (isCapture || movedCode == pawnCode) halfMoveClock = 0;
+    else ++halfMoveClock;
+    ++pliesFromNull;
+    if constexpr (!white) ++fullMoveTotal;
+
+    // 9) Side to move
+    whiteToMove = !white;
+    key ^= zobrist->blackToMove;
 
-    // 9) Update occupancies
+    // 10) Update occupancies
     calcOcc();
 }
 
-void Board::undoMove(uint32_t move) {
+template <Color Us>
+void Board::doUndoMove(uint32_t move) {
+    constexpr bool white = Us == Color::White;
+    constexpr uint8_t rookCode = to_u(colored(WR, Us));
+
     const auto from = Move::from(move);
     const auto to = Move::to(move);
     const auto movedCode = Move::movedCode(move);
-    const auto isCapture = Move::isCapture(move);
-    const auto isCastle = Move::isCastle(move);
-    const auto isDPP = Move::isDPP(move);
-    const auto isEP = Move::isEP(move);
     const auto promoCode = Move::promo(move);
     const auto capturedCode = Move::capturedCode(move);
 
+    TEMPO_STAT(UnmakeMove);
+
     // flip turn back
-    whiteToMove = !whiteToMove;
+    whiteToMove = white;
+    if constexpr (!white) --fullMoveTotal;
 
-    // get hashing, castling, en passant square, and halfMoveClock from state
-    State st = gameRecord.top();
-    gameRecord.pop();
+    // get hashing, castling, en passant square, and move counters from state
+    const State& st = gameRecord.back();
     key = st.zobrist;
     castling = st.castling;
     epSquare = st.epSquare;
     halfMoveClock = st.halfmoveClock;
+    pliesFromNull = st.pliesFromNull;
+    gameRecord.pop_back();
 
     // Undo special cases
     // 1) Promotion
-    if (promoCode != 0x7) { // if promotion existed
-        bb[promoCode] ^= (1ULL << to);
+    if (promoCode != Move::PROMO_MASK) { // if promotion existed
+        bb[promoPieceCode(promoCode, white)] ^= (1ULL << to);
         bb[movedCode] ^= (1ULL << to);
     }
 
     // 2) Undo capture (including EP): restore captured piece on its square
-    if (isCapture) {
-        uint8_t captureSq = to;
-        if (isEP) {
-            captureSq = (movedCode == to_u(WP))
-                        ? (to - NUM_SQUARES_IN_ROW)
-                        : (to + NUM_SQUARES_IN_ROW);
-        }
-        bb[capturedCode] ^= (1ULL << captureSq);
-    }
+    if (Move::isCapture(move))
+        bb[capturedCode] ^= 1ULL << (Move::isEP(move) ? epVictimSquare(to, white) : to);
 
     // 3) Undo rook move from castling
-    if (isCastle) {
-        const uint8_t r = rankOf(from);
-        const uint8_t fFrom = fileOf(from);
-        const uint8_t fTo   = fileOf(to);
-        bool kingSide = (fTo < fFrom);
-
-        const uint8_t rookFromSq = sq(kingSide ? (fTo - 1) : (fTo + 2), r);
-        const uint8_t rookToSq   = sq(kingSide ? (fTo + 1) : (fTo - 1), r);
-        const auto rookCode = (movedCode <= to_u(WK)) ? to_u(WR) : to_u(BR);
-        bb[rookCode] ^= (1ULL << rookFromSq);
-        bb[rookCode] ^= (1ULL << rookToSq);
+    if (Move::isCastle(move)) {
+        uint8_t rookFromSq, rookToSq;
+        castlingRookSquares(from, to, rookFromSq, rookToSq);
+        bb[rookCode] ^= (1ULL << rookFromSq) | (1ULL << rookToSq);
     }
 
     // 4) Undo the piece move itself
-    bb[movedCode] ^= (1ULL << to);
-    bb[movedCode] ^= (1ULL << from);
+    bb[movedCode] ^= (1ULL << to) | (1ULL << from);
 
     // 5) Recompute occupancies
     calcOcc();
 }
 
+void Board::move(uint32_t move) {
+    if (whiteToMove) doMove<Color::White>(move);
+    else doMove<Color::Black>(move);
+}
+
+// The side that made the move is no longer to move
+void Board::undoMove(uint32_t move) {
+    if (whiteToMove) doUndoMove<Color::Black>(move);
+    else doUndoMove<Color::White>(move);
+}
+
+void Board::makeNullMove() {
+    gameRecord.push_back({key, castling, epSquare, halfMoveClock, pliesFromNull, to_u(Piece::None)});
+    if (epSquare != NUM_SQUARES) {
+        key ^= zobrist->epFile[fileOf(epSquare)];
+        epSquare = NUM_SQUARES;
+    }
+    ++halfMoveClock;
+    pliesFromNull = 0;
+    whiteToMove = !whiteToMove;
+    key ^= zobrist->blackToMove;
+}
+
+void Board::undoNullMove() {
+    const State& st = gameRecord.back();
+    key = st.zobrist;
+    epSquare = st.epSquare;
+    halfMoveClock = st.halfmoveClock;
+    pliesFromNull = st.pliesFromNull;
+    gameRecord.pop_back();
+    whiteToMove = !whiteToMove;
+}
+
+int Board::repetitions() const {
+    const size_t end = std::min<size_t>({ halfMoveClock, pliesFromNull, gameRecord.size() });
+    int count = 0;
+    // gameRecord.back() holds the position one ply ago; the same side was to move two plies ago
+    for (size_t back = 2; back <= end; back += 2)
+        count += gameRecord[gameRecord.size() - back].zobrist == key;
+    return count;
+}
+
+// Attack sets of every piece type of one side. Sliders look through the enemy king, so a king
+// stepping back along a check ray still sees the square as attacked.
+template <Piece P>
+static uint64_t setAttacks(uint64_t pieces, uint64_t occ) {
+    uint64_t attacks = 0;
+    forEachSetBit(pieces, [&](uint8_t from) { attacks |= pieceAttacks<P>(from, occ); });
+    return attacks;
+}
+
+// The side map is what king safety asks for, so it is built in one pass: all sliders at once by
+// fills, the rest set-wise. The per-piece maps are only filled in when someone asks for one.
+template <Color Side>
+void Board::computeAttacks() const {
+    constexpr size_t base = Side == Color::White ? WP_CODE : BP_CODE;
+    const uint64_t occ = occAll ^ bb[to_u(colored(WK, ~Side))];
+    const uint64_t queens = bb[base + WQ_CODE];
+
+    sideAttackCache[to_u(Side)] = pawnSetAttacks<Side>(bb[base + WP_CODE])
+            | setAttacks<colored(WN, Side)>(bb[base + WN_CODE], occ)
+            | setAttacks<colored(WK, Side)>(bb[base + WK_CODE], occ)
+            | slidingAttacks(bb[base + WR_CODE] | queens, bb[base + WB_CODE] | queens, occ);
+    attackCacheValid |= 1 << to_u(Side);
+}
+
+template <Color Side>
+void Board::computePieceAttacks() const {
+    constexpr size_t base = Side == Color::White ? WP_CODE : BP_CODE;
+    const uint64_t occ = occAll ^ bb[to_u(colored(WK, ~Side))];
+
+    pieceAttackCache[base + WP_CODE] = pawnSetAttacks<Side>(bb[base + WP_CODE]);
+    pieceAttackCache[base + WR_CODE] = setAttacks<colored(WR, Side)>(bb[base + WR_CODE], occ);
+    pieceAttackCache[base + WN_CODE] = setAttacks<colored(WN, Side)>(bb[base + WN_CODE], occ);
+    pieceAttackCache[base + WB_CODE] = setAttacks<colored(WB, Side)>(bb[base + WB_CODE], occ);
+    pieceAttackCache[base + WQ_CODE] = setAttacks<colored(WQ, Side)>(bb[base + WQ_CODE], occ);
+    pieceAttackCache[base + WK_CODE] = setAttacks<colored(WK, Side)>(bb[base + WK_CODE], occ);
+    attackCacheValid |= 4 << to_u(Side);
+}
+
+uint64_t Board::attackedBy(Color side) const {
+    if (!(attackCacheValid & (1 << to_u(side)))) {
+        if (side == Color::White) computeAttacks<Color::White>();
+        else computeAttacks<Color::Black>();
+    }
+    return sideAttackCache[to_u(side)];
+}
+
+uint64_t Board::attackedByPiece(Piece piece) const {
+    const Color side = isWhite(piece) ? Color::White : Color::Black;
+    if (!(attackCacheValid & (4 << to_u(side)))) {
+        if (side == Color::White) computePieceAttacks<Color::White>();
+        else computePieceAttacks<Color::Black>();
+    }
+    return pieceAttackCache[to_u(piece)];
+}
+
+// Our pieces standing alone between our king and an enemy slider on the same line
+template <Color Us>
+uint64_t Board::pinnedPieces(uint8_t kingSq) const {
+    constexpr size_t them = Us == Color::White ? BP_CODE : WP_CODE;
+    const uint64_t ours = Us == Color::White ? occWhite : occBlack();
+    const uint64_t snipers =
+            (rookAttacks(kingSq, 0) & (bb[them + WR_CODE] | bb[them + WQ_CODE])) |
+            (bishopAttacks(kingSq, 0) & (bb[them + WB_CODE] | bb[them + WQ_CODE]));
+    uint64_t pinned = 0;
+    forEachSetBit(snipers, [&](uint8_t s) {
+        const uint64_t blockers = betweenSquares(kingSq, s) & occAll;
+        if (std::has_single_bit(blockers) && (blockers & ours)) pinned |= blockers;
+    });
+    return pinned;
+}
+
+// King moves and castling come out of the generator already legal against the attack map. Of the
+// rest only pinned pieces need a look: they must stay on the line through their king and the pinner.
+template <Color Us>
+void Board::genLegal(MoveList& out) {
+    const uint8_t kingSq = bitscanForward(bb[to_u(colored(WK, Us))]);
+    const uint64_t danger = attackedBy(~Us);
+
+    out.clear();
+    if (danger & (1ULL << kingSq)) {
+        TEMPO_STAT(EvasionNodes);
+        MoveGen(*this).genEvasions<Us>(out, kingSq, danger);
+    } else {
+        TEMPO_STAT(NormalNodes);
+        MoveGen(*this).genPseudoMoves<Us>(out, danger);
+    }
+#ifdef TEMPO_STATS
+    for (auto m : out) stats::add(static_cast<Stat>(Move::movedCode(m) % 6));
+    const size_t generated = out.size();
+#endif
+
+    const uint64_t pinned = pinnedPieces<Us>(kingSq);
+    std::erase_if(out, [&](uint32_t m) {
+        if (Move::isEP(m)) return !isLegal(m); // may uncover a rank attack through both pawns
+        const uint8_t from = Move::from(m);
+        return (pinned & (1ULL << from)) && !(lineThrough(kingSq, from) & (1ULL << Move::to(m)));
+    });
+    TEMPO_STAT_ADD(LegalityRejections, generated - out.size());
+}
+
 void Board::genLegalMoves(MoveList& out) {
-    MoveList moves;
-    moves.reserve(218); // Maximum number of pseudolegal moves for a single turn in chess
+    if (whiteToMove) genLegal<Color::White>(out);
+    else genLegal<Color::Black>(out);
+}
 
-    uint8_t kingSq = kingSquare(bb, whiteToMove);
-    if (isSquareAttacked(bb, kingSq, whiteToMove, occAll))
-        movegen.genEvasions(moves, kingSq);
-    else movegen.genPseudoMoves(moves);
+// Out of check the generator's checks are exact but for promotions, en passant and castling, which
+// givesCheck settles. Evasions are few, each is tested.
+template <Color Us>
+void Board::genChecks(MoveList& out) {
+    const uint8_t kingSq = bitscanForward(bb[to_u(colored(WK, Us))]);
+    const uint64_t danger = attackedBy(~Us);
+    const bool evading = danger & (1ULL << kingSq);
 
     out.clear();
-    out.reserve(moves.size());
-
-    for (auto m : moves) {
-        move(m);
-        const bool prevUs = !whiteToMove; // Side to move was changed
-        const uint8_t ksqAfter = kingSquare(bb, prevUs);
-        if (!isSquareAttacked(bb, ksqAfter, prevUs, occAll))
-            out.push_back(m);
-        undoMove(m);
+    if (evading) MoveGen(*this).genEvasions<Us>(out, kingSq, danger);
+    else MoveGen(*this).genChecks<Us>(out, danger);
+
+    const uint64_t pinned = pinnedPieces<Us>(kingSq);
+    std::erase_if(out, [&](uint32_t m) {
+        if (Move::isEP(m)) return !isLegal(m) || !givesCheck(m);
+        const uint8_t from = Move::from(m);
+        if ((pinned & (1ULL << from)) && !(lineThrough(kingSq, from) & (1ULL << Move::to(m)))) return true;
+        const bool exact = !evading && Move::promo(m) == Move::PROMO_MASK && !Move::isCastle(m);
+        return !exact && !givesCheck(m);
+    });
+}
+
+void Board::genLegalChecks(MoveList& out) {
+    if (whiteToMove) genChecks<Color::White>(out);
+    else genChecks<Color::Black>(out);
+}
+
+// The same legality rules as genLegal applied to target sets: each piece's targets are cut to the
+// check mask (the checker and the squares between it and the king) and, when pinned, to its pin
+// line, then counted. Pawns are counted set-wise except for the pinned ones.
+template <Color Us>
+int Board::countLegal() const {
+    constexpr bool white = Us == Color::White;
+    constexpr size_t us = white ? WP_CODE : BP_CODE;
+    constexpr int FWD = white ? NUM_SQUARES_IN_ROW : -int(NUM_SQUARES_IN_ROW);
+    constexpr int TOWARDS_A = white ? 9 : -7, TOWARDS_H = white ? 7 : -9;
+    constexpr uint64_t lastRank = white ? RANK_8 : RANK_1;
+    constexpr uint64_t thirdRank = white ? RANK_3 : RANK_6;
+
+    const uint8_t kingSq = bitscanForward(bb[us + WK_CODE]);
+    const uint64_t ours = white ? occWhite : occBlack(), enemies = white ? occBlack() : occWhite;
+    const uint64_t danger = attackedBy(~Us);
+    // Counted per piece type for the stats, as genLegal counts what it generates
+    int kingMoves = std::popcount(kingAttacks(kingSq) & ~ours & ~danger);
+
+    const uint64_t checkers = danger & (1ULL << kingSq) ? attackersTo<Us>(bb, kingSq, occAll) : 0;
+    if (checkers) TEMPO_STAT(EvasionNodes);
+    else TEMPO_STAT(NormalNodes);
+    if (std::popcount(checkers) >= 2) {
+        TEMPO_STAT_ADD(KingMoves, kingMoves);
+        return kingMoves;
+    }
+    const uint64_t target = checkers ? checkers | betweenSquares(kingSq, bitscanForward(checkers)) : ~ours;
+    const uint64_t pinned = pinnedPieces<Us>(kingSq);
+
+    // Knights never move along a line, so a pinned one has no moves
+    int knightMoves = 0;
+    forEachSetBit(bb[us + WN_CODE] & ~pinned, [&](uint8_t from) { knightMoves += std::popcount(knightAttacks(from) & target); });
+    const auto countSlider = [&](uint8_t from, uint64_t attacks) {
+        if (pinned & (1ULL << from)) attacks &= lineThrough(kingSq, from);
+        return std::popcount(attacks & target);
+    };
+    int bishopMoves = 0, rookMoves = 0, queenMoves = 0;
+    forEachSetBit(bb[us + WB_CODE], [&](uint8_t from) { bishopMoves += countSlider(from, bishopAttacks(from, occAll)); });
+    forEachSetBit(bb[us + WR_CODE], [&](uint8_t from) { rookMoves += countSlider(from, rookAttacks(from, occAll)); });
+    forEachSetBit(bb[us + WQ_CODE], [&](uint8_t from) { queenMoves += countSlider(from, queenAttacks(from, occAll)); });
+
+    // Pawn targets, promotions counting once per piece
+    int pawnMoves = 0;
+    const auto countPawnTargets = [&](uint64_t targets) {
+        pawnMoves += std::popcount(targets & ~lastRank) + 4 * std::popcount(targets & lastRank);
+    };
+    const uint64_t pawns = bb[us + WP_CODE];
+    const uint64_t free = pawns & ~pinned;
+    const uint64_t single = shift<FWD>(free) & ~occAll;
+    countPawnTargets(single & target);
+    pawnMoves += std::popcount(shift<FWD>(single & thirdRank) & ~occAll & target);
+    countPawnTargets(shift<TOWARDS_A>(free & ~FILE_A_MASK) & enemies & target);
+    countPawnTargets(shift<TOWARDS_H>(free & ~FILE_H_MASK) & enemies & target);
+    forEachSetBit(pawns & pinned, [&](uint8_t from) {
+        const uint64_t line = lineThrough(kingSq, from);
+        uint64_t targets = pawnAttacks(white, from) & enemies;
+        const uint64_t push = shift<FWD>(1ULL << from) & ~occAll;
+        targets |= push | (shift<FWD>(push & thirdRank) & ~occAll);
+        countPawnTargets(targets & line & target);
+    });
+
+    // En passant: remove both pawns and look for a slider uncovered on the king, as isLegal does
+    if (epSquare != NUM_SQUARES) {
+        const uint64_t victim = 1ULL << (epSquare - FWD);
+        forEachSetBit(pawnAttacks(!white, epSquare) & pawns, [&](uint8_t from) {
+            const uint64_t occ = (occAll ^ (1ULL << from) ^ victim) | (1ULL << epSquare);
+            pawnMoves += !(attackersTo<Us>(bb, kingSq, occ) & ~victim);
+        });
     }
+
+    // Castling, out of check only, mirroring MoveGen::genCastling
+    if (!checkers) {
+        constexpr uint8_t kingFrom = white ? e1 : e8;
+        constexpr uint8_t kingSideRook = white ? h1 : h8, queenSideRook = white ? a1 : a8;
+        constexpr uint8_t kingSideFlag = white ? W_K_FLAG : B_K_FLAG, queenSideFlag = white ? W_Q_FLAG : B_Q_FLAG;
+        const uint64_t rooks = bb[us + WR_CODE];
+        if (kingSq == kingFrom) {
+            kingMoves += (castling & kingSideFlag) && (rooks & (1ULL << kingSideRook)) &&
+                         !(occAll & betweenSquares(kingFrom, kingSideRook)) && !(danger & (0b111ULL << (kingFrom - 2)));
+            kingMoves += (castling & queenSideFlag) && (rooks & (1ULL << queenSideRook)) &&
+                         !(occAll & betweenSquares(kingFrom, queenSideRook)) && !(danger & (0b111ULL << kingFrom));
+        }
+    }
+    TEMPO_STAT_ADD(PawnMoves, pawnMoves);
+    TEMPO_STAT_ADD(RookMoves, rookMoves);
+    TEMPO_STAT_ADD(KnightMoves, knightMoves);
+    TEMPO_STAT_ADD(BishopMoves, bishopMoves);
+    TEMPO_STAT_ADD(QueenMoves, queenMoves);
+    TEMPO_STAT_ADD(KingMoves, kingMoves);
+    return pawnMoves + rookMoves + knightMoves + bishopMoves + queenMoves + kingMoves;
+}
+
+int Board::countLegalMoves() const {
+    return whiteToMove ? countLegal<Color::White>() : countLegal<Color::Black>();
 }
 
 uint64_t Board::getKey() { return key; }
 
+uint64_t Board::computeKey() const {
+    uint64_t k = 0;
+    for (size_t piece = 0; piece < to_u(Piece::PIECE_N); ++piece)
+        forEachSetBit(bb[piece], [&](int square) { k ^= zobrist->pieces[piece][square]; });
+    for (size_t i = 0; i < CASTLING_N; ++i)
+        if (castling & (1u << i)) k ^= zobrist->castling[i];
+    if (epSquare != NUM_SQUARES) k ^= zobrist->epFile[fileOf(epSquare)];
+    if (!whiteToMove) k ^= zobrist->blackToMove;
+    return k;
+}
+
+bool Board::inCheck() const {
+    return attackedBy(whiteToMove ? Color::Black : Color::White) & bb[to_u(getOurKing(whiteToMove))];
+}
+
+uint32_t Board::encodeMove(uint8_t from, uint8_t to, uint8_t promo) const {
+    if (from >= NUM_SQUARES || to >= NUM_SQUARES) return Move::NONE;
+    Piece moved = Piece::None;
+    for (Piece p : whiteToMove ? WHITE_PIECES : BLACK_PIECES)
+        if (isPieceAtSquare(bb, p, from)) moved = p;
+    if (moved == Piece::None) return Move::NONE;
+
+    Piece captured = enemyPieceAt(bb, to, whiteToMove);
+    const bool pawn = isPawn(moved);
+    const bool isEP = pawn && to == epSquare && fileOf(from) != fileOf(to);
+    if (isEP) captured = getEnemyPawn(whiteToMove);
+    const bool isDPP = pawn && std::abs(int(to) - int(from)) == 2 * NUM_SQUARES_IN_ROW;
+    const bool isCastle = isKing(moved) && std::abs(int(fileOf(to)) - int(fileOf(from))) == 2;
+    return Move::make(from, to, moved, captured != Piece::None, isCastle, isDPP, isEP, captured, static_cast<Promo>(promo));
+}
+
+bool Board::isPseudoLegal(uint32_t move) const {
+    if (move == Move::NONE) return false;
+    const uint8_t from = Move::from(move), to = Move::to(move), promo = Move::promo(move);
+    // Moved piece, capture and flags must agree with the position
+    if (encodeMove(from, to, promo) != move) return false;
+
+    const Piece moved = static_cast<Piece>(Move::movedCode(move));
+    const uint64_t toBit = 1ULL << to;
+    if ((whiteToMove ? occWhite : occBlack()) & toBit) return false;
+
+    if (isPawn(moved)) {
+        const int fwd = whiteToMove ? NUM_SQUARES_IN_ROW : -int(NUM_SQUARES_IN_ROW);
+        const bool lastRank = rankOf(to) == (whiteToMove ? EIGHTH_RANK : FIRST_RANK);
+        if (lastRank != (promo != Move::PROMO_MASK)) return false;
+        if (Move::isEP(move))
+            return (pawnAttacks(whiteToMove, from) & toBit) &&
+                   isPieceAtSquare(bb, getEnemyPawn(whiteToMove), epVictimSquare(to, whiteToMove));
+        if (Move::isCapture(move)) return pawnAttacks(whiteToMove, from) & toBit;
+        if (int(to) == from + fwd) return !(occAll & toBit);
+        return Move::isDPP(move) && rankOf(from) == (whiteToMove ? SECOND_RANK : SEVENTH_RANK) &&
+               !(occAll & (toBit | (1ULL << (from + fwd))));
+    }
+    if (promo != Move::PROMO_MASK) return false;
+
+    if (Move::isCastle(move)) {
+        const bool kingSide = fileOf(to) < fileOf(from);
+        const uint8_t home = whiteToMove ? e1 : e8;
+        const uint8_t flag = whiteToMove ? (kingSide ? W_K_FLAG : W_Q_FLAG) : (kingSide ? B_K_FLAG : B_Q_FLAG);
+        if (from != home || rankOf(to) != rankOf(from) || !(castling & flag)) return false;
+        uint8_t rookFrom, rookTo;
+        castlingRookSquares(from, to, rookFrom, rookTo);
+        if (!isPieceAtSquare(bb, getOurRook(whiteToMove), rookFrom)) return false;
+        TEMPO_STAT(CastlingPathChecks);
+        if (occAll & betweenSquares(from, rookFrom)) return false;
+        // The king may not start in, pass through or land in check
+        const uint64_t path = (1ULL << from) | (1ULL << rookTo) | toBit;
+        return !(attackedBy(whiteToMove ? Color::Black : Color::White) & path);
+    }
+    return attacksFrom(moved, from, occAll) & toBit;
+}
+
+bool Board::isLegal(uint32_t move) const {
+    if (Move::isCastle(move)) return true; // isPseudoLegal checked the king's path
+    const uint8_t from = Move::from(move), to = Move::to(move);
+    const Piece moved = static_cast<Piece>(Move::movedCode(move));
+    if (isKing(moved)) return !(attackedBy(whiteToMove ? Color::Black : Color::White) & (1ULL << to));
+
+    // Occupancy after the move; the captured piece can no longer attack
+    uint64_t occ = (occAll ^ (1ULL << from)) | (1ULL << to);
+    uint64_t removed = 1ULL << to;
+    if (Move::isEP(move)) {
+        removed = 1ULL << epVictimSquare(to, whiteToMove);
+        occ ^= removed;
+    }
+    const uint8_t kingSq = kingSquare(bb, whiteToMove);
+    return !(attackersTo(bb, kingSq, whiteToMove, occ) & ~removed);
+}
+
+bool Board::givesCheck(uint32_t move) const {
+    const uint8_t from = Move::from(move), to = Move::to(move);
+    const uint64_t fromBit = 1ULL << from, toBit = 1ULL << to;
+    const uint8_t theirKing = kingSquare(bb, !whiteToMove);
+    const Piece moved = static_cast<Piece>(Move::movedCode(move));
+    const Piece after = Move::promo(move) != Move::PROMO_MASK
+            ? static_cast<Piece>(promoPieceCode(Move::promo(move), whiteToMove)) : moved;
+
+    // Direct checks from the leapers
+    if (isPawn(after) && (pawnAttacks(whiteToMove, to) & (1ULL << theirKing))) return true;
+    if (isKnight(after) && (knightAttacks(to) & (1ULL << theirKing))) return true;
+
+    // Sliders after the move: direct, discovered and castling rook checks
+    uint64_t occ = (occAll ^ fromBit) | toBit;
+    uint64_t rookLike = (bb[to_u(getOurRook(whiteToMove))] | bb[to_u(getOurQueen(whiteToMove))]) & ~fromBit;
+    uint64_t bishopLike = (bb[to_u(getOurBishop(whiteToMove))] | bb[to_u(getOurQueen(whiteToMove))]) & ~fromBit;
+    if (isRook(after) || isQueen(after)) rookLike |= toBit;
+    if (isBishop(after) || isQueen(after)) bishopLike |= toBit;
+    if (Move::isEP(move)) occ ^= 1ULL << epVictimSquare(to, whiteToMove);
+    if (Move::isCastle(move)) {
+        uint8_t rookFrom, rookTo;
+        castlingRookSquares(from, to, rookFrom, rookTo);
+        const uint64_t rookMove = (1ULL << rookFrom) | (1ULL << rookTo);
+        occ ^= rookMove;
+        rookLike ^= rookMove;
+    }
+    return (rookAttacks(theirKing, occ) & rookLike) || (bishopAttacks(theirKing, occ) & bishopLike);
+}
+
+// Piece letters in piece code order
+static constexpr std::string_view FEN_PIECES = "PRNBQKprnbqk";
+
+namespace {
+
+// Fields of a FEN or EPD line, split on runs of blanks as views into the text
+struct FenFields {
+    std::string_view rest;
+
+    std::string_view next() {
+        const size_t begin = rest.find_first_not_of(" \t\r\n");
+        if (begin == std::string_view::npos) { rest = {}; return {}; }
+        rest.remove_prefix(begin);
+        const std::string_view field = rest.substr(0, rest.find_first_of(" \t\r\n"));
+        rest.remove_prefix(field.size());
+        return field;
+    }
+};
+
+bool parseClock(std::string_view field, int& out) {
+    const auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), out);
+    return ec == std::errc() && end == field.data() + field.size() && out >= 0;
+}
+
+}
+
+bool Board::setFromFEN(std::string_view fen) {
+    return setFromFields(fen, true);
+}
+
+bool Board::setFromEPD(std::string_view epd, std::string_view* operations) {
+    if (!setFromFields(epd, false)) return false;
+    if (operations) {
+        const size_t begin = epd.find_first_not_of(" \t\r\n");
+        *operations = begin == std::string_view::npos ? std::string_view{}
+                                                      : epd.substr(begin, epd.find_last_not_of(" \t\r\n") + 1 - begin);
+    }
+    return true;
+}
+
+bool Board::isValidPosition(const Bitboards& bb, bool whiteToMove, uint8_t castling, uint8_t epSquare) {
+    // Pieces: no square twice, one king a side, no pawns on the back ranks, no more men than a side starts with
+    uint64_t white = 0, black = 0, all = 0;
+    for (size_t p = 0; p < bb.size(); ++p) {
+        if (all & bb[p]) return false;
+        all |= bb[p];
+        (p <= WK_CODE ? white : black) |= bb[p];
+    }
+    if (std::popcount(bb[WK_CODE]) != 1 || std::popcount(bb[BK_CODE]) != 1) return false;
+    if ((bb[WP_CODE] | bb[BP_CODE]) & (RANK_1 | RANK_8)) return false;
+    if (std::popcount(white) > 16 || std::popcount(black) > 16 ||
+        std::popcount(bb[WP_CODE]) > 8 || std::popcount(bb[BP_CODE]) > 8) return false;
+
+    // The side that just moved cannot have left its king attacked
+    if (attackersTo(bb, bitscanForward(bb[whiteToMove ? BK_CODE : WK_CODE]), !whiteToMove, all)) return false;
+
+    // Castling rights, each with its king and rook still at home
+    if (castling > (W_K_FLAG | W_Q_FLAG | B_K_FLAG | B_Q_FLAG)) return false;
+    const auto home = [&](uint8_t flag, uint8_t king, uint8_t kingSq, uint8_t rook, uint8_t rookSq) {
+        return !(castling & flag) || ((bb[king] >> kingSq & 1) && (bb[rook] >> rookSq & 1));
+    };
+    if (!home(W_K_FLAG, WK_CODE, e1, WR_CODE, h1) || !home(W_Q_FLAG, WK_CODE, e1, WR_CODE, a1) ||
+        !home(B_K_FLAG, BK_CODE, e8, BR_CODE, h8) || !home(B_Q_FLAG, BK_CODE, e8, BR_CODE, a8))
+        return false;
+
+    // En passant: the square a pawn of the side that just moved skipped, empty along with the one it
+    // came from
+    if (epSquare != NUM_SQUARES) {
+        if (epSquare > NUM_SQUARES || rankOf(epSquare) != (whiteToMove ? 5 : 2)) return false;
+        const uint8_t pawnSq = whiteToMove ? epSquare - NUM_SQUARES_IN_ROW : epSquare + NUM_SQUARES_IN_ROW;
+        const uint8_t fromSq = whiteToMove ? epSquare + NUM_SQUARES_IN_ROW : epSquare - NUM_SQUARES_IN_ROW;
+        if (!(bb[whiteToMove ? BP_CODE : WP_CODE] >> pawnSq & 1) || (all & ((1ULL << epSquare) | (1ULL << fromSq))))
+            return false;
+    }
+    return true;
+}
+
+// Everything is checked before the board is touched, so a rejected line leaves it as it was
+bool Board::setFromFields(std::string_view& text, bool fen) {
+    FenFields fields { text };
+    const std::string_view placement = fields.next(), side = fields.next();
+    std::string_view castle = fields.next(), ep = fields.next();
+    if (castle.empty()) castle = "-";
+    if (ep.empty()) ep = "-";
+
+    // 1) Piece placement, rank 8 first and the a-file (file 7) first within a rank
+    Bitboards parsed{};
+    int rank = 7, file = 7;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != -1 || rank == 0) return false;
+            --rank; file = 7;
+        } else if (c >= '1' && c <= '8') {
+            file -= c - '0';
+            if (file < -1) return false;
+        } else {
+            const auto code = FEN_PIECES.find(c);
+            if (code == std::string_view::npos || file < 0) return false;
+            parsed[code] |= 1ULL << sq(file, rank);
+            --file;
+        }
+    }
+    if (placement.empty() || rank != 0 || file != -1) return false;
+
+    // 2) Side to move, castling rights and en passant square, checked against the pieces below
+    if (side != "w" && side != "b") return false;
+    const bool white2Move = side == "w";
+    uint8_t rights = 0;
+    if (castle != "-") {
+        for (char c : castle) {
+            const size_t flag = std::string_view("KQkq").find(c);
+            if (flag == std::string_view::npos || (rights & (1 << flag))) return false;
+            rights |= 1 << flag;
+        }
+    }
+    uint8_t epSq = NUM_SQUARES;
+    if (ep != "-") {
+        if (ep.size() != 2 || ep[0] < 'a' || ep[0] > 'h' || ep[1] < '1' || ep[1] > '8') return false;
+        epSq = sq('h' - ep[0], ep[1] - '1');
+    }
+    if (!isValidPosition(parsed, white2Move, rights, epSq)) return false;
+
+    // 5) FEN clocks, optional, and nothing after them; a full move number of 0 is read as 1
+    int halfMove = 0, fullMove = 1;
+    if (fen) {
+        const std::string_view half = fields.next(), full = fields.next();
+        if ((!half.empty() && !parseClock(half, halfMove)) || (!full.empty() && !parseClock(full, fullMove)) ||
+            !fields.next().empty())
+            return false;
+    }
+
+    bb = parsed;
+    calcOcc();
+    whiteToMove = white2Move;
+    castling = rights;
+    epSquare = epSq;
+    halfMoveClock = uint16_t(std::min(halfMove, 0xFFFF));
+    fullMoveTotal = uint16_t(std::clamp(fullMove, 1, 0xFFFF));
+    pliesFromNull = 0;
+    gameRecord.clear();
+    key = computeKey();
+    text = fields.rest;
+    return true;
+}
+
+size_t Board::writeFEN(char* out) const {
+    char* p = out;
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 7; file >= 0; --file) {
+            const uint64_t bit = 1ULL << sq(file, rank);
+            if (!(occAll & bit)) { ++empty; continue; }
+            if (empty) { *p++ = char('0' + empty); empty = 0; }
+            size_t code = 0;
+            while (!(bb[code] & bit)) ++code;
+            *p++ = FEN_PIECES[code];
+        }
+        if (empty) *p++ = char('0' + empty);
+        if (rank) *p++ = '/';
+    }
+    *p++ = ' ';
+    *p++ = whiteToMove ? 'w' : 'b';
+    *p++ = ' ';
+    if (!castling) *p++ = '-';
+    if (castling & W_K_FLAG) *p++ = 'K';
+    if (castling & W_Q_FLAG) *p++ = 'Q';
+    if (castling & B_K_FLAG) *p++ = 'k';
+    if (castling & B_Q_FLAG) *p++ = 'q';
+    *p++ = ' ';
+    if (epSquare == NUM_SQUARES) *p++ = '-';
+    else {
+        *p++ = char('h' - fileOf(epSquare));
+        *p++ = char('1' + rankOf(epSquare));
+    }
+    *p++ = ' ';
+    p = std::to_chars(p, out + MAX_FEN_LENGTH, halfMoveClock).ptr;
+    *p++ = ' ';
+    p = std::to_chars(p, out + MAX_FEN_LENGTH, fullMoveTotal).ptr;
+    *p = '\0';
+    return size_t(p - out);
+}
+
+std::string Board::toFEN() const {
+    char buffer[MAX_FEN_LENGTH];
+    return std::string(buffer, writeFEN(buffer));
+}
+
+void Board::setPosition(const Position& position) {
+    static_cast<Position&>(*this) = position;
+    attackCacheValid = 0;
+    fullMoveTotal = 1;
+    gameRecord.clear();
+}
+
 Board::Board() :
-        bb{},
-        whiteToMove(true),
+        Position{},
         hasCastled(false),
-        castling(uint8_t(to_u(Castling::W_K) | to_u(Castling::W_Q) | to_u(Castling::B_K) | to_u(Castling::B_Q))),
-        epSquare(NUM_SQUARES),
-        halfMoveClock(0),
         fullMoveTotal(1),
-        zobrist(Zobrist()),
-        key(zobrist.getKey()),
-        movegen(MoveGen(bb, whiteToMove, occWhite, occBlack, occAll, castling, epSquare))
+        attackCacheValid(0),
+        zobrist(&zobristKeys())
 {
+    whiteToMove = true;
+    castling = uint8_t(to_u(Castling::W_K) | to_u(Castling::W_Q) | to_u(Castling::B_K) | to_u(Castling::B_Q));
+    epSquare = NUM_SQUARES;
+
     // White pieces
     bb[to_u(WP)] = RANK_2;
     bb[to_u(WR)] = 0x0000000000000081ULL; // a1,h1
     bb[to_u(WN)] = 0x0000000000000042ULL; // b1,g1
     bb[to_u(WB)] = 0x0000000000000024ULL; // c1,f1
-    bb[to_u(WQ)] = 0x0000000000000008ULL; // d1
-    bb[to_u(WK)] = 0x0000000000000010ULL; // e1
+    bb[to_u(WQ)] = 0x0000000000000010ULL; // d1
+    bb[to_u(WK)] = 0x0000000000000008ULL; // e1
 
     // Black pieces
     bb[to_u(BP)] = RANK_7;
     bb[to_u(BR)] = 0x8100000000000000ULL; // a8,h8
     bb[to_u(BN)] = 0x4200000000000000ULL; // b8,g8
     bb[to_u(BB)] = 0x2400000000000000ULL; // c8,f8
-    bb[to_u(BQ)] = 0x0800000000000000ULL; // d8
-    bb[to_u(BK)] = 0x1000000000000000ULL; // e8
+    bb[to_u(BQ)] = 0x1000000000000000ULL; // d8
+    bb[to_u(BK)] = 0x0800000000000000ULL; // e8
 
-    // Occupancy bb
-    occWhite = bb[to_u(WP)] | bb[to_u(WR)] | bb[to_u(WN)] | bb[to_u(WB)] |
-               bb[to_u(WQ)] | bb[to_u(WK)];
-    occBlack = bb[to_u(BP)] | bb[to_u(BR)] | bb[to_u(BN)] | bb[to_u(BB)] |
-               bb[to_u(BQ)] | bb[to_u(BK)];
-    occAll = occWhite | occBlack;
-}
\ No newline at end of file
+    calcOcc();
+    key = computeKey();
+    gameRecord.reserve(MAX_GAME_PLY);
+}
@@ -7,60 +7,123 @@
 
 #include "movegen.h"
 #include "move.h"
+#include "position.h"
 #include "zobrist.h"
 #include <cstdint>
 #include <array>
 #include <vector>
-#include <stack>
+#include <string>
+#include <string_view>
 
-using Bitboards = std::array<uint64_t, 12>;
 using MoveList = std::vector<uint32_t>;
 
+inline constexpr std::string_view START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+inline constexpr size_t MAX_GAME_PLY = 1024; // history capacity reserved up front, grows beyond if needed
+
 // represents board state for pushing onto move stack
 struct State {
-    uint64_t zobrist;
+    uint64_t zobrist; // key of the position before the move
     uint8_t  castling;
     uint8_t   epSquare;
     uint16_t halfmoveClock;
+    uint16_t pliesFromNull;
     uint8_t  captured; // piece code or 0xF for None
 };
 
-class Board {
+// A Position plus the cold state around it: the game history for undo and repetitions, the full
+// move number and the attack map caches. Boards copy safely, though the history makes it dearer
+// than copying the Position alone.
+class Board : public Position {
 public:
-    // piece bb: WP, WR, WN, WB, WQ, WK, BP, BR, BN, BB, BQ, BK
-    Bitboards bb;
-
-    // occupancy bb
+    // occupancy bb, also drops the attack maps
     void calcOcc();
-    uint64_t occWhite, occBlack, occAll;
 
     // helper
     inline void removeCastlingFlag(uint8_t flag);
 
     // state
-    bool whiteToMove;
     bool hasCastled;
-    uint8_t castling; // bitmask: 1 for WQ, 2 for WK, 3 for BQ, 4 for BK
-    uint8_t epSquare; // En passant square
-    uint8_t halfMoveClock;
-    uint8_t fullMoveTotal;
+    uint16_t fullMoveTotal;
 
-    // hashing
-    Zobrist zobrist;
-    uint64_t key;
+    // Attack maps, built for one side on first request and dropped whenever the pieces move (calcOcc).
+    // A null move keeps them: they depend on the pieces only, not on the side to move.
+    mutable Bitboards pieceAttackCache;              // per piece code
+    mutable std::array<uint64_t, 2> sideAttackCache; // per Color, union of that side's piece maps
+    mutable uint8_t attackCacheValid;                // bit per Color for the side maps, then for the piece maps
 
-    // move generator
-    MoveGen movegen;
+    // hashing, tables shared by every board
+    const Zobrist* zobrist;
 
-    // keep track of move
-    std::stack<State> gameRecord;
+    // keep track of move, one entry per ply played so the keys can be scanned for repetitions
+    std::vector<State> gameRecord;
 
 public:
     void move(uint32_t move);
     void undoMove(uint32_t move);
+    // Passes the turn: only the side to move, ep square and key change
+    void makeNullMove();
+    void undoNullMove();
     void genLegalMoves(MoveList& out);
+    // The legal moves that give check, generated from the squares that check rather than filtered
+    // out of every move; in check, the evasions that check
+    void genLegalChecks(MoveList& out);
+    // Number of legal moves, found from target sets without encoding or storing any move
+    int countLegalMoves() const;
     uint64_t getKey();
+    uint64_t computeKey() const; // full recomputation, matches the incrementally updated key
+    bool inCheck() const;
+
+    // Squares attacked by a side, or by one piece code, with the other king lifted off the board so
+    // squares behind it on a checking line count as attacked. Every king-safety test is one AND here.
+    uint64_t attackedBy(Color side) const;
+    uint64_t attackedByPiece(Piece piece) const;
+
+    // Earlier occurrences of the current position, scanning back two plies at a time no further than
+    // the last capture, pawn move or null move
+    int repetitions() const;
+    // Checkmate on the hundredth ply takes precedence, callers test for mate first
+    bool isFiftyMoveDraw() const { return halfMoveClock >= 100; }
+
+    // Validation of moves that did not come from the generator (hash tables, books, other programs).
+    // encodeMove fills in the moved and captured pieces and the flags from the position, unchecked.
+    uint32_t encodeMove(uint8_t from, uint8_t to, uint8_t promo = Move::PROMO_MASK) const;
+    bool isPseudoLegal(uint32_t move) const; // the generator could produce it here, ignoring pins
+    bool isLegal(uint32_t move) const;       // a pseudo-legal move that leaves our king safe
+    bool givesCheck(uint32_t move) const;    // a legal move that checks the opponent
+
+    // Whether a position is reachable in outline: no square taken twice, one king a side, at most
+    // 16 pieces and 8 pawns a side, no pawns on the back ranks, castling rights only with king and
+    // rook at home, an ep square only behind a pawn that just made a double push, and the side that
+    // just moved not in check. Move generation relies on all of it.
+    static bool isValidPosition(const Bitboards& bb, bool whiteToMove, uint8_t castling, uint8_t epSquare);
+    // Loads a position from FEN; on malformed input or a position isValidPosition rejects returns
+    // false and leaves the board unchanged. The clocks may be left off. Nothing is allocated.
+    bool setFromFEN(std::string_view fen);
+    // EPD: the first four FEN fields, then operations (e.g. bm Nf3; id "x";) returned as a view
+    // into epd with the surrounding blanks trimmed
+    bool setFromEPD(std::string_view epd, std::string_view* operations = nullptr);
+    // Writes the position as FEN plus a terminating NUL into out, returning the length without it
+    static constexpr size_t MAX_FEN_LENGTH = 96;
+    size_t writeFEN(char* out) const;
+    std::string toFEN() const;
+    // Takes over a position, e.g. one copied from another thread's board, with an empty history
+    void setPosition(const Position& position);
     Board();
+
+private:
+    // Validates and loads the fields at the front of text, leaving text at whatever follows them:
+    // the four EPD fields, or for fen the clocks too with nothing after
+    bool setFromFields(std::string_view& text, bool fen);
+    // Specialized on the side making the move; move, undoMove and genLegalMoves dispatch once
+    template <Color Us> void doMove(uint32_t move);
+    template <Color Us> void doUndoMove(uint32_t move);
+    template <Color Us> void genLegal(MoveList& out);
+    template <Color Us> void genChecks(MoveList& out);
+    template <Color Us> int countLegal() const;
+    template <Color Us> uint64_t pinnedPieces(uint8_t kingSq) const;
+    template <Color Side> void computeAttacks() const;
+    template <Color Side> void computePieceAttacks() const;
 };
 
 #endif //TEMPO_BOARD_H
@@ -0,0 +1,91 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "fill.h"
+#include "types.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Destinations a one-square step may reach without wrapping around the board edge. A step towards
+// the a-file (file + 1) can never land on the h-file and the other way round.
+static constexpr uint64_t NOT_H = ~FILE_H_MASK, NOT_A = ~FILE_A_MASK, ALL = ~0ULL;
+
+// Occluded fill of gen in the direction of a left shift by s; mask keeps steps from wrapping.
+// Returns the attacks: the fill without its sources, plus the first blocker.
+static uint64_t fillUp(uint64_t gen, uint64_t empty, int s, uint64_t mask) {
+    empty &= mask;
+    gen |= empty & (gen << s);
+    empty &= empty << s;
+    gen |= empty & (gen << 2 * s);
+    empty &= empty << 2 * s;
+    gen |= empty & (gen << 4 * s);
+    return (gen << s) & mask;
+}
+
+static uint64_t fillDown(uint64_t gen, uint64_t empty, int s, uint64_t mask) {
+    empty &= mask;
+    gen |= empty & (gen >> s);
+    empty &= empty >> s;
+    gen |= empty & (gen >> 2 * s);
+    empty &= empty >> 2 * s;
+    gen |= empty & (gen >> 4 * s);
+    return (gen >> s) & mask;
+}
+
+uint64_t slidingAttacksScalar(uint64_t rookLike, uint64_t bishopLike, uint64_t occAll) {
+    const uint64_t empty = ~occAll;
+    return fillUp(rookLike, empty, 8, ALL) | fillUp(rookLike, empty, 1, NOT_H)
+         | fillUp(bishopLike, empty, 9, NOT_H) | fillUp(bishopLike, empty, 7, NOT_A)
+         | fillDown(rookLike, empty, 8, ALL) | fillDown(rookLike, empty, 1, NOT_A)
+         | fillDown(bishopLike, empty, 9, NOT_A) | fillDown(bishopLike, empty, 7, NOT_H);
+}
+
+#ifdef __AVX2__
+
+// Lanes: north, towards a (rook-like), north towards a, north towards h (bishop-like). The
+// downward register uses the same shifts to the right: south, towards h, south towards h, south towards a.
+uint64_t slidingAttacks(uint64_t rookLike, uint64_t bishopLike, uint64_t occAll) {
+    const __m256i shift1 = _mm256_setr_epi64x(8, 1, 9, 7);
+    const __m256i shift2 = _mm256_add_epi64(shift1, shift1);
+    const __m256i shift4 = _mm256_add_epi64(shift2, shift2);
+    const __m256i upMask = _mm256_setr_epi64x(ALL, NOT_H, NOT_H, NOT_A);
+    const __m256i downMask = _mm256_setr_epi64x(ALL, NOT_A, NOT_A, NOT_H);
+    const __m256i gen0 = _mm256_setr_epi64x(rookLike, rookLike, bishopLike, bishopLike);
+    const __m256i empty0 = _mm256_set1_epi64x(~occAll);
+
+    __m256i up = gen0, upEmpty = _mm256_and_si256(empty0, upMask);
+    __m256i down = gen0, downEmpty = _mm256_and_si256(empty0, downMask);
+
+    up = _mm256_or_si256(up, _mm256_and_si256(upEmpty, _mm256_sllv_epi64(up, shift1)));
+    down = _mm256_or_si256(down, _mm256_and_si256(downEmpty, _mm256_srlv_epi64(down, shift1)));
+    upEmpty = _mm256_and_si256(upEmpty, _mm256_sllv_epi64(upEmpty, shift1));
+    downEmpty = _mm256_and_si256(downEmpty, _mm256_srlv_epi64(downEmpty, shift1));
+
+    up = _mm256_or_si256(up, _mm256_and_si256(upEmpty, _mm256_sllv_epi64(up, shift2)));
+    down = _mm256_or_si256(down, _mm256_and_si256(downEmpty, _mm256_srlv_epi64(down, shift2)));
+    upEmpty = _mm256_and_si256(upEmpty, _mm256_sllv_epi64(upEmpty, shift2));
+    downEmpty = _mm256_and_si256(downEmpty, _mm256_srlv_epi64(downEmpty, shift2));
+
+    up = _mm256_or_si256(up, _mm256_and_si256(upEmpty, _mm256_sllv_epi64(up, shift4)));
+    down = _mm256_or_si256(down, _mm256_and_si256(downEmpty, _mm256_srlv_epi64(down, shift4)));
+
+    const __m256i attacks = _mm256_or_si256(_mm256_and_si256(_mm256_sllv_epi64(up, shift1), upMask),
+                                            _mm256_and_si256(_mm256_srlv_epi64(down, shift1), downMask));
+    const __m128i half = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    return uint64_t(_mm_cvtsi128_si64(half)) | uint64_t(_mm_extract_epi64(half, 1));
+}
+
+bool slidingAttacksVectorized() { return true; }
+
+#else
+
+uint64_t slidingAttacks(uint64_t rookLike, uint64_t bishopLike, uint64_t occAll) {
+    return slidingAttacksScalar(rookLike, bishopLike, occAll);
+}
+
+bool slidingAttacksVectorized() { return false; }
+
+#endif
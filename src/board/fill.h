@@ -0,0 +1,29 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_FILL_H
+#define TEMPO_FILL_H
+
+#include <cstdint>
+
+// ---------- Kogge-Stone Fills ----------
+// Whole-set slider attacks: every rook-like and bishop-like piece of a side is smeared along its
+// eight directions at once by occluded fills, three shift steps (1, 2, 4 squares) per direction
+// instead of a lookup per piece and ray. Meant for "everything this side attacks"; per-square
+// questions stay with the ray lookups in attacks.h.
+//
+// With AVX2 the four directions that raise the square index share one 256-bit register and the
+// four that lower it another, each lane a direction; otherwise the scalar version runs.
+
+// Squares attacked by the rook-like (rook, queen) and bishop-like (bishop, queen) sets, blockers
+// included, given occupancy occAll
+uint64_t slidingAttacks(uint64_t rookLike, uint64_t bishopLike, uint64_t occAll);
+
+// The portable kernel, what slidingAttacks runs without AVX2
+uint64_t slidingAttacksScalar(uint64_t rookLike, uint64_t bishopLike, uint64_t occAll);
+
+// True when slidingAttacks was built with the AVX2 kernel
+bool slidingAttacksVectorized();
+
+#endif //TEMPO_FILL_H
@@ -0,0 +1,129 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "hashtable.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// data holds depth + 1 in its low byte, so a zeroed entry never matches
+static constexpr uint64_t pack(int depth, uint64_t value) { return value << 8 | uint64_t(depth + 1); }
+static constexpr int depthOf(uint64_t data) { return int(data & 0xFF) - 1; }
+
+static uint64_t load(uint64_t& field) { return std::atomic_ref<uint64_t>(field).load(std::memory_order_relaxed); }
+static void save(uint64_t& field, uint64_t v) { std::atomic_ref<uint64_t>(field).store(v, std::memory_order_relaxed); }
+
+HashTable::HashTable(size_t mb) :
+    memory(std::max<size_t>(mb, 1) << 20),
+    table(memory.as<Entry>()),
+    buckets(memory.size() / sizeof(Entry) / BUCKET)
+{}
+
+HashTable::~HashTable() { unmap(); }
+
+void HashTable::unmap() {
+    if (map) munmap(map, mapBytes);
+    map = nullptr;
+    mapBytes = 0;
+    filePath.clear();
+}
+
+// A new file is built under a private name and linked into place, so another process opening the
+// same path concurrently sees either no file or a complete header, and only one creator wins
+static bool createFile(const std::string& path, size_t mb) {
+    const std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    const auto& keys = zobristKeys();
+    HashFileHeader header{};
+    std::memcpy(header.magic, HASH_MAGIC, sizeof(header.magic));
+    header.version = HASH_VERSION;
+    header.entrySize = HashTable::ENTRY_SIZE;
+    header.zobristSeed = keys.seed;
+    header.zobristFingerprint = keys.fingerprint();
+    header.entries = (std::max<size_t>(mb, 1) << 20) / HashTable::ENTRY_SIZE; // holes read back as empty entries
+    const bool written = ftruncate(fd, off_t(sizeof(header) + header.entries * HashTable::ENTRY_SIZE)) == 0 &&
+                         pwrite(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header));
+    ::close(fd);
+    const bool linked = written && (link(tmp.c_str(), path.c_str()) == 0 || errno == EEXIST);
+    unlink(tmp.c_str());
+    return linked;
+}
+
+bool HashTable::open(const std::string& path, size_t mb, bool readOnly) {
+    if (!readOnly && access(path.c_str(), F_OK) != 0 && !createFile(path, mb)) return false;
+
+    const int fd = ::open(path.c_str(), readOnly ? O_RDONLY : O_RDWR);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(HashFileHeader)) { ::close(fd); return false; }
+    void* file = mmap(nullptr, st.st_size, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (file == MAP_FAILED) return false;
+
+    HashFileHeader header;
+    std::memcpy(&header, file, sizeof(header));
+    const auto& keys = zobristKeys();
+    if (std::memcmp(header.magic, HASH_MAGIC, sizeof(HASH_MAGIC)) != 0 || header.version != HASH_VERSION ||
+        header.entrySize != sizeof(Entry) || header.zobristSeed != keys.seed ||
+        header.zobristFingerprint != keys.fingerprint() || header.entries == 0 || header.entries % BUCKET != 0 ||
+        size_t(st.st_size) != sizeof(HashFileHeader) + header.entries * sizeof(Entry)) {
+        munmap(file, st.st_size);
+        return false;
+    }
+    madvise(file, st.st_size, MADV_RANDOM);
+
+    unmap();
+    memory = LargeAllocation();
+    map = file;
+    mapBytes = size_t(st.st_size);
+    filePath = path;
+    writable = !readOnly;
+    table = reinterpret_cast<Entry*>(static_cast<char*>(file) + sizeof(HashFileHeader));
+    buckets = header.entries / BUCKET;
+    return true;
+}
+
+void HashTable::flush() const {
+    if (map && writable) msync(map, mapBytes, MS_SYNC);
+}
+
+void HashTable::clear() {
+    if (writable && table) std::memset(static_cast<void*>(table), 0, entries() * sizeof(Entry));
+}
+
+bool HashTable::probe(uint64_t key, int depth, uint64_t& value) const {
+    if (!table) return false;
+    Entry* b = bucket(key);
+    for (size_t i = 0; i < BUCKET; ++i) {
+        const uint64_t data = load(b[i].data);
+        if ((load(b[i].check) ^ data) == key && depthOf(data) == depth) {
+            value = data >> 8;
+            return true;
+        }
+    }
+    return false;
+}
+
+void HashTable::store(uint64_t key, int depth, uint64_t value) {
+    if (!table || !writable || depth < 0 || depth > MAX_DEPTH || value > MAX_VALUE) return;
+    Entry* b = bucket(key);
+    Entry* victim = b;
+    int victimDepth = MAX_DEPTH + 1;
+    for (size_t i = 0; i < BUCKET; ++i) {
+        const uint64_t data = load(b[i].data);
+        const int d = depthOf(data);
+        if (data == 0 || ((load(b[i].check) ^ data) == key && d == depth)) { victim = &b[i]; break; }
+        if (d < victimDepth) { victim = &b[i]; victimDepth = d; }
+    }
+    const uint64_t data = pack(depth, value);
+    save(victim->data, data);
+    save(victim->check, key ^ data);
+}
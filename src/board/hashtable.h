@@ -0,0 +1,86 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_HASHTABLE_H
+#define TEMPO_HASHTABLE_H
+
+#include "largepages.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// First 64 bytes of a hash file. Entries are only meaningful under the Zobrist tables that made
+// their keys, so the seed and a digest of those tables are recorded and checked on open.
+struct HashFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t zobristSeed;
+    uint64_t zobristFingerprint;
+    uint64_t entries;
+    uint64_t reserved[3];
+};
+
+static_assert(sizeof(HashFileHeader) == 64);
+
+inline constexpr char HASH_MAGIC[8] = { 'T', 'E', 'M', 'P', 'O', 'H', 'T', '\0' };
+inline constexpr uint32_t HASH_VERSION = 1;
+
+// Table of (key, depth) -> value results in buckets of four 16 byte entries, one cache line each.
+// An entry stores key ^ data next to data, so a torn write from another thread, or another process
+// sharing the file, reads as a miss instead of a wrong value; no locks are taken. Replacement keeps
+// the deeper results. The table lives in anonymous memory, or in a file mapped MAP_SHARED that
+// later runs open again warm.
+class HashTable {
+public:
+    static constexpr int MAX_DEPTH = 254;
+    static constexpr uint32_t ENTRY_SIZE = 16;
+    static constexpr uint64_t MAX_VALUE = (1ULL << 56) - 1;
+
+    HashTable() = default;
+    explicit HashTable(size_t mb);
+    ~HashTable();
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
+
+    // Maps path, creating it with mb megabytes of entries if it does not exist; an existing file
+    // keeps its own size. False, leaving the table as it was, if the file cannot be mapped or was
+    // written under another format or other Zobrist keys. Read-only tables ignore stores.
+    bool open(const std::string& path, size_t mb, bool readOnly = false);
+    // Writes dirty pages of a file-backed table back now rather than whenever the kernel does
+    void flush() const;
+    void clear();
+
+    // value stored for key at exactly this depth
+    bool probe(uint64_t key, int depth, uint64_t& value) const;
+    void store(uint64_t key, int depth, uint64_t value);
+
+    size_t entries() const { return buckets * BUCKET; }
+    bool persistent() const { return map != nullptr; }
+    const std::string& path() const { return filePath; }
+
+private:
+    struct Entry {
+        uint64_t check; // key ^ data
+        uint64_t data;  // value << 8 | depth + 1
+    };
+    static_assert(sizeof(Entry) == ENTRY_SIZE);
+    static constexpr size_t BUCKET = 4;
+
+    Entry* bucket(uint64_t key) const {
+        return table + (static_cast<unsigned __int128>(key) * buckets >> 64) * BUCKET;
+    }
+    void unmap();
+
+    LargeAllocation memory;
+    void* map = nullptr; // whole file, header included
+    size_t mapBytes = 0;
+    std::string filePath;
+    bool writable = true;
+
+    Entry* table = nullptr;
+    size_t buckets = 0;
+};
+
+#endif //TEMPO_HASHTABLE_H
@@ -0,0 +1,91 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "largepages.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#ifdef __linux__
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+
+// madvise succeeds even when transparent huge pages are switched off system wide
+static bool transparentHugePagesEnabled() {
+    std::ifstream in("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string setting;
+    return !std::getline(in, setting) || setting.find("[never]") == std::string::npos;
+}
+#endif
+
+std::string_view pageModeName(PageMode mode) {
+    static constexpr std::string_view NAMES[] = { "hugetlb", "transparent huge pages", "normal pages" };
+    return NAMES[static_cast<size_t>(mode)];
+}
+
+LargeAllocation::LargeAllocation(size_t size, bool allowHuge) {
+    if (size == 0) return;
+    bytes = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+#ifdef __linux__
+    // Anonymous mappings come zeroed
+    if (allowHuge) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            ptr = p;
+            pageMode = PageMode::HugeTLB;
+            return;
+        }
+    }
+
+    // Over-map by one huge page and trim both ends so the region starts on a 2 MB boundary
+    void* raw = mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    if (aligned > start) munmap(raw, aligned - start);
+    if (const size_t tail = start + HUGE_PAGE_SIZE - aligned) munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+    ptr = reinterpret_cast<void*>(aligned);
+    if (allowHuge && madvise(ptr, bytes, MADV_HUGEPAGE) == 0 && transparentHugePagesEnabled())
+        pageMode = PageMode::TransparentHuge;
+    else if (!allowHuge)
+        madvise(ptr, bytes, MADV_NOHUGEPAGE); // keep a kernel set to "always" from merging them anyway
+#else
+    (void)allowHuge;
+    ptr = std::aligned_alloc(HUGE_PAGE_SIZE, bytes);
+    if (!ptr) throw std::bad_alloc();
+    std::memset(ptr, 0, bytes);
+#endif
+}
+
+void LargeAllocation::release() {
+    if (!ptr) return;
+#ifdef __linux__
+    munmap(ptr, bytes);
+#else
+    std::free(ptr);
+#endif
+    ptr = nullptr;
+    bytes = 0;
+}
+
+LargeAllocation::~LargeAllocation() { release(); }
+
+LargeAllocation::LargeAllocation(LargeAllocation&& other) noexcept :
+    ptr(std::exchange(other.ptr, nullptr)),
+    bytes(std::exchange(other.bytes, 0)),
+    pageMode(other.pageMode)
+{}
+
+LargeAllocation& LargeAllocation::operator=(LargeAllocation&& other) noexcept {
+    if (this != &other) {
+        release();
+        ptr = std::exchange(other.ptr, nullptr);
+        bytes = std::exchange(other.bytes, 0);
+        pageMode = other.pageMode;
+    }
+    return *this;
+}
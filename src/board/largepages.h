@@ -0,0 +1,51 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_LARGEPAGES_H
+#define TEMPO_LARGEPAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+inline constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// How the memory of a LargeAllocation is backed, best first
+enum class PageMode : uint8_t {
+    HugeTLB,         // explicit MAP_HUGETLB pages from the reserved pool
+    TransparentHuge, // normal pages, 2 MB aligned and advised MADV_HUGEPAGE for khugepaged to merge
+    Normal,          // huge pages refused or unsupported
+};
+
+std::string_view pageModeName(PageMode mode);
+
+// Zeroed memory for big tables probed at random (hash tables keyed by Board::getKey()), where TLB
+// misses dominate with 4 KB pages. The size is rounded up to whole 2 MB pages and the start is 2 MB
+// aligned, hence cache-line aligned. Explicit huge pages are tried first, then transparent ones;
+// failing both the table still works on normal pages and mode() says so.
+class LargeAllocation {
+public:
+    LargeAllocation() = default;
+    explicit LargeAllocation(size_t bytes, bool allowHuge = true);
+    ~LargeAllocation();
+    LargeAllocation(LargeAllocation&& other) noexcept;
+    LargeAllocation& operator=(LargeAllocation&& other) noexcept;
+    LargeAllocation(const LargeAllocation&) = delete;
+    LargeAllocation& operator=(const LargeAllocation&) = delete;
+
+    void* data() const { return ptr; }
+    template <typename T> T* as() const { return static_cast<T*>(ptr); }
+    size_t size() const { return bytes; }
+    PageMode mode() const { return pageMode; }
+    explicit operator bool() const { return ptr != nullptr; }
+
+private:
+    void release();
+
+    void* ptr = nullptr;
+    size_t bytes = 0;
+    PageMode pageMode = PageMode::Normal;
+};
+
+#endif //TEMPO_LARGEPAGES_H
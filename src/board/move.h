@@ -40,6 +40,9 @@ struct Move {
     static constexpr uint32_t PAWN_DOUBLE_MOVE_FLAG = 1ULL << PAWN_DPP_FLAG_SHIFT;
     static constexpr uint32_t EN_PASSANT_FLAG = 1ULL << EP_FLAG_SHIFT;
 
+    // Never produced by make(): promo bits are always set, so 0 is free to mean "no move"
+    static constexpr uint32_t NONE = 0;
+
 
     // isDPP = is double pawn push
     // isEP = is en passant
@@ -5,328 +5,217 @@
 #include "attacks.h"
 #include "push.h"
 #include "movegen.h"
-#include <iostream>
+#include "position.h"
 #include "types.h"
+#include <algorithm>
 #include <bit>
 #include <vector>
 #include <assert.h>
 
 using MoveList = std::vector<uint32_t>;
 
-inline Piece MoveGen::sideToMoveKing() const {
-    return whiteToMove ? Piece::WK : Piece::BK;
-}
-
-// find piece at sq for color wantWhite
-// returns Piece::None if not found
-inline Piece MoveGen::findPieceAt(uint8_t square, bool wantWhite) const {
-    const auto& set = wantWhite ? WHITE_PIECES : BLACK_PIECES;
-    for (Piece piece : set) if (isPieceAtSquare(bb, piece, square)) return piece;
+// returns Piece::None if no enemy piece is on square
+template <Color Us>
+inline Piece MoveGen::enemyPieceOn(uint8_t square) const {
+    constexpr size_t them = Us == Color::White ? BP_CODE : WP_CODE;
+    for (size_t code = them; code < them + 6; ++code)
+        if (pos.bb[code] & (1ULL << square)) return static_cast<Piece>(code);
     return Piece::None;
 }
 
-inline uint64_t MoveGen::ourOcc() const { return whiteToMove ? occWhite : occBlack; }
-
-inline uint64_t MoveGen::getOcc(bool all, bool isWhite, bool opposite) const {
-    if (all) return occAll;
-    if (isWhite) return opposite ? occBlack : occWhite;
-    else return opposite ? occWhite : occBlack;
-}
-
-inline bool MoveGen::isCastleFlag(Castling pair) const { return castling & to_u(pair); }
-inline bool MoveGen::kingAt(bool isWhite, uint8_t sq) const {
-    Piece king = isWhite ? Piece::WK : Piece::BK;
-    return bb[to_u(king)] & (1ULL << sq);
-}
-
-// works for both white and black pawns
-// FWD is the incrementor for rank above current
-void MoveGen::genPawnMovesFor(MoveList& out, Piece pawn) const {
-    bool meWhite = isWhite(pawn);
-    const uint8_t topRank = meWhite ? EIGHTH_RANK : FIRST_RANK;
-    const uint8_t seventhRank = meWhite ? SEVENTH_RANK : SECOND_RANK;
-    const uint8_t sixthRank = meWhite ? SIXTH_RANK : THIRD_RANK;
-    const uint8_t secondRank = meWhite ? SECOND_RANK : SEVENTH_RANK;
-    const uint8_t epRank = meWhite ? FIFTH_RANK : FOURTH_RANK;
-    const uint8_t leftFile = meWhite ? A_FILE : H_FILE;
-    const uint8_t rightFile = meWhite ? H_FILE : A_FILE;
-    const int8_t leftSQdx = meWhite ? 1 : - 1;
-    const int8_t rightSQdx = meWhite ? -1 : 1;
-    const int8_t FWD = meWhite ? NUM_SQUARES_IN_ROW : (-(int8_t)NUM_SQUARES_IN_ROW);
-
-    forEachSetBit(bb[to_u(pawn)], [&](uint8_t square) {
-        if (squareInRank(square, topRank)) return; // Last rank
-
-        // Quiet push promotion
-        if (squareInRank(square, seventhRank) && !occupied(getOcc(true), square + FWD))
-            pushPromo(out, square, square + FWD, pawn, false);
-
-        // Capture to left
-        if (fileOf(square) != leftFile &&
-            occupied(getOcc(false, meWhite, true),square + FWD + leftSQdx))
-            if (squareInRank(square, seventhRank)) // Promotion capture
-                pushPromo(out, square, square + FWD + leftSQdx, pawn, true, findPieceAt(square + FWD + leftSQdx, !isWhite(pawn)));
-             else // Normal capture
-                 pushCapture(out, square, square + FWD + leftSQdx, pawn, enemyPieceAt(bb, square + FWD + leftSQdx, meWhite));
-
-         // Capture to right
-        if (fileOf(square) != rightFile&&
-            occupied(getOcc(false, meWhite, true),square + FWD + rightSQdx))
-            if (squareInRank(square, seventhRank)) // Promotion capture
-                pushPromo(out, square, square + FWD + rightSQdx, pawn, true, findPieceAt(square + FWD + rightSQdx, !meWhite));
-             else // Normal capture
-                 pushCapture(out, square, square + FWD + rightSQdx, pawn, enemyPieceAt(bb, square + FWD + rightSQdx, meWhite));
-
-        // En Passant
-        if (squareInRank(square, epRank)) {
-            Piece otherPawn = getOtherPiece(pawn);
-            if (fileOf(square) != leftFile &&
-                epSquare == square + FWD + leftSQdx) // Left
-                pushCapture(out, square, square + FWD + leftSQdx, pawn, otherPawn, true);
-            if (fileOf(square) != rightFile &&
-                epSquare == square + FWD + rightSQdx) // Left
-                pushCapture(out, square, square + FWD + rightSQdx, pawn, otherPawn, true);
-        }
-
-        // Any forward push (includes double pawn push)
-        if (!occupied(occAll, square + FWD)) { // Single push
-            pushQuiet(out, square, square + FWD, pawn);
-            if (squareInRank(square, secondRank) && // Double pawn push
-                !occupied(occAll, square + 2 * FWD))
-                pushQuiet(out, square, square + 2 * FWD, pawn, true);
-        }
+// Quiet moves and captures from one square, targets must exclude our own pieces
+template <Color Us>
+inline void MoveGen::pushTargets(MoveList& out, uint8_t from, uint64_t targets, Piece moved) const {
+    const uint64_t enemies = Us == Color::White ? pos.occBlack() : pos.occWhite;
+    forEachSetBit(targets & enemies, [&](uint8_t to) { pushCapture(out, from, to, moved, enemyPieceOn<Us>(to)); });
+    forEachSetBit(targets & ~enemies, [&](uint8_t to) { pushQuiet(out, from, to, moved); });
+}
+
+// Pawns move as sets: pushes and captures are whole-board shifts masked by rank and file, then
+// serialized from the target squares with the origin recovered by subtracting the shift.
+template <Color Us>
+void MoveGen::genPawnMoves(MoveList& out, uint64_t target) const {
+    constexpr bool white = Us == Color::White;
+    constexpr Piece pawn = colored(WP, Us);
+    constexpr Piece enemyPawn = colored(WP, ~Us);
+    constexpr int FWD = white ? NUM_SQUARES_IN_ROW : -int(NUM_SQUARES_IN_ROW);
+    constexpr int TOWARDS_A = white ? 9 : -7; // capture towards the a-file (file + 1)
+    constexpr int TOWARDS_H = white ? 7 : -9; // capture towards the h-file (file - 1)
+    constexpr uint64_t seventhRank = white ? RANK_7 : RANK_2;
+    constexpr uint64_t thirdRank = white ? RANK_3 : RANK_6; // single pushes that may push again
+
+    const uint64_t pawns = pos.bb[to_u(pawn)];
+    const uint64_t enemies = (white ? pos.occBlack() : pos.occWhite) & target;
+    const uint64_t empty = ~pos.occAll;
+    const uint64_t promoters = pawns & seventhRank;
+    const uint64_t others = pawns & ~seventhRank;
+
+    // Single and double pushes
+    const uint64_t single = shift<FWD>(others) & empty;
+    const uint64_t dbl = shift<FWD>(single & thirdRank) & empty & target;
+    forEachSetBit(single & target, [&](uint8_t to) { pushQuiet(out, to - FWD, to, pawn); });
+    forEachSetBit(dbl, [&](uint8_t to) { pushQuiet(out, to - 2 * FWD, to, pawn, /*isDPP=*/true); });
+
+    // Captures
+    forEachSetBit(shift<TOWARDS_A>(others & ~FILE_A_MASK) & enemies, [&](uint8_t to) {
+        pushCapture(out, to - TOWARDS_A, to, pawn, enemyPieceOn<Us>(to));
     });
-}
-
-// works for both white and black pawns
-// FWD is the incrementor for rank above current
-void MoveGen::genRookMovesFor(MoveList& out, Piece rook) const {
-    forEachSetBit(bb[to_u(rook)], [&](uint8_t square) {
-        for(size_t i = 0; i < ROOK_DELTAS.size(); ++i)
-            slide(out, bb, rook, square, ROOK_DELTAS[i], occAll);
+    forEachSetBit(shift<TOWARDS_H>(others & ~FILE_H_MASK) & enemies, [&](uint8_t to) {
+        pushCapture(out, to - TOWARDS_H, to, pawn, enemyPieceOn<Us>(to));
     });
-}
-
-void MoveGen::genKnightMovesFor(MoveList& out, Piece knight) const {
-    forEachSetBit(bb[to_u(knight)], [&](uint8_t from) {
-        for(size_t i = 0; i < KNIGHT_DELTAS.size(); ++i) {
-            int8_t to = from + KNIGHT_DELTAS[i];
-            if (!squareInBoard(to) || !knightHopValid(from, to)) continue;
-            if (getOcc(false, isWhite(knight)) & (1ULL << to)) continue;
-            pushQuietOrCapture(out, bb, from, to, knight, occAll);
-        }
-    });
-}
-
-void MoveGen::genBishopMovesFor(MoveList& out, Piece bishop) const {
-    forEachSetBit(bb[to_u(bishop)], [&](uint8_t square) {
-        for(size_t i = 0; i < BISHOP_DELTAS.size(); ++i)
-            slide(out, bb, bishop, square, BISHOP_DELTAS[i], occAll);
-    });
-}
 
-void MoveGen::genQueenMovesFor(MoveList& out, Piece queen) const {
-    forEachSetBit(bb[to_u(queen)], [&](uint8_t square) {
-        for(size_t i = 0; i < QUEEN_DELTAS.size(); ++i)
-            slide(out, bb, queen, square, QUEEN_DELTAS[i], occAll);
-    });
-}
-
-void MoveGen::genKingMovesFor(MoveList& out, Piece king) const {
-    forEachSetBit(bb[to_u(king)], [&](uint8_t from) {
-        for(size_t i = 0; i < KING_DELTAS.size(); ++i) {
-            int8_t to = from + KING_DELTAS[i];
-            if (!squareInBoard(to) || wrapped(from, to, KING_DELTAS[i])) continue;
-            pushQuietOrCapture(out, bb, from, to, king, occAll);
-        }
-    });
-
-    // Castling
-    if (king == Piece::WK) {
-        // King-side (e1 -> g1), rook at h1
-        if ((castling & to_u(Castling::W_K)) && kingAt(true, e1)) {
-            // empty between king and rook, not in/through check, rook exists
-            if (!occupied(occAll, f1) && !occupied(occAll, g1) &&
-                !isSquareAttacked(bb, e1, true, occAll) &&
-                !isSquareAttacked(bb, f1, true, occAll) &&
-                !isSquareAttacked(bb, g1, true, occAll) &&
-                    isPieceAtSquare(bb, Piece::WR, h1)) {
-                pushQuiet(out, e1, g1, king, /*isDPP=*/false, /*isCastle=*/true);
-            }
-        }
-        // Queen-side (e1 -> c1), rook at a1
-        if ((castling & to_u(Castling::W_Q)) && kingAt(true, e1)) {
-            // empty between (d1,c1,b1), not in/through check on e1,d1,c1, rook exists
-            if (!occupied(occAll, d1) && !occupied(occAll, c1) && !occupied(occAll, b1) &&
-                !isSquareAttacked(bb, c1, true, occAll) &&
-                !isSquareAttacked(bb, d1, true, occAll) &&
-                !isSquareAttacked(bb, e1, true, occAll) &&
-                    isPieceAtSquare(bb, Piece::WR, a1)) {
-                pushQuiet(out, e1, c1, king, /*isDPP=*/false, /*isCastle=*/true);
-            }
-        }
-    } else {
-        // King-side (e8 -> g8), rook at h8
-        if ((castling & to_u(Castling::B_K)) && kingAt(false, e8)) {
-            if (!occupied(occAll, f8) && !occupied(occAll, g8) &&
-                !isSquareAttacked(bb, e8, false, occAll) &&
-                !isSquareAttacked(bb, f8, false, occAll) &&
-                !isSquareAttacked(bb, g8, false, occAll) &&
-                    isPieceAtSquare(bb, Piece::BR, h8)) {
-                pushQuiet(out, e8, g8, king, /*isDPP=*/false, /*isCastle=*/true);
-            }
-        }
-        // Queen-side (e8 -> c8), rook at a8
-        if ((castling & to_u(Castling::B_Q)) && kingAt(false, e8)) {
-            if (!occupied(occAll, d8) && !occupied(occAll, c8) && !occupied(occAll, b8) &&
-                !isSquareAttacked(bb, c8, false, occAll) &&
-                !isSquareAttacked(bb, d8, false, occAll) &&
-                !isSquareAttacked(bb, e8, false, occAll) &&
-                    isPieceAtSquare(bb, Piece::BR, a8)) {
-                pushQuiet(out, e8, c8, king, /*isDPP=*/false, /*isCastle=*/true);
-            }
-        }
+    // Promotions, pushing or capturing from the seventh rank
+    if (promoters) {
+        forEachSetBit(shift<FWD>(promoters) & empty & target, [&](uint8_t to) {
+            pushPromo(out, to - FWD, to, pawn, false);
+        });
+        forEachSetBit(shift<TOWARDS_A>(promoters & ~FILE_A_MASK) & enemies, [&](uint8_t to) {
+            pushPromo(out, to - TOWARDS_A, to, pawn, true, enemyPieceOn<Us>(to));
+        });
+        forEachSetBit(shift<TOWARDS_H>(promoters & ~FILE_H_MASK) & enemies, [&](uint8_t to) {
+            pushPromo(out, to - TOWARDS_H, to, pawn, true, enemyPieceOn<Us>(to));
+        });
     }
-}
-
-void MoveGen::genSafeKingMoves(MoveList& out, uint8_t kingSq) const {
-    Piece ourKing = getOurKing(whiteToMove);
-    uint64_t kingMoves = getKingMoves(kingSq) & ~ourOcc();
-    forEachSetBit(kingMoves, [&](uint8_t to) {
-        uint64_t occKing = (occAll ^ (1ULL << kingSq)) | (1ULL << to);
-        if(!isSquareAttacked(bb, to, whiteToMove, occKing))
-        pushQuietOrCapture(out, bb, kingSq, to, getOurKing(whiteToMove), occAll);
-    });
-}
-
-void MoveGen::genPieceCapturesToSquare(MoveList& out, uint8_t sq, Piece piece, Piece captured) const {
-    uint64_t ourAttackingPieces = scanAttacks(bb, sq, piece, occAll);
-    forEachSetBit(ourAttackingPieces, [&](uint8_t from) {
-        pushCapture(out, from, sq, piece, captured);
-    });
-}
 
-void MoveGen::genCapturesToSquare(MoveList& out, uint8_t attackSq) const {
-    bool meWhite = whiteToMove;
-    Piece captured = findPieceAt(attackSq, !meWhite);
-    assert(captured != Piece::None); // must be an enemy piece
-    Piece ourKing = getOurKing(whiteToMove);
-
-    // Pawns
-    Piece ourPawn = getOurPawn(whiteToMove);
-    uint64_t ourAttackingPawns = scanAttacks(bb, attackSq, ourPawn, occAll);
-    forEachSetBit(ourAttackingPawns, [&](uint8_t from) {
-        if (pawnMoveFromPromotion(from, whiteToMove))
-            pushPromo(out, from, attackSq, ourPawn, true, captured);
-        else
-            pushCapture(out, from, attackSq, ourPawn, captured);
-    });
-
-    // Rooks, Knights, Bishops, Queens
-    genPieceCapturesToSquare(out, attackSq, getOurRook(whiteToMove), captured);
-    genPieceCapturesToSquare(out, attackSq, getOurKnight(whiteToMove), captured);
-    genPieceCapturesToSquare(out, attackSq, getOurBishop(whiteToMove), captured);
-    genPieceCapturesToSquare(out, attackSq, getOurQueen(whiteToMove), captured);
-}
-
-void MoveGen::genPawnBlocksToMask(MoveList& out, uint64_t mask) const {
-    Piece ourPawn = getOurPawn(whiteToMove);
-    int8_t FWD = whiteToMove ? NUM_SQUARES_IN_ROW : -(int8_t)NUM_SQUARES_IN_ROW;
-    uint8_t secondRank = whiteToMove ? SECOND_RANK : SEVENTH_RANK;
-
-    forEachSetBit(bb[to_u(ourPawn)], [&](uint8_t from){
-        // Single push
-        uint8_t to1 = int8_t(from) + FWD;
-        if (!occupied(occAll, to1) && (mask & (1ULL << to1))) {
-            pushQuiet(out, from, to1, ourPawn);
-        }
-        // Double push
-        if (rankOf(from) == secondRank) {
-            uint8_t mid = uint8_t(int8_t(from) + FWD);
-            uint8_t to2 = uint8_t(int8_t(from) + 2*FWD);
-            if (!occupied(occAll, mid) &&
-                !occupied(occAll, to2) &&
-                (mask & (1ULL << to2))) {
-                pushQuiet(out, from, to2, ourPawn, /*isDPP=*/true);
-            }
-        }
-    });
-}
-
-void MoveGen::genPieceBlocksToMask(MoveList& out, uint64_t mask, Piece piece) const {
-    forEachSetBit(mask, [&](uint8_t to) {
-        uint64_t froms = scanAttacks(bb, to, piece, occAll);
-        forEachSetBit(froms, [&](uint8_t from) {
-            pushQuiet(out, from, to, piece);
+    // En passant, when evading it must land on the check ray or take the checking pawn
+    if (pos.epSquare != NUM_SQUARES && (target & ((1ULL << pos.epSquare) | (1ULL << (pos.epSquare - FWD))))) {
+        forEachSetBit(pawnAttacks(!white, pos.epSquare) & others, [&](uint8_t from) {
+            pushCapture(out, from, pos.epSquare, pawn, enemyPawn, true);
         });
-    });
-}
-
-void MoveGen::genQuietBlocks(MoveList& out, uint64_t mask) const {
-    genPawnBlocksToMask(out, mask);
-    genPieceBlocksToMask(out, mask, getOurRook(whiteToMove));
-    genPieceBlocksToMask(out, mask, getOurKnight(whiteToMove));
-    genPieceBlocksToMask(out, mask, getOurBishop(whiteToMove));
-    genPieceBlocksToMask(out, mask, getOurQueen(whiteToMove));
+    }
 }
 
-void MoveGen::genEPBlock(MoveList& out, uint64_t mask) const {
-    if (epSquare == NUM_SQUARES) return;
-    Piece ourPawn = getOurPawn(whiteToMove);
-    uint8_t epSq = epSquare; // landing square of pawn
-    uint64_t ourEPpawns = scanAttacks(bb, epSq, ourPawn, occAll);
-    forEachSetBit(ourEPpawns, [&](uint8_t from) {
-        if ((1ULL << epSq) & mask) pushCapture(out, from, epSq, ourPawn, getOtherPiece(ourPawn), true);
+template <Color Us, Piece P>
+void MoveGen::genPieceMoves(MoveList& out, uint64_t target) const {
+    constexpr Piece piece = colored(P, Us);
+    forEachSetBit(pos.bb[to_u(piece)], [&](uint8_t from) {
+        pushTargets<Us>(out, from, pieceAttacks<piece>(from, pos.occAll) & target, piece);
     });
 }
 
-void MoveGen::genPseudoMoves(MoveList& out) const {
-    using enum Piece;
-    if (whiteToMove) {
-        genPawnMovesFor(out, WP);
-        genRookMovesFor(out, WR);
-        genKnightMovesFor(out, WN);
-        genBishopMovesFor(out, WB);
-        genQueenMovesFor(out, WQ);
-        genKingMovesFor(out, WK);
-    } else {
-        genPawnMovesFor(out, BP);
-        genRookMovesFor(out, BR);
-        genKnightMovesFor(out, BN);
-        genBishopMovesFor(out, BB);
-        genQueenMovesFor(out, BQ);
-        genKingMovesFor(out, BK);
-    }
-}
-
-void MoveGen::genEvasions(MoveList& out, uint8_t kingSq) const {
-    uint64_t checkers = attackersTo(bb, kingSq, whiteToMove, occAll);
+// The king may not start in, pass through or land in check; the rook must still be at home
+template <Color Us>
+void MoveGen::genCastling(MoveList& out, uint64_t danger) const {
+    constexpr bool white = Us == Color::White;
+    constexpr Piece king = colored(WK, Us);
+    constexpr Piece rook = colored(WR, Us);
+    constexpr uint8_t kingFrom = white ? e1 : e8;
+    constexpr uint8_t kingSideRook = white ? h1 : h8;
+    constexpr uint8_t queenSideRook = white ? a1 : a8;
+    constexpr uint8_t kingSideFlag = white ? W_K_FLAG : B_K_FLAG;
+    constexpr uint8_t queenSideFlag = white ? W_Q_FLAG : B_Q_FLAG;
+
+    constexpr uint64_t kingSidePath = 0b111ULL << (kingFrom - 2);
+    constexpr uint64_t queenSidePath = 0b111ULL << kingFrom;
+
+    if (!(pos.bb[to_u(king)] & (1ULL << kingFrom))) return;
+    const auto pathClear = [&](uint8_t rookFrom, uint64_t kingPath) {
+        TEMPO_STAT(CastlingPathChecks);
+        return !(pos.occAll & betweenSquares(kingFrom, rookFrom)) && !(danger & kingPath);
+    };
+
+    if ((pos.castling & kingSideFlag) && (pos.bb[to_u(rook)] & (1ULL << kingSideRook)) && pathClear(kingSideRook, kingSidePath))
+        pushQuiet(out, kingFrom, kingFrom - 2, king, /*isDPP=*/false, /*isCastle=*/true);
+
+    if ((pos.castling & queenSideFlag) && (pos.bb[to_u(rook)] & (1ULL << queenSideRook)) && pathClear(queenSideRook, queenSidePath))
+        pushQuiet(out, kingFrom, kingFrom + 2, king, /*isDPP=*/false, /*isCastle=*/true);
+}
+
+template <Color Us>
+void MoveGen::genPseudoMoves(MoveList& out, uint64_t danger) const {
+    const uint64_t target = ~(Us == Color::White ? pos.occWhite : pos.occBlack());
+    genPawnMoves<Us>(out, target);
+    genPieceMoves<Us, WR>(out, target);
+    genPieceMoves<Us, WN>(out, target);
+    genPieceMoves<Us, WB>(out, target);
+    genPieceMoves<Us, WQ>(out, target);
+    genPieceMoves<Us, WK>(out, target & ~danger);
+    genCastling<Us>(out, danger);
+}
+
+template <Color Us>
+void MoveGen::genEvasions(MoveList& out, uint8_t kingSq, uint64_t danger) const {
+    uint64_t checkers = attackersTo<Us>(pos.bb, kingSq, pos.occAll);
     assert(checkers != 0); // King must be in check
-    genSafeKingMoves(out, kingSq); // King moves
+    genPieceMoves<Us, WK>(out, ~(Us == Color::White ? pos.occWhite : pos.occBlack()) & ~danger);
     if (std::popcount(checkers) >= 2) return; // Double check can only be escaped by king moves.
 
-    // Single checks (only one piece):
-    // Options are either capture the checker or block if its a sliding piece (rook, bishop, queen)
-    uint8_t attackSq = bitscanForward(checkers); // get square of attacker
-    bool sliding = isRookBishopQueen(enemyPieceAt(bb, attackSq, whiteToMove));
-    uint64_t blockSq = sliding ? rayBetween(kingSq, attackSq) : 0ULL;
-
-    // Capture the checker
-    genCapturesToSquare(out, attackSq);
+    // Single check: capture the checker or block between it and the king (empty for leapers)
+    const uint64_t target = checkers | betweenSquares(kingSq, bitscanForward(checkers));
+    genPawnMoves<Us>(out, target);
+    genPieceMoves<Us, WR>(out, target);
+    genPieceMoves<Us, WN>(out, target);
+    genPieceMoves<Us, WB>(out, target);
+    genPieceMoves<Us, WQ>(out, target);
+}
+
+// Direct checks land where the piece attacks their king from; a discoverer checks from anywhere
+// off its line to the king
+template <Color Us, Piece P>
+void MoveGen::genPieceChecks(MoveList& out, uint8_t theirKing, uint64_t discoverers) const {
+    constexpr Piece piece = colored(P, Us);
+    const uint64_t ours = Us == Color::White ? pos.occWhite : pos.occBlack();
+    const uint64_t direct = pieceAttacks<piece>(theirKing, pos.occAll);
+    forEachSetBit(pos.bb[to_u(piece)], [&](uint8_t from) {
+        uint64_t targets = direct;
+        if (discoverers & (1ULL << from)) targets |= ~lineThrough(theirKing, from);
+        pushTargets<Us>(out, from, pieceAttacks<piece>(from, pos.occAll) & targets & ~ours, piece);
+    });
+}
 
-    // Block the checker
-    if (blockSq) genQuietBlocks(out, blockSq);
+template <Color Us>
+void MoveGen::genChecks(MoveList& out, uint64_t danger) const {
+    constexpr bool white = Us == Color::White;
+    constexpr size_t us = white ? WP_CODE : BP_CODE;
+    const uint64_t ours = white ? pos.occWhite : pos.occBlack();
+    const uint8_t theirKing = bitscanForward(pos.bb[to_u(colored(WK, ~Us))]);
+
+    // Our pieces standing alone between one of our sliders and their king
+    const uint64_t snipers =
+            (rookAttacks(theirKing, 0) & (pos.bb[us + WR_CODE] | pos.bb[us + WQ_CODE])) |
+            (bishopAttacks(theirKing, 0) & (pos.bb[us + WB_CODE] | pos.bb[us + WQ_CODE]));
+    uint64_t discoverers = 0;
+    forEachSetBit(snipers, [&](uint8_t s) {
+        const uint64_t blockers = betweenSquares(theirKing, s) & pos.occAll;
+        if (std::has_single_bit(blockers) && (blockers & ours)) discoverers |= blockers;
+    });
 
-    // En passant block
-    if (epSquare != NUM_SQUARES) genEPBlock(out, blockSq);
+    // Pawns are generated as sets, then cut to pushes and captures that check
+    const size_t first = out.size();
+    genPawnMoves<Us>(out, ~ours);
+    const uint64_t pawnChecks = pawnAttacks(!white, theirKing);
+    out.erase(std::remove_if(out.begin() + first, out.end(), [&](uint32_t m) {
+        const uint8_t from = Move::from(m), to = Move::to(m);
+        if (Move::promo(m) != Move::PROMO_MASK || Move::isEP(m) || (pawnChecks & (1ULL << to))) return false;
+        return !(discoverers & (1ULL << from)) || (lineThrough(theirKing, from) & (1ULL << to));
+    }), out.end());
+
+    genPieceChecks<Us, WR>(out, theirKing, discoverers);
+    genPieceChecks<Us, WN>(out, theirKing, discoverers);
+    genPieceChecks<Us, WB>(out, theirKing, discoverers);
+    genPieceChecks<Us, WQ>(out, theirKing, discoverers);
+
+    // The king only checks by discovery, or with the rook when castling
+    constexpr Piece king = colored(WK, Us);
+    const uint8_t kingSq = bitscanForward(pos.bb[to_u(king)]);
+    if (discoverers & (1ULL << kingSq))
+        pushTargets<Us>(out, kingSq, kingAttacks(kingSq) & ~lineThrough(theirKing, kingSq) & ~ours & ~danger, king);
+    genCastling<Us>(out, danger);
+}
+
+template void MoveGen::genPseudoMoves<Color::White>(MoveList&, uint64_t) const;
+template void MoveGen::genPseudoMoves<Color::Black>(MoveList&, uint64_t) const;
+template void MoveGen::genEvasions<Color::White>(MoveList&, uint8_t, uint64_t) const;
+template void MoveGen::genEvasions<Color::Black>(MoveList&, uint8_t, uint64_t) const;
+template void MoveGen::genChecks<Color::White>(MoveList&, uint64_t) const;
+template void MoveGen::genChecks<Color::Black>(MoveList&, uint64_t) const;
+
+void MoveGen::genPseudoMoves(MoveList& out, uint64_t danger) const {
+    if (pos.whiteToMove) genPseudoMoves<Color::White>(out, danger);
+    else genPseudoMoves<Color::Black>(out, danger);
+}
+
+void MoveGen::genEvasions(MoveList& out, uint8_t kingSq, uint64_t danger) const {
+    if (pos.whiteToMove) genEvasions<Color::White>(out, kingSq, danger);
+    else genEvasions<Color::Black>(out, kingSq, danger);
 }
-
-MoveGen::MoveGen(Bitboards& bb, bool& whiteToMove, uint64_t& occWhite, uint64_t& occBlack, uint64_t& occAll, uint8_t& castling, uint8_t& epSquare) :
-    bb(bb),
-    whiteToMove(whiteToMove),
-    occWhite(occWhite),
-    occBlack(occBlack),
-    occAll(occAll),
-    castling(castling),
-    epSquare(epSquare)
-{}
\ No newline at end of file
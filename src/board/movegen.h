@@ -9,45 +9,41 @@
 #include <array>
 #include <vector>
 
+struct Position;
+
+// Generation is specialized on the side to move: every template takes Color Us, so piece codes,
+// directions and masks are compile-time constants. The untemplated entry points dispatch once.
+//
+// A MoveGen is a view of one position made for the call, e.g. MoveGen(board).genPseudoMoves(...);
+// it holds nothing but the reference.
+
 class MoveGen {
-    using Bitboards = std::array<uint64_t, 12>;
     using MoveList = std::vector<uint32_t>;
 private:
-    inline Piece sideToMoveKing() const;
-    inline Piece findPieceAt(uint8_t square, bool wantWhite) const;
-    inline uint64_t ourOcc() const;
-    inline uint64_t getOcc(bool all, bool isWhite=false, bool opposite=false) const;
-    inline bool isCastleFlag(Castling pair) const;
-    inline bool kingAt(bool isWhite, uint8_t sq) const;
-
-    void genPawnMovesFor(MoveList& out, Piece pawn) const;
-    void genRookMovesFor(MoveList& out, Piece rook) const;
-    void genKnightMovesFor(MoveList& from, Piece knight) const;
-    void genBishopMovesFor(MoveList& out, Piece bishop) const;
-    void genQueenMovesFor(MoveList& out, Piece queen) const;
-    void genKingMovesFor(MoveList& out, Piece king) const;
-
-    // Gen evasions helpers
-    void genSafeKingMoves(MoveList& out, uint8_t kingSq) const;
-    void genPieceCapturesToSquare(MoveList& out, uint8_t sq, Piece piece, Piece captured) const;
-    void genCapturesToSquare(MoveList& out, uint8_t attackSq) const;
-    void genPawnBlocksToMask(MoveList& out, uint64_t mask) const;
-    void genPieceBlocksToMask(MoveList& out, uint64_t mask, Piece piece) const;
-    void genQuietBlocks(MoveList& out, uint64_t mask) const;
-    void genEPBlock(MoveList& out, uint64_t mask) const;
+    template <Color Us> Piece enemyPieceOn(uint8_t square) const;
+    template <Color Us> void pushTargets(MoveList& out, uint8_t from, uint64_t targets, Piece moved) const;
+
+    // target restricts destination squares: everything but our own pieces, or the checker and the
+    // squares between it and our king when generating evasions
+    template <Color Us> void genPawnMoves(MoveList& out, uint64_t target) const;
+    template <Color Us, Piece P> void genPieceMoves(MoveList& out, uint64_t target) const;
+    template <Color Us> void genCastling(MoveList& out, uint64_t danger) const;
+    template <Color Us, Piece P> void genPieceChecks(MoveList& out, uint8_t theirKing, uint64_t discoverers) const;
 
 public:
-    void genPseudoMoves(MoveList& out) const;
-    void genEvasions(MoveList& out, uint8_t kingSq) const;
-    MoveGen(Bitboards& bb, bool& whiteToMove, uint64_t& occWhite, uint64_t& occBlack, uint64_t& occAll, uint8_t& castling, uint8_t& epSquare);
+    // danger is every square the enemy attacks with our king lifted off the board (Board::attackedBy),
+    // so king moves and castling are generated legal. Other moves still have to respect pins.
+    template <Color Us> void genPseudoMoves(MoveList& out, uint64_t danger) const;
+    template <Color Us> void genEvasions(MoveList& out, uint8_t kingSq, uint64_t danger) const;
+    // Out of check only: the moves that check their king, directly from a square that attacks it or
+    // by stepping off the line between it and one of our sliders. Exact for everything but
+    // promotions, en passant and castling, which are all kept for the caller to test.
+    template <Color Us> void genChecks(MoveList& out, uint64_t danger) const;
+    void genPseudoMoves(MoveList& out, uint64_t danger) const;
+    void genEvasions(MoveList& out, uint8_t kingSq, uint64_t danger) const;
+    explicit MoveGen(const Position& pos) : pos(pos) {}
 
 private:
-    Bitboards& bb;
-    bool& whiteToMove;
-    uint64_t& occWhite;
-    uint64_t& occBlack;
-    uint64_t& occAll;
-    uint8_t& castling;
-    uint8_t& epSquare;
+    const Position& pos;
 };
 #endif //TEMPO_MOVEGEN_H
@@ -0,0 +1,144 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "notation.h"
+#include "move.h"
+#include "utils.h"
+#include <cstring>
+
+static constexpr char PROMO_CHARS[] = { 'r', 'n', 'b', 'q' };
+static constexpr std::string_view SAN_PIECES = "PRNBQK"; // by piece type, code % 6
+
+std::string squareName(uint8_t square) {
+    return { char('h' - fileOf(square)), char('1' + rankOf(square)) };
+}
+
+uint8_t squareFromName(std::string_view name) {
+    if (name.size() < 2) return NUM_SQUARES;
+    char f = name[0], r = name[1];
+    if (f < 'a' || f > 'h' || r < '1' || r > '8') return NUM_SQUARES;
+    return sq('h' - f, r - '1');
+}
+
+std::string moveToUCI(uint32_t move) {
+    if (move == Move::NONE) return "0000";
+    std::string out = squareName(Move::from(move)) + squareName(Move::to(move));
+    if (Move::promo(move) != Move::PROMO_MASK) out += PROMO_CHARS[Move::promo(move)];
+    return out;
+}
+
+uint32_t moveFromUCI(Board& board, std::string_view uci) {
+    if (uci.size() < 4 || uci.size() > 5) return Move::NONE;
+    const uint8_t from = squareFromName(uci.substr(0, 2));
+    const uint8_t to = squareFromName(uci.substr(2, 2));
+    if (from == NUM_SQUARES || to == NUM_SQUARES) return Move::NONE;
+
+    uint8_t promo = Move::PROMO_MASK;
+    if (uci.size() == 5) {
+        for (uint8_t i = 0; i < to_u(Promo::PROMO_N); ++i)
+            if (PROMO_CHARS[i] == uci[4]) promo = i;
+        if (promo == Move::PROMO_MASK) return Move::NONE;
+    }
+
+    const uint32_t m = board.encodeMove(from, to, promo);
+    return board.isPseudoLegal(m) && board.isLegal(m) ? m : Move::NONE;
+}
+
+std::string moveToSAN(Board& board, uint32_t move) {
+    const uint8_t from = Move::from(move), to = Move::to(move);
+    const uint8_t type = Move::movedCode(move) % 6;
+    std::string out;
+
+    if (Move::isCastle(move)) {
+        out = fileOf(to) < fileOf(from) ? "O-O" : "O-O-O";
+    } else {
+        if (type == 0) {
+            if (Move::isCapture(move)) out += squareName(from)[0];
+        } else {
+            out += SAN_PIECES[type];
+            // Name the origin file, else its rank, else both, when another piece of the type can reach to
+            MoveList legal;
+            board.genLegalMoves(legal);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (auto m : legal) {
+                if (Move::movedCode(m) != Move::movedCode(move) || Move::to(m) != to || Move::from(m) == from) continue;
+                ambiguous = true;
+                sameFile |= fileOf(Move::from(m)) == fileOf(from);
+                sameRank |= rankOf(Move::from(m)) == rankOf(from);
+            }
+            const std::string origin = squareName(from);
+            if (ambiguous && !sameFile) out += origin[0];
+            else if (ambiguous && !sameRank) out += origin[1];
+            else if (ambiguous) out += origin;
+        }
+        if (Move::isCapture(move)) out += 'x';
+        out += squareName(to);
+        if (Move::promo(move) != Move::PROMO_MASK) {
+            out += '=';
+            out += SAN_PIECES[Move::promo(move) + 1];
+        }
+    }
+
+    if (board.givesCheck(move)) {
+        MoveList replies;
+        board.move(move);
+        board.genLegalMoves(replies);
+        board.undoMove(move);
+        out += replies.empty() ? '#' : '+';
+    }
+    return out;
+}
+
+uint32_t moveFromSAN(Board& board, std::string_view san, MoveList& legal) {
+    while (!san.empty() && std::strchr("+#!?", san.back())) san.remove_suffix(1);
+    board.genLegalMoves(legal);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        const bool kingSide = san.size() == 3;
+        for (auto m : legal)
+            if (Move::isCastle(m) && (fileOf(Move::to(m)) < fileOf(Move::from(m))) == kingSide) return m;
+        return Move::NONE;
+    }
+
+    // Promotion, written e8=Q or e8Q
+    uint8_t promo = Move::PROMO_MASK;
+    if (san.size() > 2 && SAN_PIECES.find(san.back()) != std::string_view::npos && san.back() != 'P' && san.back() != 'K') {
+        promo = uint8_t(SAN_PIECES.find(san.back()) - 1);
+        san.remove_suffix(1);
+        if (san.back() == '=') san.remove_suffix(1);
+    }
+
+    uint8_t type = 0;
+    if (!san.empty() && san[0] != 'P' && SAN_PIECES.find(san[0]) != std::string_view::npos) {
+        type = uint8_t(SAN_PIECES.find(san[0]));
+        san.remove_prefix(1);
+    }
+    if (san.size() < 2) return Move::NONE;
+    const uint8_t to = squareFromName(san.substr(san.size() - 2));
+    if (to == NUM_SQUARES) return Move::NONE;
+    san.remove_suffix(2);
+
+    // What is left is disambiguation and the capture mark
+    int fromFile = -1, fromRank = -1;
+    for (char c : san) {
+        if (c >= 'a' && c <= 'h') fromFile = 'h' - c;
+        else if (c >= '1' && c <= '8') fromRank = c - '1';
+        else if (c != 'x' && c != ':') return Move::NONE;
+    }
+
+    uint32_t found = Move::NONE;
+    for (auto m : legal) {
+        const uint8_t from = Move::from(m);
+        if (Move::movedCode(m) % 6 != type || Move::to(m) != to || Move::promo(m) != promo || Move::isCastle(m)) continue;
+        if ((fromFile >= 0 && fileOf(from) != fromFile) || (fromRank >= 0 && rankOf(from) != fromRank)) continue;
+        if (found != Move::NONE) return Move::NONE; // ambiguous
+        found = m;
+    }
+    return found;
+}
+
+uint32_t moveFromSAN(Board& board, std::string_view san) {
+    MoveList legal;
+    return moveFromSAN(board, san, legal);
+}
@@ -0,0 +1,31 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_NOTATION_H
+#define TEMPO_NOTATION_H
+
+#include "board.h"
+#include <string>
+#include <string_view>
+
+// Square names use the usual a1..h8 letters; file 0 on the board is the h-file.
+std::string squareName(uint8_t square);
+uint8_t squareFromName(std::string_view name); // NUM_SQUARES if malformed
+
+// Long algebraic (UCI) notation, e.g. e2e4, e7e8q, e1g1
+std::string moveToUCI(uint32_t move);
+
+// Resolves a UCI move against the legal moves of board, Move::NONE if illegal or malformed
+uint32_t moveFromUCI(Board& board, std::string_view uci);
+
+// Standard algebraic notation, e.g. Nbd7, exd5, e8=Q+, O-O-O#; move must be legal in board
+std::string moveToSAN(Board& board, uint32_t move);
+
+// Resolves SAN against the legal moves of board, ignoring check, mate and annotation suffixes.
+// Move::NONE if no legal move or more than one matches. legal receives the generated moves, so a
+// caller replaying many games can keep one list and never reallocate.
+uint32_t moveFromSAN(Board& board, std::string_view san, MoveList& legal);
+uint32_t moveFromSAN(Board& board, std::string_view san);
+
+#endif //TEMPO_NOTATION_H
@@ -0,0 +1,39 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_POSITION_H
+#define TEMPO_POSITION_H
+
+#include "types.h"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+using Bitboards = std::array<uint64_t, 12>;
+
+// The hot part of a position: everything move generation, make/unmake and hashing read, in two
+// cache lines. Plain data, so copying one is a memcpy and a copy can be handed to another thread;
+// keys come from the process-wide Zobrist tables and mean the same on every thread. History, the
+// full move number and derived caches stay with Board.
+struct alignas(64) Position {
+    // piece bb: WP, WR, WN, WB, WQ, WK, BP, BR, BN, BB, BQ, BK
+    Bitboards bb;
+
+    // occupancy bb; black's is the difference, which keeps the struct within two lines
+    uint64_t occWhite, occAll;
+    uint64_t occBlack() const { return occAll ^ occWhite; }
+
+    uint64_t key;
+
+    uint16_t halfMoveClock; // plies since the last capture or pawn move
+    uint16_t pliesFromNull; // plies since the last null move, repetitions are not looked for across one
+    uint8_t castling;       // bitmask: 1 for WK, 2 for WQ, 4 for BK, 8 for BQ
+    uint8_t epSquare;       // En passant square, NUM_SQUARES for none
+    bool whiteToMove;
+};
+
+static_assert(std::is_trivially_copyable_v<Position>);
+static_assert(sizeof(Position) == 128);
+
+#endif //TEMPO_POSITION_H
@@ -0,0 +1,56 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "stats.h"
+
+#ifdef TEMPO_STATS
+
+#include <deque>
+#include <mutex>
+#include <string_view>
+
+static constexpr std::array<std::string_view, NUM_STATS> STAT_NAMES = {
+    "pawn moves", "rook moves", "knight moves", "bishop moves", "queen moves", "king moves",
+    "evasion nodes", "normal nodes", "make", "unmake", "legality rejections", "attackersTo",
+    "castling path checks",
+};
+
+// A deque never moves its elements, so the thread_local pointers stay valid as blocks are added
+static std::mutex registryMutex;
+static std::deque<StatBlock> registry;
+
+StatBlock& stats::local() {
+    thread_local StatBlock* block = [] {
+        std::lock_guard lock(registryMutex);
+        return &registry.emplace_back();
+    }();
+    return *block;
+}
+
+std::array<uint64_t, NUM_STATS> stats::total() {
+    std::lock_guard lock(registryMutex);
+    std::array<uint64_t, NUM_STATS> sum{};
+    for (const auto& block : registry)
+        for (size_t i = 0; i < NUM_STATS; ++i) sum[i] += block.counts[i].load(std::memory_order_relaxed);
+    return sum;
+}
+
+// Only meaningful while no other thread is counting
+void stats::reset() {
+    std::lock_guard lock(registryMutex);
+    for (auto& block : registry)
+        for (auto& c : block.counts) c.store(0, std::memory_order_relaxed);
+}
+
+void stats::dump(std::ostream& out) {
+    const auto sum = total();
+    for (size_t i = 0; i < NUM_STATS; ++i) {
+        out << STAT_NAMES[i];
+        for (size_t pad = STAT_NAMES[i].size(); pad < 22; ++pad) out << ' ';
+        out << sum[i] << '\n';
+    }
+    out.flush();
+}
+
+#endif
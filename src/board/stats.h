@@ -0,0 +1,59 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_STATS_H
+#define TEMPO_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+// Hot-path event counts, built only with -DTEMPO_STATS=ON. In other builds TEMPO_STAT expands to
+// nothing, so the counting sites cost nothing.
+enum class Stat : uint8_t {
+    // moves generated (before the legality filter) by type of the moving piece, in piece code order;
+    // countLegalMoves, which generates nothing, adds the legal moves it counts
+    PawnMoves, RookMoves, KnightMoves, BishopMoves, QueenMoves, KingMoves,
+    EvasionNodes, NormalNodes, // genLegalMoves and countLegalMoves calls in check and out of check
+    MakeMove, UnmakeMove,
+    LegalityRejections,        // generated moves dropped by genLegalMoves
+    AttackersTo,
+    CastlingPathChecks,
+    COUNT
+};
+inline constexpr size_t NUM_STATS = static_cast<size_t>(Stat::COUNT);
+
+#ifdef TEMPO_STATS
+
+// One block per thread on its own cache lines. Only the owning thread writes it; relaxed atomics
+// make the read at dump time well defined and compile to plain adds.
+struct alignas(64) StatBlock {
+    std::array<std::atomic<uint64_t>, NUM_STATS> counts{};
+};
+
+namespace stats {
+    StatBlock& local(); // this thread's block, registered on first use and kept after the thread exits
+
+    inline void add(Stat stat, uint64_t n = 1) {
+        auto& c = local().counts[static_cast<size_t>(stat)];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::array<uint64_t, NUM_STATS> total(); // summed over every thread that counted
+    void reset();
+    void dump(std::ostream& out);
+}
+
+#define TEMPO_STAT(stat) stats::add(Stat::stat)
+#define TEMPO_STAT_ADD(stat, n) stats::add(Stat::stat, (n))
+
+#else
+
+#define TEMPO_STAT(stat) ((void)0)
+#define TEMPO_STAT_ADD(stat, n) ((void)0)
+
+#endif
+
+#endif //TEMPO_STATS_H
@@ -16,6 +16,12 @@ constexpr auto to_u(E e) noexcept -> std::underlying_type_t<E> {
 enum class Piece    : uint8_t { WP, WR, WN, WB, WQ, WK, BP, BR, BN, BB, BQ, BK, PIECE_N, None=0xF};
 enum class Promo    : uint8_t { R, N, B, Q, PROMO_N, None=0xF};
 enum class Castling : uint8_t { None=0, W_K = 1<<0, W_Q = 1<<1, B_K = 1<<2, B_Q = 1<<3};
+enum class Color    : uint8_t { White, Black };
+
+// ---------- Colors ----------
+// Color-templated code picks its pieces and directions with these at compile time
+constexpr Color operator~(Color c) { return c == Color::White ? Color::Black : Color::White; }
+constexpr Piece colored(Piece piece, Color c) { return static_cast<Piece>(to_u(piece) % 6 + (c == Color::White ? 0 : 6)); }
 
 // ---------- Piece Groups ----------
 inline constexpr std::array<Piece, 6> WHITE_PIECES { Piece::WP, Piece::WR, Piece::WN, Piece::WB, Piece::WQ, Piece::WK };
@@ -51,9 +57,12 @@ inline constexpr uint8_t B_Q_FLAG = to_u(Castling::B_Q);
 // ---------- Board Constants ----------
 inline constexpr uint64_t RANK_1 = 0x00000000000000FFULL;
 inline constexpr uint64_t RANK_2 = 0x000000000000FF00ULL;
+inline constexpr uint64_t RANK_3 = 0x0000000000FF0000ULL;
 inline constexpr uint64_t RANK_6 = 0x0000FF0000000000ULL;
 inline constexpr uint64_t RANK_7 = 0x00FF000000000000ULL;
 inline constexpr uint64_t RANK_8 = 0xFF00000000000000ULL;
+inline constexpr uint64_t FILE_H_MASK = 0x0101010101010101ULL; // file 0
+inline constexpr uint64_t FILE_A_MASK = 0x8080808080808080ULL; // file 7
 
 inline constexpr uint8_t EIGHTH_RANK = 7;
 inline constexpr uint8_t SEVENTH_RANK = 6;
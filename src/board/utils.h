@@ -7,16 +7,17 @@
 
 #include "types.h"
 #include "utils.h"
-#include <random>
 #include <type_traits>
 #include <stdexcept>
 
-static uint64_t random_u64() {
-    static std::mt19937_64 rng(std::random_device{}());
-    return rng();
+// splitmix64: a fixed seed gives the same stream on every run and platform
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
 }
 
-
 // delta ∈ {+1,-1,+8,-8,+9,-9,+7,-7}
 inline constexpr bool stepFromDelta(int8_t delta, int8_t& dx, int8_t& dy) {
     switch (delta) {
@@ -53,6 +54,10 @@ using Bitboards = std::array<uint64_t, 12>;
 inline int bitscanForward(uint64_t bitboard) { return __builtin_ctzll(bitboard); }
 inline uint64_t lsbReset(uint64_t number) { return number & (number - 1); }
 
+// Whole-board shift by a compile-time square delta, positive towards the eighth rank
+template <int D>
+inline constexpr uint64_t shift(uint64_t bitboard) { return D > 0 ? bitboard << D : bitboard >> -D; }
+
 // Iterate all set bits with a lambda f
 template <typename F>
 inline void forEachSetBit(uint64_t bb, F f) {
@@ -60,8 +65,8 @@ inline void forEachSetBit(uint64_t bb, F f) {
 }
 
 // board helpers
-inline uint8_t rankOf(uint8_t square) { return square / NUM_SQUARES_IN_ROW; }
-inline uint8_t fileOf(uint8_t square) { return square % NUM_SQUARES_IN_ROW; }
+inline constexpr uint8_t rankOf(uint8_t square) { return square / NUM_SQUARES_IN_ROW; }
+inline constexpr uint8_t fileOf(uint8_t square) { return square % NUM_SQUARES_IN_ROW; }
 inline bool squareInBoard(int8_t square) { return 0 <= square && square < NUM_SQUARES; }
 inline bool rankInBoard(int8_t rank) { return 0 <= rank && rank < NUM_SQUARES_IN_ROW; }
 inline bool fileInBoard(int8_t file) { return 0 <= file && file < NUM_SQUARES_IN_ROW; }
@@ -85,12 +90,16 @@ inline bool isRook(Piece piece) { return piece == Piece::WR || piece == Piece::B
 inline bool isKnight(Piece piece) { return piece == Piece::WN || piece == Piece::BN; }
 inline bool isBishop(Piece piece) { return piece == Piece::WB || piece == Piece::BB; }
 inline bool isQueen(Piece piece) { return piece == Piece::WQ || piece == Piece::BQ; }
+inline bool isKing(Piece piece) { return piece == Piece::WK || piece == Piece::BK; }
 inline bool isRookBishopQueen(Piece piece) { return isRook(piece) || isBishop(piece) || isQueen(piece); }
 inline bool isPawnKnight(Piece piece) { return isPawn(piece) || isKnight(piece); }
 
 inline Piece getOtherPiece(Piece piece) { return static_cast<Piece>((to_u(piece) + 6) % to_u(Piece::PIECE_N)); }
 inline uint8_t getOtherPieceCode(Piece piece) { return (to_u(piece) + 6) % to_u(Piece::PIECE_N); }
 
+// Promo::R..Q map onto WR..WQ / BR..BQ
+inline uint8_t promoPieceCode(uint8_t promoCode, bool meWhite) { return promoCode + (meWhite ? WR_CODE : BR_CODE); }
+
 inline Piece getOurPawn(bool meWhite) { return meWhite ? Piece::WP : Piece::BP; }
 inline Piece getOurRook(bool meWhite) { return meWhite ? Piece::WR : Piece::BR; }
 inline Piece getOurKnight(bool meWhite) { return meWhite ? Piece::WN : Piece::BN; }
@@ -174,16 +183,16 @@ inline bool diagHopValid(uint8_t from, uint8_t to) {
 
 
 inline bool pieceInBoard (uint8_t square, uint64_t occ) {return (1ULL << square) & occ; }
-inline bool isPieceAtSquare(Bitboards& bb, Piece piece, uint8_t square) { return (bb[to_u(piece)] >> square) & 1; }
+inline bool isPieceAtSquare(const Bitboards& bb, Piece piece, uint8_t square) { return (bb[to_u(piece)] >> square) & 1; }
 
-inline uint8_t kingSquare(Bitboards& bb, bool isWhite) { return isWhite ? bitscanForward(bb[WK_CODE]) : bitscanForward(bb[BK_CODE]); }
+inline uint8_t kingSquare(const Bitboards& bb, bool isWhite) { return isWhite ? bitscanForward(bb[WK_CODE]) : bitscanForward(bb[BK_CODE]); }
 
-inline bool friendlyAt(Bitboards& bb, uint8_t square, bool meWhite) {
+inline bool friendlyAt(const Bitboards& bb, uint8_t square, bool meWhite) {
     const auto& set = meWhite ? WHITE_PIECES : BLACK_PIECES;
     for (auto p : set) if (isPieceAtSquare(bb, p, square)) return true;
     return false;
 }
-inline Piece enemyPieceAt(Bitboards& bb, uint8_t square, bool meWhite) {
+inline Piece enemyPieceAt(const Bitboards& bb, uint8_t square, bool meWhite) {
     const auto& set = meWhite ? BLACK_PIECES : WHITE_PIECES;
     for (auto p : set) if (isPieceAtSquare(bb, p, square)) return p;
     return Piece::None;
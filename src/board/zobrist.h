@@ -10,7 +10,12 @@
 #include <cstdint>
 #include <array>
 
+// Seed of the key tables. Keys are the same on every run, so anything stored under them (hash
+// files) stays valid; change it and such files are rejected.
+inline constexpr uint64_t ZOBRIST_SEED = 0x54656D706F5A6231ULL; // "TempoZb1"
+
 struct Zobrist {
+    const uint64_t seed;
     const std::array<std::array<uint64_t, NUM_SQUARES>, size_t(Piece::PIECE_N)> pieces;
     const uint64_t blackToMove;
     const std::array<uint64_t, CASTLING_N> castling;
@@ -18,25 +23,32 @@ struct Zobrist {
 
     uint64_t key;
 public:
-    Zobrist() :
-        pieces([] {
+    explicit Zobrist(uint64_t seed = ZOBRIST_SEED) :
+        seed(seed),
+        pieces([&] {
+            uint64_t state = seed;
             std::array<std::array<uint64_t, NUM_SQUARES>, (size_t)Piece::PIECE_N> tmp{};
             for(size_t piece = 0; piece < (size_t)Piece::PIECE_N; ++piece)
                 for (size_t square = 0; square < NUM_SQUARES; ++square)
-                    tmp[piece][square] = random_u64();
+                    tmp[piece][square] = splitmix64(state);
             return tmp;
         }()),
-        blackToMove(random_u64()),
-        castling([] {
+        blackToMove([&] {
+            uint64_t state = seed ^ 1;
+            return splitmix64(state);
+        }()),
+        castling([&] {
+            uint64_t state = seed ^ 2;
             std::array<uint64_t, CASTLING_N> tmp{};
             for(size_t piece = 0; piece < CASTLING_N; ++piece)
-                tmp[piece] = random_u64();
+                tmp[piece] = splitmix64(state);
             return tmp;
         }()),
-        epFile([] {
+        epFile([&] {
+            uint64_t state = seed ^ 3;
             std::array<uint64_t, NUM_SQUARES_IN_ROW> tmp{};
             for(size_t piece = 0; piece < NUM_SQUARES_IN_ROW; ++piece)
-                tmp[piece] = random_u64();
+                tmp[piece] = splitmix64(state);
             return tmp;
         }()),
         key([&] {
@@ -53,6 +65,44 @@ public:
     {}
 
     uint64_t getKey() const { return key; };
+
+    // Digest of every key, recorded next to the seed so a change in how the tables are derived
+    // is caught as well
+    uint64_t fingerprint() const {
+        uint64_t h = seed;
+        const auto mix = [&](uint64_t k) { h = (h ^ k) * 0x100000001B3ULL; h ^= h >> 29; };
+        for (const auto& square : pieces) for (uint64_t k : square) mix(k);
+        mix(blackToMove);
+        for (uint64_t k : castling) mix(k);
+        for (uint64_t k : epFile) mix(k);
+        return h;
+    }
 };
 
+// One set of tables for the whole process, so keys agree between boards and threads
+inline const Zobrist& zobristKeys() {
+    static const Zobrist keys;
+    return keys;
+}
+
+// ---------- Polyglot ----------
+// Polyglot books are keyed by their own 781 randoms: 12 * 64 piece-square keys (kind * 64 + square,
+// kinds ordered bp, wp, bn, wn, bb, wb, br, wr, bq, wq, bk, wk and squares a1 = 0 .. h8 = 63),
+// then castling (K, Q, k, q), en passant file (a..h) and white to move.
+inline constexpr size_t POLYGLOT_CASTLE_OFFSET = 768;
+inline constexpr size_t POLYGLOT_EP_OFFSET = 772;
+inline constexpr size_t POLYGLOT_TURN_OFFSET = 780;
+inline constexpr size_t POLYGLOT_RANDOM_N = 781;
+
+using PolyglotRandoms = std::array<uint64_t, POLYGLOT_RANDOM_N>;
+
+// The published Random64 table, so keys match books written by any other program. It is a
+// constant, so any thread may key positions at any time.
+inline const PolyglotRandoms& polyglotRandoms() {
+    static constexpr PolyglotRandoms table = {
+#include "polyglot_random64.inc"
+    };
+    return table;
+}
+
 #endif //TEMPO_ZOBRIST_H
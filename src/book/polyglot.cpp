@@ -0,0 +1,235 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "polyglot.h"
+#include "move.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Polyglot kind per piece code: WP, WR, WN, WB, WQ, WK, BP, BR, BN, BB, BQ, BK
+static constexpr std::array<uint8_t, 12> POLYGLOT_KIND = { 1, 7, 3, 5, 9, 11, 0, 6, 2, 4, 8, 10 };
+
+// Polyglot promo code (n, b, r, q = 1..4) per Promo (R, N, B, Q)
+static constexpr std::array<uint8_t, 4> POLYGLOT_PROMO = { 3, 1, 2, 4 };
+static constexpr std::array<uint8_t, 5> PROMO_FROM_POLYGLOT = { 0xF, to_u(Promo::N), to_u(Promo::B), to_u(Promo::R), to_u(Promo::Q) };
+
+// Polyglot counts files from a, Tempo from h
+static inline uint8_t toPolyglotSquare(uint8_t square) { return rankOf(square) * NUM_SQUARES_IN_ROW + (7 - fileOf(square)); }
+static inline uint8_t fromPolyglotSquare(uint8_t square) { return sq(7 - square % NUM_SQUARES_IN_ROW, square / NUM_SQUARES_IN_ROW); }
+
+static inline uint64_t readBE64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return __builtin_bswap64(v); }
+static inline uint32_t readBE32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return __builtin_bswap32(v); }
+static inline uint16_t readBE16(const uint8_t* p) { uint16_t v; std::memcpy(&v, p, 2); return __builtin_bswap16(v); }
+
+uint64_t polyglotKey(const Board& board) {
+    const PolyglotRandoms& random = polyglotRandoms();
+    uint64_t key = 0;
+
+    for (uint8_t piece = 0; piece < to_u(Piece::PIECE_N); ++piece)
+        forEachSetBit(board.bb[piece], [&](uint8_t square) {
+            key ^= random[64 * POLYGLOT_KIND[piece] + toPolyglotSquare(square)];
+        });
+
+    if (board.castling & W_K_FLAG) key ^= random[POLYGLOT_CASTLE_OFFSET + 0];
+    if (board.castling & W_Q_FLAG) key ^= random[POLYGLOT_CASTLE_OFFSET + 1];
+    if (board.castling & B_K_FLAG) key ^= random[POLYGLOT_CASTLE_OFFSET + 2];
+    if (board.castling & B_Q_FLAG) key ^= random[POLYGLOT_CASTLE_OFFSET + 3];
+
+    // The ep file only counts when a pawn of the side to move could actually capture
+    if (board.epSquare != NUM_SQUARES) {
+        const uint8_t pawnRank = board.whiteToMove ? FIFTH_RANK : FOURTH_RANK;
+        const uint64_t ourPawns = board.bb[board.whiteToMove ? WP_CODE : BP_CODE];
+        const int8_t epFile = fileOf(board.epSquare);
+        uint64_t adjacent = 0;
+        if (fileInBoard(epFile - 1)) adjacent |= 1ULL << sq(epFile - 1, pawnRank);
+        if (fileInBoard(epFile + 1)) adjacent |= 1ULL << sq(epFile + 1, pawnRank);
+        if (ourPawns & adjacent) key ^= random[POLYGLOT_EP_OFFSET + (7 - epFile)];
+    }
+
+    if (board.whiteToMove) key ^= random[POLYGLOT_TURN_OFFSET];
+    return key;
+}
+
+uint16_t moveToPolyglot(uint32_t move) {
+    const uint8_t from = Move::from(move);
+    uint8_t to = Move::to(move);
+    if (Move::isCastle(move)) // king "captures" its own rook
+        to = sq(fileOf(to) < fileOf(from) ? 0 : 7, rankOf(from));
+
+    uint16_t poly = toPolyglotSquare(to) | (toPolyglotSquare(from) << 6);
+    if (Move::promo(move) != Move::PROMO_MASK) poly |= POLYGLOT_PROMO[Move::promo(move)] << 12;
+    return poly;
+}
+
+uint32_t polyglotToMove(const Board& board, uint16_t polyMove) {
+    const uint8_t from = fromPolyglotSquare((polyMove >> 6) & 0x3F);
+    uint8_t to = fromPolyglotSquare(polyMove & 0x3F);
+    const uint8_t promoBits = (polyMove >> 12) & 0x7;
+    if (promoBits > 4) return Move::NONE;
+
+    // e1h1 / e1a1 style castling
+    const bool kingMove = board.bb[to_u(getOurKing(board.whiteToMove))] & (1ULL << from);
+    if (kingMove && (board.bb[to_u(getOurRook(board.whiteToMove))] & (1ULL << to)))
+        to = sq(fileOf(to) < fileOf(from) ? fileOf(from) - 2 : fileOf(from) + 2, rankOf(from));
+
+    return board.encodeMove(from, to, promoBits ? PROMO_FROM_POLYGLOT[promoBits] : Move::PROMO_MASK);
+}
+
+// ---------- PolyglotBook ----------
+
+bool PolyglotBook::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)POLYGLOT_ENTRY_SIZE) { ::close(fd); return false; }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (map == MAP_FAILED) return false;
+    madvise(map, st.st_size, MADV_RANDOM);
+
+    data = static_cast<const uint8_t*>(map);
+    bytes = st.st_size;
+    count = bytes / POLYGLOT_ENTRY_SIZE;
+    return true;
+}
+
+void PolyglotBook::close() {
+    if (data) munmap(const_cast<uint8_t*>(data), bytes);
+    data = nullptr;
+    bytes = count = 0;
+}
+
+PolyglotBook::~PolyglotBook() { close(); }
+
+PolyglotEntry PolyglotBook::entryAt(size_t i) const {
+    const uint8_t* p = data + i * POLYGLOT_ENTRY_SIZE;
+    return { readBE64(p), readBE16(p + 8), readBE16(p + 10), readBE32(p + 12) };
+}
+
+size_t PolyglotBook::lowerBound(uint64_t key) const {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (readBE64(data + mid * POLYGLOT_ENTRY_SIZE) < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t PolyglotBook::entries(uint64_t key, PolyglotEntry* out, size_t maxOut) const {
+    size_t n = 0;
+    for (size_t i = lowerBound(key); i < count; ++i, ++n) {
+        PolyglotEntry e = entryAt(i);
+        if (e.key != key) break;
+        if (n < maxOut) out[n] = e;
+    }
+    return n;
+}
+
+// Entries of a colliding key, or from a corrupt book, decode to moves that are not legal here
+static uint32_t legalBookMove(const Board& board, uint16_t polyMove) {
+    const uint32_t m = polyglotToMove(board, polyMove);
+    return board.isPseudoLegal(m) && board.isLegal(m) ? m : Move::NONE;
+}
+
+uint32_t PolyglotBook::probe(const Board& board, uint64_t rnd) const {
+    if (!data) return Move::NONE;
+    const uint64_t key = polyglotKey(board);
+    const size_t first = lowerBound(key);
+
+    uint64_t total = 0;
+    size_t last = first;
+    for (; last < count && readBE64(data + last * POLYGLOT_ENTRY_SIZE) == key; ++last)
+        total += readBE16(data + last * POLYGLOT_ENTRY_SIZE + 10);
+    if (total == 0) return Move::NONE;
+
+    uint64_t pick = rnd % total;
+    for (size_t i = first; i < last; ++i) {
+        PolyglotEntry e = entryAt(i);
+        if (pick < e.weight) return legalBookMove(board, e.move);
+        pick -= e.weight;
+    }
+    return Move::NONE;
+}
+
+uint32_t PolyglotBook::probeBest(const Board& board) const {
+    if (!data) return Move::NONE;
+    const uint64_t key = polyglotKey(board);
+    PolyglotEntry best{0, 0, 0, 0};
+    bool found = false;
+    for (size_t i = lowerBound(key); i < count; ++i) {
+        PolyglotEntry e = entryAt(i);
+        if (e.key != key) break;
+        if (!found || e.weight > best.weight) best = e;
+        found = true;
+    }
+    return found ? legalBookMove(board, best.move) : Move::NONE;
+}
+
+// ---------- PolyglotBookBuilder ----------
+
+void PolyglotBookBuilder::add(uint64_t key, uint16_t move, uint16_t weight) {
+    pending.push_back({key, move, weight, 0});
+}
+
+bool PolyglotBookBuilder::addGame(Board& board, const std::vector<uint32_t>& moves, int result, size_t maxPly) {
+    size_t played = 0;
+    bool ok = true;
+    for (auto m : moves) {
+        if (played >= maxPly) break;
+        // Legality is the caller's job (moves come from Board); guard only against foreign pieces
+        if (polyglotToMove(board, moveToPolyglot(m)) != m) { ok = false; break; }
+
+        const int mover = board.whiteToMove ? 1 : -1;
+        const uint16_t weight = result == 0 ? 1 : (result == mover ? 2 : 0);
+        if (weight) add(polyglotKey(board), moveToPolyglot(m), weight);
+
+        board.move(m);
+        ++played;
+    }
+    for (size_t i = played; i > 0; --i) board.undoMove(moves[i - 1]);
+    return ok;
+}
+
+bool PolyglotBookBuilder::write(const std::string& path) {
+    std::sort(pending.begin(), pending.end(), [](const PolyglotEntry& a, const PolyglotEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.move < b.move;
+    });
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    std::vector<std::pair<uint16_t, uint64_t>> moves; // reused per key
+    for (size_t i = 0; i < pending.size();) {
+        const uint64_t key = pending[i].key;
+        moves.clear();
+        uint64_t maxWeight = 0;
+        for (; i < pending.size() && pending[i].key == key; ++i) {
+            if (moves.empty() || moves.back().first != pending[i].move) moves.emplace_back(pending[i].move, 0);
+            moves.back().second += pending[i].weight;
+            maxWeight = std::max(maxWeight, moves.back().second);
+        }
+
+        for (auto [move, sum] : moves) {
+            uint64_t weight = maxWeight > 0xFFFF ? std::max<uint64_t>(1, sum * 0xFFFF / maxWeight) : sum;
+            uint8_t buf[POLYGLOT_ENTRY_SIZE]{};
+            uint64_t k = __builtin_bswap64(key);
+            uint16_t m = __builtin_bswap16(move), w = __builtin_bswap16(uint16_t(weight));
+            std::memcpy(buf, &k, 8);
+            std::memcpy(buf + 8, &m, 2);
+            std::memcpy(buf + 10, &w, 2);
+            out.write(reinterpret_cast<const char*>(buf), POLYGLOT_ENTRY_SIZE);
+        }
+    }
+    return bool(out);
+}
@@ -0,0 +1,81 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_POLYGLOT_H
+#define TEMPO_POLYGLOT_H
+
+#include "board.h"
+#include "zobrist.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk entry, 16 bytes big-endian, sorted by key
+struct PolyglotEntry {
+    uint64_t key;
+    uint16_t move;   // 0-2 to file, 3-5 to row, 6-8 from file, 9-11 from row, 12-14 promo (n, b, r, q = 1..4)
+    uint16_t weight;
+    uint32_t learn;
+};
+
+inline constexpr size_t POLYGLOT_ENTRY_SIZE = 16;
+
+uint64_t polyglotKey(const Board& board);
+
+// Castling is written king-takes-rook (e1h1) as Polyglot expects
+uint16_t moveToPolyglot(uint32_t move);
+
+// Move::NONE if the side to move has no piece on the from square; legality is not checked
+uint32_t polyglotToMove(const Board& board, uint16_t polyMove);
+
+// Read-only view of a memory-mapped book. Probing does a binary search over the mapping and never
+// allocates, so one file can be shared by any number of processes through the page cache.
+class PolyglotBook {
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+    size_t size() const { return count; }
+
+    // Copies up to maxOut entries for key into out, returns how many exist
+    size_t entries(uint64_t key, PolyglotEntry* out, size_t maxOut) const;
+
+    // Weighted pick among the moves stored for board, rnd supplies the randomness. Both probes
+    // return Move::NONE rather than a move that is illegal in board.
+    uint32_t probe(const Board& board, uint64_t rnd) const;
+    // Highest weight move stored for board
+    uint32_t probeBest(const Board& board) const;
+
+    PolyglotBook() = default;
+    PolyglotBook(const PolyglotBook&) = delete;
+    PolyglotBook& operator=(const PolyglotBook&) = delete;
+    ~PolyglotBook();
+
+private:
+    PolyglotEntry entryAt(size_t i) const;
+    size_t lowerBound(uint64_t key) const;
+
+    const uint8_t* data = nullptr;
+    size_t bytes = 0;
+    size_t count = 0;
+};
+
+// Collects (position, move) pairs from played games and writes a sorted book
+class PolyglotBookBuilder {
+public:
+    // result from white's point of view: 1 win, 0 draw, -1 loss. Moves of the winning side get
+    // weight 2, drawn games 1 per side, moves of the losing side are not recorded.
+    // Replays on board and restores it; returns false at the first illegal move.
+    bool addGame(Board& board, const std::vector<uint32_t>& moves, int result, size_t maxPly = 40);
+    void add(uint64_t key, uint16_t move, uint16_t weight);
+
+    // Merges duplicates (weights summed, then scaled to fit 16 bits) and writes big-endian entries
+    bool write(const std::string& path);
+    size_t size() const { return pending.size(); }
+
+private:
+    std::vector<PolyglotEntry> pending;
+};
+
+#endif //TEMPO_POLYGLOT_H
@@ -0,0 +1,303 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "tempo.h"
+#include "board.h"
+#include "notation.h"
+#include "polyglot.h"
+#include "training.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+static_assert(sizeof(TrainingRecord) == TEMPO_RECORD_SIZE);
+
+// A board with move lists for every perft ply, reserved up front so batches never allocate
+struct tempo_position {
+    Board board = Board();
+    MoveList moves;
+    std::vector<MoveList> plies = std::vector<MoveList>(TEMPO_MAX_PERFT_DEPTH);
+
+    tempo_position() {
+        moves.reserve(TEMPO_MAX_MOVES);
+        for (auto& list : plies) list.reserve(TEMPO_MAX_MOVES);
+    }
+};
+
+// Workers parked on a condition variable between batches. A batch is a function pointer and
+// context, its items claimed in chunks from a shared counter by the workers and the caller alike.
+struct tempo_pool {
+    using Job = void (*)(void* context, size_t item);
+
+    // A thread that fails to start stops the ones already running, so the failure reaches
+    // tempo_pool_new instead of terminating in ~vector<std::thread>
+    explicit tempo_pool(unsigned threads) {
+        try {
+            for (unsigned t = 1; t < threads; ++t) workers.emplace_back([this] { workerLoop(); });
+        } catch (...) {
+            stop();
+            throw;
+        }
+    }
+
+    ~tempo_pool() { stop(); }
+
+    unsigned threads() const { return unsigned(workers.size()) + 1; }
+
+    void run(size_t n, Job fn, void* ctx) {
+        std::lock_guard batch(running);
+        {
+            std::lock_guard lock(mutex);
+            job = fn;
+            context = ctx;
+            items = n;
+            chunk = std::max<size_t>(1, n / (threads() * 8));
+            next.store(0, std::memory_order_relaxed);
+            busy = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        work();
+        std::unique_lock lock(mutex);
+        finished.wait(lock, [this] { return busy == 0; });
+    }
+
+private:
+    void stop() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    void work() {
+        for (size_t begin; (begin = next.fetch_add(chunk, std::memory_order_relaxed)) < items;)
+            for (size_t i = begin, end = std::min(items, begin + chunk); i < end; ++i) job(context, i);
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work();
+            std::lock_guard lock(mutex);
+            if (--busy == 0) finished.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex running, mutex;
+    std::condition_variable wake, finished;
+    uint64_t generation = 0;
+    size_t busy = 0;
+    bool stopping = false;
+
+    Job job = nullptr;
+    void* context = nullptr;
+    size_t items = 0, chunk = 1;
+    std::atomic<size_t> next{0};
+};
+
+namespace {
+
+// Calls f(i) for i in [0, n), on the pool if there is one worth waking
+template <typename F>
+void forEachItem(tempo_pool* pool, size_t n, F&& f) {
+    if (!pool || pool->threads() == 1 || n < 2) {
+        for (size_t i = 0; i < n; ++i) f(i);
+        return;
+    }
+    pool->run(n, [](void* ctx, size_t i) { (*static_cast<std::remove_reference_t<F>*>(ctx))(i); }, &f);
+}
+
+// Internal squares run from the h-file (h1 = 0, a1 = 7), the interface's from the a-file
+constexpr uint8_t flipFile(uint8_t square) { return square ^ 7; }
+
+tempo_move toExternal(uint32_t move) {
+    static constexpr uint8_t PROMOS[8] = { TEMPO_PROMO_ROOK, TEMPO_PROMO_KNIGHT, TEMPO_PROMO_BISHOP, TEMPO_PROMO_QUEEN,
+                                           0, 0, 0, TEMPO_PROMO_NONE };
+    return tempo_move(flipFile(Move::from(move)) | flipFile(Move::to(move)) << 6 | PROMOS[Move::promo(move)] << 12);
+}
+
+// The legal move in board matching m, Move::NONE if there is none
+uint32_t toInternal(const Board& board, tempo_move m) {
+    static constexpr uint8_t PROMOS[5] = { Move::PROMO_MASK, uint8_t(Promo::N), uint8_t(Promo::B), uint8_t(Promo::R), uint8_t(Promo::Q) };
+    const unsigned promo = m >> 12;
+    if (promo > TEMPO_PROMO_QUEEN) return Move::NONE;
+    const uint32_t move = board.encodeMove(flipFile(m & 63), flipFile(m >> 6 & 63), PROMOS[promo]);
+    return board.isPseudoLegal(move) && board.isLegal(move) ? move : Move::NONE;
+}
+
+uint64_t perft(tempo_position& p, int depth, int ply) {
+    if (depth == 1) return p.board.countLegalMoves();
+    MoveList& moves = p.plies[ply];
+    p.board.genLegalMoves(moves);
+    uint64_t nodes = 0;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const uint32_t m = moves[i];
+        p.board.move(m);
+        nodes += perft(p, depth - 1, ply + 1);
+        p.board.undoMove(m);
+    }
+    return nodes;
+}
+
+bool anyNull(tempo_position* const* positions, size_t n) {
+    return std::any_of(positions, positions + n, [](const tempo_position* p) { return p == nullptr; });
+}
+
+}
+
+extern "C" {
+
+int tempo_api_version(void) { return TEMPO_API_VERSION; }
+
+tempo_position* tempo_position_new(void) {
+    try {
+        return new tempo_position();
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void tempo_position_free(tempo_position* position) { delete position; }
+
+int tempo_position_set_fen(tempo_position* position, const char* fen) {
+    if (!position || !fen) return TEMPO_ERR_ARGUMENT;
+    return position->board.setFromFEN(fen) ? TEMPO_OK : TEMPO_ERR_FEN;
+}
+
+int tempo_position_set_record(tempo_position* position, const void* record) {
+    if (!position || !record) return TEMPO_ERR_ARGUMENT;
+    TrainingRecord r;
+    std::memcpy(&r, record, sizeof r);
+    if (!isValidRecord(r)) return TEMPO_ERR_RECORD;
+    unpackRecord(r, position->board);
+    return TEMPO_OK;
+}
+
+int tempo_position_apply_moves(tempo_position* position, const tempo_move* moves, size_t n, size_t* applied) {
+    if (applied) *applied = 0;
+    if (!position || (!moves && n)) return TEMPO_ERR_ARGUMENT;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t m = toInternal(position->board, moves[i]);
+        if (m == Move::NONE) return TEMPO_ERR_MOVE;
+        position->board.move(m);
+        if (applied) ++*applied;
+    }
+    return TEMPO_OK;
+}
+
+int tempo_position_apply_uci(tempo_position* position, const char* moves, size_t* applied) {
+    if (applied) *applied = 0;
+    if (!position || !moves) return TEMPO_ERR_ARGUMENT;
+    std::string_view rest(moves);
+    while (!rest.empty()) {
+        const size_t start = rest.find_first_not_of(' ');
+        if (start == std::string_view::npos) break;
+        rest.remove_prefix(start);
+        const std::string_view token = rest.substr(0, rest.find(' '));
+        rest.remove_prefix(token.size());
+        const uint32_t m = moveFromUCI(position->board, token);
+        if (m == Move::NONE) return TEMPO_ERR_MOVE;
+        position->board.move(m);
+        if (applied) ++*applied;
+    }
+    return TEMPO_OK;
+}
+
+int tempo_position_white_to_move(const tempo_position* position) {
+    return position && position->board.whiteToMove;
+}
+
+uint64_t tempo_position_key(const tempo_position* position) {
+    return position ? polyglotKey(position->board) : 0;
+}
+
+int tempo_position_legal_moves(tempo_position* position, tempo_move* out, size_t capacity) {
+    if (!position || (!out && capacity)) return TEMPO_ERR_ARGUMENT;
+    position->board.genLegalMoves(position->moves);
+    if (position->moves.size() > capacity) return TEMPO_ERR_CAPACITY;
+    std::transform(position->moves.begin(), position->moves.end(), out, toExternal);
+    return int(position->moves.size());
+}
+
+tempo_pool* tempo_pool_new(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    try {
+        return new tempo_pool(threads);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void tempo_pool_free(tempo_pool* pool) { delete pool; }
+
+unsigned tempo_pool_threads(const tempo_pool* pool) { return pool ? pool->threads() : 1; }
+
+int tempo_batch_count_moves(tempo_pool* pool, tempo_position* const* positions, size_t n, uint32_t* counts) {
+    if ((!positions || !counts) && n) return TEMPO_ERR_ARGUMENT;
+    if (anyNull(positions, n)) return TEMPO_ERR_ARGUMENT;
+    forEachItem(pool, n, [&](size_t i) { counts[i] = uint32_t(positions[i]->board.countLegalMoves()); });
+    return TEMPO_OK;
+}
+
+int tempo_batch_legal_moves(tempo_pool* pool, tempo_position* const* positions, size_t n,
+                            tempo_move* moves, size_t stride, uint32_t* counts) {
+    if ((!positions || !counts || (!moves && stride)) && n) return TEMPO_ERR_ARGUMENT;
+    if (anyNull(positions, n)) return TEMPO_ERR_ARGUMENT;
+    std::atomic<bool> overflow{false};
+    forEachItem(pool, n, [&](size_t i) {
+        tempo_position& p = *positions[i];
+        p.board.genLegalMoves(p.moves);
+        counts[i] = uint32_t(p.moves.size());
+        if (p.moves.size() > stride) overflow.store(true, std::memory_order_relaxed);
+        const size_t written = std::min(p.moves.size(), stride);
+        std::transform(p.moves.begin(), p.moves.begin() + written, moves + i * stride, toExternal);
+    });
+    return overflow.load() ? TEMPO_ERR_CAPACITY : TEMPO_OK;
+}
+
+int tempo_batch_perft(tempo_pool* pool, tempo_position* const* positions, size_t n, int depth, uint64_t* nodes) {
+    if (((!positions || !nodes) && n) || depth < 0 || depth > TEMPO_MAX_PERFT_DEPTH) return TEMPO_ERR_ARGUMENT;
+    if (anyNull(positions, n)) return TEMPO_ERR_ARGUMENT;
+    forEachItem(pool, n, [&](size_t i) { nodes[i] = depth == 0 ? 1 : perft(*positions[i], depth, 0); });
+    return TEMPO_OK;
+}
+
+int tempo_batch_count_records(tempo_pool* pool, const void* records, size_t n, uint32_t* counts) {
+    if ((!records || !counts) && n) return TEMPO_ERR_ARGUMENT;
+    const auto* bytes = static_cast<const unsigned char*>(records);
+    std::atomic<bool> malformed{false};
+    forEachItem(pool, n, [&](size_t i) {
+        static thread_local tempo_position scratch; // one board per thread, set up once
+        TrainingRecord r;
+        std::memcpy(&r, bytes + i * sizeof r, sizeof r);
+        if (!isValidRecord(r)) {
+            counts[i] = 0;
+            malformed.store(true, std::memory_order_relaxed);
+            return;
+        }
+        unpackRecord(r, scratch.board);
+        counts[i] = uint32_t(scratch.board.countLegalMoves());
+    });
+    return malformed.load() ? TEMPO_ERR_RECORD : TEMPO_OK;
+}
+
+}
@@ -0,0 +1,122 @@
+/*
+ * Created by Kaveh Fayyazi on 10/19/26.
+ *
+ * C interface of libtempo, for embedding the move generator from other languages. Everything
+ * here is plain C and keeps its meaning across releases; the layout of the engine's own types
+ * never crosses it.
+ *
+ * Squares are numbered a1 = 0, b1 = 1, ... h8 = 63. A move is 16 bits: from | to << 6 | promo << 12,
+ * promo being one of TEMPO_PROMO_*. Functions returning int report TEMPO_OK or a negative
+ * TEMPO_ERR_* code unless stated otherwise.
+ *
+ * A position handle is used by one thread at a time. The batch calls read their positions and
+ * write into caller-owned buffers without allocating; with a pool their positions are shared out
+ * over its workers, so the same handle must not appear twice in one batch.
+ */
+
+#ifndef TEMPO_CAPI_H
+#define TEMPO_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define TEMPO_API __declspec(dllexport)
+#else
+#define TEMPO_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TEMPO_API_VERSION 1
+
+#define TEMPO_OK 0
+#define TEMPO_ERR_ARGUMENT (-1) /* null handle or buffer, depth out of range */
+#define TEMPO_ERR_FEN (-2)      /* malformed FEN, the position is unchanged */
+#define TEMPO_ERR_RECORD (-3)   /* packed record does not hold a position */
+#define TEMPO_ERR_MOVE (-4)     /* a move is not legal in the position it is applied to */
+#define TEMPO_ERR_CAPACITY (-5) /* an output buffer is too small */
+
+#define TEMPO_PROMO_NONE 0
+#define TEMPO_PROMO_KNIGHT 1
+#define TEMPO_PROMO_BISHOP 2
+#define TEMPO_PROMO_ROOK 3
+#define TEMPO_PROMO_QUEEN 4
+
+/* More than any legal position has, enough for one position's slice of a moves buffer */
+#define TEMPO_MAX_MOVES 256
+/* Deepest perft the batch call accepts */
+#define TEMPO_MAX_PERFT_DEPTH 16
+/* Size of a packed position, the training record written by DataGen */
+#define TEMPO_RECORD_SIZE 32
+
+typedef uint16_t tempo_move;
+typedef struct tempo_position tempo_position;
+typedef struct tempo_pool tempo_pool;
+
+/* TEMPO_API_VERSION of the library actually loaded */
+TEMPO_API int tempo_api_version(void);
+
+/* ---------- Positions ---------- */
+
+/* A new handle on the starting position, NULL if out of memory */
+TEMPO_API tempo_position* tempo_position_new(void);
+TEMPO_API void tempo_position_free(tempo_position* position);
+
+TEMPO_API int tempo_position_set_fen(tempo_position* position, const char* fen);
+/* record points at TEMPO_RECORD_SIZE bytes; the position gets an empty history. TEMPO_ERR_RECORD
+ * unless it holds a position tempo_position_set_fen would accept. */
+TEMPO_API int tempo_position_set_record(tempo_position* position, const void* record);
+
+/* Plays n moves in order. On an illegal move stops there and returns TEMPO_ERR_MOVE, the moves
+ * before it stay played; *applied (if not NULL) receives how many were. */
+TEMPO_API int tempo_position_apply_moves(tempo_position* position, const tempo_move* moves, size_t n, size_t* applied);
+/* Same for a space separated list of moves in UCI notation, e.g. "e2e4 e7e5 g1f3" */
+TEMPO_API int tempo_position_apply_uci(tempo_position* position, const char* moves, size_t* applied);
+
+/* 1 if the side to move is white, 0 otherwise */
+TEMPO_API int tempo_position_white_to_move(const tempo_position* position);
+/* Polyglot hash of the position, the same in every process */
+TEMPO_API uint64_t tempo_position_key(const tempo_position* position);
+
+/* Writes the legal moves into out and returns their number, or TEMPO_ERR_CAPACITY if there are
+ * more than capacity */
+TEMPO_API int tempo_position_legal_moves(tempo_position* position, tempo_move* out, size_t capacity);
+
+/* ---------- Thread pools ---------- */
+
+/* A pool of threads - 1 workers, the caller of a batch being the last one; 0 picks one per core.
+ * NULL if the threads could not be started. A pool runs one batch at a time. */
+TEMPO_API tempo_pool* tempo_pool_new(unsigned threads);
+TEMPO_API void tempo_pool_free(tempo_pool* pool);
+TEMPO_API unsigned tempo_pool_threads(const tempo_pool* pool);
+
+/* ---------- Batches ----------
+ * Each takes n position handles; pool may be NULL to do the work on the calling thread. */
+
+/* Number of legal moves of each position into counts[i] */
+TEMPO_API int tempo_batch_count_moves(tempo_pool* pool, tempo_position* const* positions, size_t n, uint32_t* counts);
+
+/* Legal moves of position i into moves[i * stride ...], their number into counts[i]. stride is the
+ * number of moves reserved per position; TEMPO_MAX_MOVES always suffices. A position with more moves
+ * than stride has counts[i] set to its full count, only the first stride written, and the batch
+ * returns TEMPO_ERR_CAPACITY once every position is done. */
+TEMPO_API int tempo_batch_legal_moves(tempo_pool* pool, tempo_position* const* positions, size_t n,
+                                      tempo_move* moves, size_t stride, uint32_t* counts);
+
+/* Leaf nodes depth plies below each position into nodes[i]. The positions are searched in place
+ * and left as they were. */
+TEMPO_API int tempo_batch_perft(tempo_pool* pool, tempo_position* const* positions, size_t n, int depth, uint64_t* nodes);
+
+/* Number of legal moves of each of n packed records, read in place from records (n *
+ * TEMPO_RECORD_SIZE bytes, e.g. a mapped DataGen shard); TEMPO_ERR_RECORD if one is malformed,
+ * its count left at 0. */
+TEMPO_API int tempo_batch_count_records(tempo_pool* pool, const void* records, size_t n, uint32_t* counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEMPO_CAPI_H */
@@ -0,0 +1,196 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "pgn.h"
+#include "notation.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr size_t CHUNK = 1 << 20;
+
+static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+static bool isResult(std::string_view token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// pos must be the start of a line beginning with '['
+static bool followsTagLine(std::string_view text, size_t pos) {
+    size_t end = pos;
+    while (end > 0 && isSpace(text[end - 1])) --end; // back over blank lines
+    if (end == 0) return false;
+    const size_t lineStart = text.rfind('\n', end - 1);
+    return text[lineStart == std::string_view::npos ? 0 : lineStart + 1] == '[';
+}
+
+size_t nextGameStart(std::string_view text, size_t pos) {
+    if (pos == 0) return 0;
+    for (size_t p = text.find("\n[", pos - 1); p != std::string_view::npos; p = text.find("\n[", p + 1))
+        if (!followsTagLine(text, p + 1)) return p + 1;
+    return text.size();
+}
+
+// Value of a tag line such as [FEN "..."], pos at the '['; advances pos past the line
+static void readTag(std::string_view text, size_t& pos, std::string_view& name, std::string_view& value) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string_view::npos) end = text.size();
+    const std::string_view line = text.substr(pos + 1, end - pos - 1);
+    pos = end;
+    const size_t space = line.find(' ');
+    const size_t open = line.find('"'), close = line.rfind('"');
+    name = line.substr(0, space);
+    value = open != std::string_view::npos && close > open ? line.substr(open + 1, close - open - 1) : std::string_view{};
+}
+
+// Skips a parenthesized variation, nested ones and the comments inside; pos at the '('
+static void skipVariation(std::string_view text, size_t& pos) {
+    int depth = 0;
+    for (; pos < text.size(); ++pos) {
+        const char c = text[pos];
+        if (c == '(') ++depth;
+        else if (c == ')' && --depth == 0) { ++pos; return; }
+        else if (c == '{') {
+            pos = text.find('}', pos);
+            if (pos == std::string_view::npos) { pos = text.size(); return; }
+        }
+    }
+}
+
+bool replayGame(std::string_view text, Board& board, PgnGame& game, MoveList& legal) {
+    game.result = "*";
+    game.moves.clear();
+    game.ok = true;
+    game.error = {};
+
+    std::string_view fen, name, value;
+    bool setUp = false;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const char c = text[pos];
+        if (isSpace(c)) { ++pos; continue; }
+        if (c == '[' && (pos == 0 || text[pos - 1] == '\n')) {
+            readTag(text, pos, name, value);
+            if (name == "FEN") fen = value;
+            else if (name == "Result" && isResult(value)) game.result = value;
+            continue;
+        }
+        if (c == '{') {
+            pos = text.find('}', pos);
+            pos = pos == std::string_view::npos ? text.size() : pos + 1;
+            continue;
+        }
+        if (c == ';' || c == '%') {
+            pos = text.find('\n', pos);
+            if (pos == std::string_view::npos) pos = text.size();
+            continue;
+        }
+        if (c == '(') { skipVariation(text, pos); continue; }
+
+        size_t end = pos;
+        while (end < text.size() && !isSpace(text[end]) && text[end] != '{' && text[end] != '(' && text[end] != ';')
+            ++end;
+        std::string_view token = text.substr(pos, end - pos);
+        pos = end;
+        if (!game.ok || token[0] == '$' || token[0] == ')') continue;
+        if (isResult(token)) { game.result = token; continue; }
+
+        // Move numbers, possibly glued to the move: 12. 12... 12.e4
+        size_t digits = 0;
+        while (digits < token.size() && token[digits] >= '0' && token[digits] <= '9') ++digits;
+        if (digits < token.size() && token[digits] == '.') {
+            while (digits < token.size() && token[digits] == '.') ++digits;
+            token.remove_prefix(digits);
+        }
+        if (token.empty()) continue;
+
+        if (!setUp) {
+            setUp = true;
+            if (!board.setFromFEN(fen.empty() ? START_FEN : fen)) {
+                game.ok = false;
+                game.error = fen;
+                continue;
+            }
+        }
+        const uint32_t m = moveFromSAN(board, token, legal);
+        if (m == Move::NONE) {
+            game.ok = false;
+            game.error = token;
+            continue;
+        }
+        board.move(m);
+        game.moves.push_back(m);
+    }
+    if (!setUp && !board.setFromFEN(fen.empty() ? START_FEN : fen)) {
+        game.ok = false;
+        game.error = fen;
+    }
+    game.finalKey = board.getKey();
+    game.fen = fen;
+    return game.ok;
+}
+
+PgnStats replayPgn(std::string_view text, unsigned threads, const PgnSink& sink) {
+    threads = std::max(1u, threads);
+    const size_t chunks = (text.size() + CHUNK - 1) / CHUNK;
+    std::atomic<size_t> next{0};
+    std::vector<PgnStats> partial(threads);
+    std::vector<std::thread> pool;
+
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            Board board = Board();
+            MoveList legal;
+            PgnGame game;
+            PgnStats& stats = partial[t];
+            for (size_t chunk; (chunk = next.fetch_add(1)) < chunks;) {
+                const size_t end = std::min(text.size(), (chunk + 1) * CHUNK);
+                for (size_t start = nextGameStart(text, chunk * CHUNK); start < end;) {
+                    const size_t stop = nextGameStart(text, start + 1);
+                    game.offset = start;
+                    replayGame(text.substr(start, stop - start), board, game, legal);
+                    ++stats.games;
+                    stats.failed += !game.ok;
+                    stats.plies += game.moves.size();
+                    if (sink) sink(game);
+                    start = stop;
+                }
+            }
+        });
+    for (auto& thread : pool) thread.join();
+
+    PgnStats total;
+    total.bytes = text.size();
+    for (const auto& s : partial) {
+        total.games += s.games;
+        total.failed += s.failed;
+        total.plies += s.plies;
+    }
+    return total;
+}
+
+bool replayPgnFile(const std::string& path, unsigned threads, const PgnSink& sink, PgnStats& stats) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+    if (st.st_size == 0) {
+        ::close(fd);
+        stats = {};
+        return true;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (map == MAP_FAILED) return false;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    stats = replayPgn(std::string_view(static_cast<const char*>(map), st.st_size), threads, sink);
+    munmap(map, st.st_size);
+    return true;
+}
@@ -0,0 +1,53 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_PGN_H
+#define TEMPO_PGN_H
+
+#include "board.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// One game as replayed by a worker. The views point into the input text.
+struct PgnGame {
+    size_t offset;           // byte offset of the game in the input, unique and in file order
+    std::string_view result; // "1-0", "0-1", "1/2-1/2" or "*" from the movetext, else the Result tag
+    uint64_t finalKey;       // Zobrist key of the last position, comparable across threads and runs
+    std::string_view fen;    // FEN tag the moves start from, empty for the initial position
+    MoveList moves;
+    bool ok;                 // false when a token did not resolve; moves holds those before it
+    std::string_view error;  // the offending token, or the FEN tag
+};
+
+struct PgnStats {
+    size_t games = 0;
+    size_t failed = 0;
+    uint64_t plies = 0;
+    size_t bytes = 0;
+};
+
+// Called for every game on the worker that replayed it, so concurrently from several threads. The
+// game object is reused by the worker once the call returns.
+using PgnSink = std::function<void(const PgnGame&)>;
+
+// First game starting at or after pos, text.size() if none. A game starts at a tag line ('[' opening
+// the line) that does not follow another tag line; the start of the text always starts one.
+size_t nextGameStart(std::string_view text, size_t pos);
+
+// Tokenizes the tags and movetext of one game and replays the moves through Board::move(), from the
+// start position or the FEN tag. Comments, variations, NAGs and move numbers are skipped. legal is
+// scratch space for SAN resolution. Returns game.ok.
+bool replayGame(std::string_view text, Board& board, PgnGame& game, MoveList& legal);
+
+// Replays every game in text on threads workers. The text is cut into fixed-size chunks that the
+// workers claim in turn; a worker takes the games that start inside its chunk, so no serial split
+// pass is needed and each worker reuses its own board, move lists and game.
+PgnStats replayPgn(std::string_view text, unsigned threads, const PgnSink& sink);
+
+// Memory-maps path and replays it; false if the file cannot be mapped
+bool replayPgnFile(const std::string& path, unsigned threads, const PgnSink& sink, PgnStats& stats);
+
+#endif //TEMPO_PGN_H
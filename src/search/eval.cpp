@@ -0,0 +1,88 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "eval.h"
+#include "utils.h"
+
+// Tables as printed, a8..h8 on the first row down to a1..h1 on the last (white's point of view)
+using PrintedTable = std::array<int16_t, NUM_SQUARES>;
+
+static constexpr std::array<PrintedTable, PIECE_TYPE_N> PRINTED_PST = {{
+    { // pawn
+          0,   0,   0,   0,   0,   0,   0,   0,
+         50,  50,  50,  50,  50,  50,  50,  50,
+         10,  10,  20,  30,  30,  20,  10,  10,
+          5,   5,  10,  25,  25,  10,   5,   5,
+          0,   0,   0,  20,  20,   0,   0,   0,
+          5,  -5, -10,   0,   0, -10,  -5,   5,
+          5,  10,  10, -20, -20,  10,  10,   5,
+          0,   0,   0,   0,   0,   0,   0,   0 },
+    { // rook
+          0,   0,   0,   0,   0,   0,   0,   0,
+          5,  10,  10,  10,  10,  10,  10,   5,
+         -5,   0,   0,   0,   0,   0,   0,  -5,
+         -5,   0,   0,   0,   0,   0,   0,  -5,
+         -5,   0,   0,   0,   0,   0,   0,  -5,
+         -5,   0,   0,   0,   0,   0,   0,  -5,
+         -5,   0,   0,   0,   0,   0,   0,  -5,
+          0,   0,   0,   5,   5,   0,   0,   0 },
+    { // knight
+        -50, -40, -30, -30, -30, -30, -40, -50,
+        -40, -20,   0,   0,   0,   0, -20, -40,
+        -30,   0,  10,  15,  15,  10,   0, -30,
+        -30,   5,  15,  20,  20,  15,   5, -30,
+        -30,   0,  15,  20,  20,  15,   0, -30,
+        -30,   5,  10,  15,  15,  10,   5, -30,
+        -40, -20,   0,   5,   5,   0, -20, -40,
+        -50, -40, -30, -30, -30, -30, -40, -50 },
+    { // bishop
+        -20, -10, -10, -10, -10, -10, -10, -20,
+        -10,   0,   0,   0,   0,   0,   0, -10,
+        -10,   0,   5,  10,  10,   5,   0, -10,
+        -10,   5,   5,  10,  10,   5,   5, -10,
+        -10,   0,  10,  10,  10,  10,   0, -10,
+        -10,  10,  10,  10,  10,  10,  10, -10,
+        -10,   5,   0,   0,   0,   0,   5, -10,
+        -20, -10, -10, -10, -10, -10, -10, -20 },
+    { // queen
+        -20, -10, -10,  -5,  -5, -10, -10, -20,
+        -10,   0,   0,   0,   0,   0,   0, -10,
+        -10,   0,   5,   5,   5,   5,   0, -10,
+         -5,   0,   5,   5,   5,   5,   0,  -5,
+          0,   0,   5,   5,   5,   5,   0,  -5,
+        -10,   5,   5,   5,   5,   5,   0, -10,
+        -10,   0,   5,   0,   0,   0,   0, -10,
+        -20, -10, -10,  -5,  -5, -10, -10, -20 },
+    { // king
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -20, -30, -30, -40, -40, -30, -30, -20,
+        -10, -20, -20, -20, -20, -20, -20, -10,
+         20,  20,   0,   0,   0,   0,  20,  20,
+         20,  30,  10,   0,   0,  10,  30,  20 },
+}};
+
+const EvalWeights& defaultEvalWeights() {
+    static const EvalWeights weights = [] {
+        EvalWeights w{};
+        w.material = { 100, 500, 320, 330, 900, 0 };
+        for (size_t type = 0; type < PIECE_TYPE_N; ++type)
+            for (uint8_t s = 0; s < NUM_SQUARES; ++s) // printed index: rank 8 first, a-file (file 7) first
+                w.pst[type][s] = PRINTED_PST[type][(7 - rankOf(s)) * NUM_SQUARES_IN_ROW + (7 - fileOf(s))];
+        return w;
+    }();
+    return weights;
+}
+
+int evaluate(const Board& board, const EvalWeights& weights) {
+    int score = 0;
+    for (size_t type = 0; type < PIECE_TYPE_N; ++type) {
+        const auto& pst = weights.pst[type];
+        forEachSetBit(board.bb[type], [&](int s) { score += weights.material[type] + pst[s]; });
+        forEachSetBit(board.bb[type + PIECE_TYPE_N], [&](int s) { score -= weights.material[type] + pst[s ^ 56]; });
+    }
+    return board.whiteToMove ? score : -score;
+}
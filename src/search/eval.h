@@ -0,0 +1,26 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_EVAL_H
+#define TEMPO_EVAL_H
+
+#include "board.h"
+#include <array>
+#include <cstdint>
+
+inline constexpr size_t PIECE_TYPE_N = 6; // P, R, N, B, Q, K, the order of the piece codes
+
+// A linear evaluation: material plus one piece-square table per piece type. Tables are written from
+// white's point of view and indexed by board square; black pieces read the rank-mirrored square.
+struct EvalWeights {
+    std::array<int16_t, PIECE_TYPE_N> material;
+    std::array<std::array<int16_t, NUM_SQUARES>, PIECE_TYPE_N> pst;
+};
+
+const EvalWeights& defaultEvalWeights();
+
+// Static evaluation in centipawns from the side to move's point of view
+int evaluate(const Board& board, const EvalWeights& weights = defaultEvalWeights());
+
+#endif //TEMPO_EVAL_H
@@ -0,0 +1,192 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "mate.h"
+#include "move.h"
+#include <algorithm>
+
+static constexpr uint32_t PN_INF = 1u << 30;
+static constexpr size_t CLUSTER = 4; // entries probed per key
+static constexpr size_t MAX_MOVES = 256;
+// Keys of the forced-mate mode differ, its numbers mean something else
+static constexpr uint64_t CHECKS_ONLY_KEY = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t saturate(uint64_t n) { return uint32_t(std::min<uint64_t>(n, PN_INF)); }
+
+MateSolver::MateSolver(size_t hashMB) :
+    table(std::max<size_t>(hashMB, 1) << 20),
+    clusters(table.size() / sizeof(Entry) / CLUSTER)
+{
+    for (auto& list : moveLists) list.reserve(MAX_MOVES);
+    for (auto& list : children) list.reserve(MAX_MOVES);
+}
+
+uint64_t MateSolver::nodeKey(const Board& board) const {
+    return board.key ^ (limits.checksOnly ? CHECKS_ONLY_KEY : 0);
+}
+
+// A proof with fewer moves to spare holds with more, a disproof with more holds with fewer
+MateSolver::Numbers MateSolver::lookup(uint64_t key, int depth) const {
+    const Entry* cluster = table.as<Entry>() + (static_cast<unsigned __int128>(key) * clusters >> 64) * CLUSTER;
+    Numbers found { 1, 1 };
+    for (size_t i = 0; i < CLUSTER; ++i) {
+        const Entry& e = cluster[i];
+        if (e.key != key) continue;
+        if (e.pn == 0 && e.depth <= depth) return { 0, PN_INF };
+        if (e.dn == 0 && e.depth >= depth) return { PN_INF, 0 };
+        if (e.depth == depth) found = { e.pn, e.dn };
+    }
+    return found;
+}
+
+void MateSolver::store(uint64_t key, int depth, Numbers n, uint32_t work) {
+    Entry* cluster = table.as<Entry>() + (static_cast<unsigned __int128>(key) * clusters >> 64) * CLUSTER;
+    Entry* victim = cluster;
+    for (size_t i = 0; i < CLUSTER; ++i) {
+        Entry& e = cluster[i];
+        if (e.key == key && e.depth == depth) { victim = &e; break; }
+        if (e.key == 0) { victim = &e; break; }
+        if (e.work < victim->work) victim = &e;
+    }
+    *victim = { key, n.pn, n.dn, work, uint8_t(depth) };
+}
+
+// Attacker with moves to spare: every legal move, or the checks in forced-mate mode and on the
+// last move, where nothing else mates. Defender: every legal move, though with no attacker move
+// left after it only being mated now counts.
+void MateSolver::genMoves(Board& board, bool attacker, int depth, MoveList& out) const {
+    out.clear();
+    if (attacker && depth == 0) return;
+    if (attacker && (limits.checksOnly || depth == 1)) board.genLegalChecks(out);
+    else board.genLegalMoves(out);
+}
+
+// Multiple-iterative deepening at one node: keeps expanding the most proving child until the
+// node's proof or disproof number reaches its threshold, then leaves the numbers in the table.
+// The attacker's node is an OR node (one mating move proves it), the defender's an AND node.
+void MateSolver::mid(Board& board, int depth, bool attacker, uint32_t thPn, uint32_t thDn, int ply) {
+    const uint64_t key = nodeKey(board);
+    const uint64_t startNodes = nodeCount++;
+    if ((limits.nodes && nodeCount >= limits.nodes) || (limits.stop && limits.stop->load(std::memory_order_relaxed))) {
+        aborted = true;
+        return;
+    }
+
+    MoveList& moves = moveLists[ply];
+    genMoves(board, attacker, depth, moves);
+    if (moves.empty() || ply >= MAX_PLY || (!attacker && depth == 1)) {
+        // No mating try left, or the defender to move: mated if in check, otherwise escaping
+        const bool mated = !attacker && moves.empty() && board.inCheck();
+        store(key, depth, mated ? Numbers{ 0, PN_INF } : Numbers{ PN_INF, 0 }, 1);
+        return;
+    }
+
+    // A move back into a position on the path proves nothing for either side; it counts as an escape
+    std::vector<Child>& kids = children[ply];
+    kids.clear();
+    for (uint32_t m : moves) {
+        board.move(m);
+        kids.push_back({ m, nodeKey(board), board.repetitions() > 0 });
+        board.undoMove(m);
+    }
+    const int childDepth = attacker ? depth : depth - 1;
+    const auto numbers = [&](const Child& c) { return c.repeated ? Numbers{ PN_INF, 0 } : lookup(c.key, childDepth); };
+
+    Numbers n {};
+    while (!aborted) {
+        // OR: pn is the smallest child pn, dn the sum of child dns; AND the other way round.
+        // best is the child to expand, second the runner-up number that bounds its threshold.
+        uint64_t sum = 0;
+        uint32_t minimum = PN_INF, second = PN_INF;
+        size_t best = 0;
+        for (size_t i = 0; i < kids.size(); ++i) {
+            const Numbers c = numbers(kids[i]);
+            const uint32_t selector = attacker ? c.pn : c.dn;
+            sum += attacker ? c.dn : c.pn;
+            if (selector < minimum) { second = minimum; minimum = selector; best = i; }
+            else if (selector < second) second = selector;
+        }
+        n = attacker ? Numbers{ minimum, saturate(sum) } : Numbers{ saturate(sum), minimum };
+        if (n.pn >= thPn || n.dn >= thDn) break;
+
+        const Numbers c = numbers(kids[best]);
+        uint32_t childPn, childDn;
+        if (attacker) {
+            childPn = std::min<uint32_t>(thPn, saturate(uint64_t(second) + 1));
+            childDn = saturate(uint64_t(thDn) - n.dn + c.dn);
+        } else {
+            childDn = std::min<uint32_t>(thDn, saturate(uint64_t(second) + 1));
+            childPn = saturate(uint64_t(thPn) - n.pn + c.pn);
+        }
+        const uint32_t m = kids[best].move;
+        board.move(m);
+        mid(board, childDepth, !attacker, childPn, childDn, ply + 1);
+        board.undoMove(m);
+    }
+    if (!aborted) store(key, depth, n, uint32_t(std::min<uint64_t>(nodeCount - startNodes, UINT32_MAX)));
+}
+
+// Fewest attacker moves in [minDepth, maxDepth] that mate from this node, 0 if none does (or the
+// node budget ran out)
+int MateSolver::mateDistance(Board& board, bool attacker, int minDepth, int maxDepth, int ply) {
+    const uint64_t key = nodeKey(board);
+    for (int depth = minDepth; depth <= maxDepth && !aborted; ++depth) {
+        if (const Numbers n = lookup(key, depth); n.pn != 0 && n.dn != 0) mid(board, depth, attacker, PN_INF, PN_INF, ply);
+        if (!aborted && lookup(key, depth).pn == 0) return depth;
+    }
+    return 0;
+}
+
+MateResult MateSolver::solve(Board& board, const MateLimits& mateLimits) {
+    limits = mateLimits;
+    nodeCount = 0;
+    aborted = false;
+    MateResult result;
+    result.memoryBytes = table.size();
+
+    const int maxMoves = std::clamp(limits.maxMoves, 0, MAX_PLY / 2);
+    result.moves = mateDistance(board, true, 1, maxMoves, 0);
+    if (result.moves) {
+        // Walk the proof: the quickest mate for the attacker, the slowest for the defender. Entries
+        // replaced since are proven again on the way.
+        int depth = result.moves;
+        bool attacker = true;
+        MoveList& moves = moveLists[0];
+        for (int ply = 0; !aborted; ++ply) {
+            genMoves(board, attacker, depth, moves);
+            if (moves.empty()) break;
+            uint32_t chosen = Move::NONE;
+            int chosenDepth = attacker ? depth + 1 : -1;
+            for (int pass = 0; pass < 2 && chosen == Move::NONE; ++pass) {
+                for (size_t i = 0; i < moves.size(); ++i) {
+                    const uint32_t m = moves[i];
+                    board.move(m);
+                    // Attacker moves the table has not proven would mostly cost a full disproof to
+                    // measure; they are only tried if the proof was overwritten
+                    int d = 0;
+                    if (!attacker) d = mateDistance(board, true, 1, depth - 1, ply + 1);
+                    else if (pass == 1 || lookup(nodeKey(board), depth).pn == 0) d = mateDistance(board, false, 1, depth, ply + 1);
+                    board.undoMove(m);
+                    if (d && (attacker ? d < chosenDepth : d > chosenDepth)) { chosen = m; chosenDepth = d; }
+                }
+            }
+            if (chosen == Move::NONE) break;
+            result.line.push_back(chosen);
+            board.move(chosen);
+            depth = chosenDepth;
+            attacker = !attacker;
+        }
+        for (auto it = result.line.rbegin(); it != result.line.rend(); ++it) board.undoMove(*it);
+    }
+
+    result.status = aborted ? MateStatus::Unknown : result.moves ? MateStatus::Mate : MateStatus::NoMate;
+    if (aborted && result.moves) result.status = MateStatus::Mate; // mate proven, only its line is short
+    result.nodes = nodeCount;
+    return result;
+}
+
+MateResult solveMate(Board& board, const MateLimits& limits) {
+    MateSolver solver(limits.hashMB);
+    return solver.solve(board, limits);
+}
@@ -0,0 +1,78 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_MATE_H
+#define TEMPO_MATE_H
+
+#include "board.h"
+#include "largepages.h"
+#include "search.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+struct MateLimits {
+    int maxMoves = 5;      // mate within this many moves of the side to move, at most MAX_PLY / 2
+    uint64_t nodes = 0;    // 0 for no node limit
+    size_t hashMB = 16;    // for solveMate: proof and disproof numbers, all the memory a solve uses
+    bool checksOnly = false; // forced-mate mode: the attacker only plays checks
+    const std::atomic<bool>* stop = nullptr; // set from another thread, ends the solve as a node limit would
+};
+
+enum class MateStatus {
+    Mate,   // line mates against any defence
+    NoMate, // proven: no mate within maxMoves (by checks alone in forced-mate mode)
+    Unknown // node limit or stop reached first
+};
+
+struct MateResult {
+    MateStatus status = MateStatus::Unknown;
+    int moves = 0;       // mate in this many moves, shortest there is
+    MoveList line;       // attacker's moves and the longest defence, ending in mate
+    uint64_t nodes = 0;
+    size_t memoryBytes = 0;
+};
+
+// Depth-first proof-number search (df-pn) for a mate by the side to move. Nodes are expanded in
+// the order proof and disproof numbers point to, within thresholds, and everything learned lives
+// in a fixed-size table so memory stays bounded. The mate bound is raised one move at a time, so
+// the first proof is the shortest mate.
+class MateSolver {
+public:
+    // The table outlives solves, so a batch of puzzles shares what it learned
+    explicit MateSolver(size_t hashMB = 16);
+
+    MateResult solve(Board& board, const MateLimits& limits);
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t pn, dn;
+        uint32_t work; // nodes spent below, replacement keeps the costlier
+        uint8_t depth; // attacker moves left
+    };
+    struct Numbers { uint32_t pn, dn; };
+    struct Child { uint32_t move; uint64_t key; bool repeated; };
+
+    uint64_t nodeKey(const Board& board) const;
+    Numbers lookup(uint64_t key, int depth) const;
+    void store(uint64_t key, int depth, Numbers n, uint32_t work);
+    void genMoves(Board& board, bool attacker, int depth, MoveList& out) const;
+    void mid(Board& board, int depth, bool attacker, uint32_t thPn, uint32_t thDn, int ply);
+    int mateDistance(Board& board, bool attacker, int minDepth, int maxDepth, int ply);
+
+    LargeAllocation table;
+    size_t clusters;
+    MateLimits limits;
+    uint64_t nodeCount = 0;
+    bool aborted = false;
+    std::array<MoveList, MAX_PLY + 1> moveLists;
+    std::array<std::vector<Child>, MAX_PLY + 1> children;
+};
+
+// One-off solve with a table of limits.hashMB
+MateResult solveMate(Board& board, const MateLimits& limits);
+
+#endif //TEMPO_MATE_H
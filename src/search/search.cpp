@@ -0,0 +1,175 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "search.h"
+#include "eval.h"
+#include "move.h"
+#include <algorithm>
+#include <chrono>
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Most valuable victim, least valuable attacker; indexed by piece code modulo the side
+static constexpr std::array<int, 6> ORDER_VALUE = { 1, 5, 3, 3, 9, 10 };
+
+static int moveOrderScore(uint32_t move) {
+    int score = 0;
+    if (Move::isCapture(move))
+        score += 1000 + ORDER_VALUE[Move::capturedCode(move) % 6] * 16 - ORDER_VALUE[Move::movedCode(move) % 6];
+    if (Move::promo(move) != Move::PROMO_MASK)
+        score += 2000 + Move::promo(move); // queen promotions first
+    return score;
+}
+
+void Search::start(const SearchLimits& searchLimits) {
+    limits = searchLimits;
+    nodeCount = 0;
+    pondering.store(limits.ponder, std::memory_order_relaxed);
+    stopFlag.store(false, std::memory_order_relaxed);
+    goNs = nowNs();
+    startNs.store(goNs, std::memory_order_relaxed);
+}
+
+void Search::ponderhit() {
+    startNs.store(nowNs(), std::memory_order_relaxed);
+    pondering.store(false, std::memory_order_relaxed);
+}
+
+int64_t Search::elapsedMs(int64_t sinceNs) const {
+    return (nowNs() - sinceNs) / 1'000'000;
+}
+
+// Checked at every node so stop and node limits take effect within one node; the clock is read
+// every 64 nodes, well under a millisecond even at low node rates.
+void Search::poll() {
+    if (limits.nodes && nodeCount >= limits.nodes) stop();
+    if ((nodeCount & 63) == 0 && budgetMs >= 0 && !pondering.load(std::memory_order_relaxed) &&
+        elapsedMs(startNs.load(std::memory_order_relaxed)) >= budgetMs)
+        stop();
+}
+
+void Search::orderMoves(MoveList& moves, int ply) const {
+    const uint32_t pvMove = ply < int(prevPV.size()) ? prevPV[ply] : Move::NONE;
+    std::stable_sort(moves.begin(), moves.end(), [&](uint32_t a, uint32_t b) {
+        const int sa = a == pvMove ? 1'000'000 : moveOrderScore(a);
+        const int sb = b == pvMove ? 1'000'000 : moveOrderScore(b);
+        return sa > sb;
+    });
+}
+
+void Search::updatePV(int ply, uint32_t move) {
+    pv[ply][ply] = move;
+    for (int i = ply + 1; i < pvLength[ply + 1]; ++i) pv[ply][i] = pv[ply + 1][i];
+    pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+}
+
+int Search::quiescence(Board& board, int ply, int alpha, int beta) {
+    pvLength[ply] = ply;
+    if (stopFlag.load(std::memory_order_relaxed)) return 0;
+    ++nodeCount;
+    poll();
+
+    const int standPat = evaluate(board);
+    if (ply >= MAX_PLY || standPat >= beta) return standPat;
+    alpha = std::max(alpha, standPat);
+
+    MoveList& moves = moveLists[ply];
+    board.genLegalMoves(moves);
+    std::erase_if(moves, [](uint32_t m) { return !Move::isCapture(m) && Move::promo(m) == Move::PROMO_MASK; });
+    orderMoves(moves, MAX_PLY);
+
+    int best = standPat;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const uint32_t m = moves[i];
+        board.move(m);
+        const int score = -quiescence(board, ply + 1, -beta, -alpha);
+        board.undoMove(m);
+        if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+        if (score > best) {
+            best = score;
+            if (score > alpha) { alpha = score; updatePV(ply, m); }
+            if (alpha >= beta) break;
+        }
+    }
+    return best;
+}
+
+int Search::negamax(Board& board, int depth, int ply, int alpha, int beta) {
+    pvLength[ply] = ply;
+    if (stopFlag.load(std::memory_order_relaxed)) return 0;
+    if (ply > 0 && (board.repetitions() > 0 || board.isFiftyMoveDraw())) return 0;
+
+    const bool inCheck = board.inCheck();
+    if (inCheck) ++depth; // check extension, so short mates are not cut off by the horizon
+    if (depth <= 0) return quiescence(board, ply, alpha, beta);
+
+    ++nodeCount;
+    poll();
+    if (ply >= MAX_PLY) return evaluate(board);
+
+    MoveList& moves = moveLists[ply];
+    board.genLegalMoves(moves);
+    if (moves.empty()) return inCheck ? -SCORE_MATE + ply : 0;
+    orderMoves(moves, ply);
+
+    int best = -SCORE_INF;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const uint32_t m = moves[i];
+        board.move(m);
+        const int score = -negamax(board, depth - 1, ply + 1, -beta, -alpha);
+        board.undoMove(m);
+        if (stopFlag.load(std::memory_order_relaxed)) return 0;
+
+        if (score > best) {
+            best = score;
+            if (score > alpha) { alpha = score; updatePV(ply, m); }
+            if (alpha >= beta) break;
+        }
+    }
+    return best;
+}
+
+uint32_t Search::run(Board& board, const Reporter& report, uint32_t* ponderMove) {
+    if (ponderMove) *ponderMove = Move::NONE;
+
+    // Time budget: movetime as given, otherwise a slice of the remaining clock plus most of the increment
+    const int us = board.whiteToMove ? 0 : 1;
+    budgetMs = -1;
+    int64_t softMs = -1; // no new iteration is started past this point
+    if (limits.moveTime >= 0) {
+        budgetMs = softMs = limits.moveTime;
+    } else if (limits.time[us] >= 0) {
+        const int64_t movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, 50) : 30;
+        const int64_t margin = std::min<int64_t>(30, limits.time[us] / 10);
+        budgetMs = std::min(limits.time[us] / movesToGo + limits.inc[us] * 3 / 4, limits.time[us] - margin);
+        budgetMs = std::max<int64_t>(budgetMs, 1);
+        softMs = budgetMs / 2;
+    }
+    if (limits.infinite) budgetMs = softMs = -1;
+
+    MoveList rootMoves;
+    board.genLegalMoves(rootMoves);
+    if (rootMoves.empty()) return Move::NONE;
+
+    uint32_t best = rootMoves.front();
+    prevPV.clear();
+    for (int depth = 1; depth <= std::min(limits.depth, MAX_PLY); ++depth) {
+        const int score = negamax(board, depth, 0, -SCORE_INF, SCORE_INF);
+        if (stopFlag.load(std::memory_order_relaxed)) break; // the unfinished iteration is discarded
+
+        prevPV.assign(pv[0].begin(), pv[0].begin() + pvLength[0]);
+        if (!prevPV.empty()) best = prevPV[0];
+        if (ponderMove) *ponderMove = prevPV.size() > 1 ? prevPV[1] : Move::NONE;
+        if (report) report({ depth, score, nodeCount, elapsedMs(goNs), prevPV });
+
+        if (softMs >= 0 && !pondering.load(std::memory_order_relaxed) &&
+            elapsedMs(startNs.load(std::memory_order_relaxed)) >= softMs)
+            break;
+    }
+    return best;
+}
@@ -0,0 +1,89 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_SEARCH_H
+#define TEMPO_SEARCH_H
+
+#include "board.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+inline constexpr int MAX_PLY = 64;
+inline constexpr int SCORE_INF = 32000;
+inline constexpr int SCORE_MATE = 31000; // mate in n plies scores SCORE_MATE - n
+
+inline bool isMateScore(int score) { return score >= SCORE_MATE - MAX_PLY || score <= -SCORE_MATE + MAX_PLY; }
+
+// Limits from a UCI go command; times in milliseconds, negative when not given
+struct SearchLimits {
+    int depth = MAX_PLY;
+    uint64_t nodes = 0; // 0 for no node limit
+    int64_t moveTime = -1;
+    std::array<int64_t, 2> time { -1, -1 }; // white, black
+    std::array<int64_t, 2> inc { 0, 0 };
+    int movesToGo = 0;
+    bool infinite = false;
+    bool ponder = false;
+};
+
+// Sent after every completed iteration
+struct SearchReport {
+    int depth;
+    int score; // from the side to move's point of view
+    uint64_t nodes;
+    int64_t elapsedMs;
+    MoveList pv;
+};
+
+// Iterative deepening alpha-beta with a quiescence search on captures. One search runs at a time;
+// start, run and think are called from the thread that owns the board, stop and ponderhit from any.
+class Search {
+public:
+    using Reporter = std::function<void(const SearchReport&)>;
+
+    // Arms a new search: clears the stop flag and starts the clock. Split from run() so the clock
+    // starts when go is received and a stop that arrives before the worker picks the search up is kept.
+    void start(const SearchLimits& limits);
+
+    // Searches board (restored before returning) until a limit or stop(). Returns the best move, or
+    // Move::NONE without legal moves, and writes the expected reply to ponderMove when there is one.
+    uint32_t run(Board& board, const Reporter& report = {}, uint32_t* ponderMove = nullptr);
+
+    uint32_t think(Board& board, const SearchLimits& limits, const Reporter& report = {}) {
+        start(limits);
+        return run(board, report);
+    }
+
+    void stop() { stopFlag.store(true, std::memory_order_relaxed); }
+
+    // Turns a ponder search into a normal one; its clock starts now
+    void ponderhit();
+
+    uint64_t nodes() const { return nodeCount; }
+
+private:
+    int negamax(Board& board, int depth, int ply, int alpha, int beta);
+    int quiescence(Board& board, int ply, int alpha, int beta);
+    void orderMoves(MoveList& moves, int ply) const;
+    void updatePV(int ply, uint32_t move);
+    void poll();
+    int64_t elapsedMs(int64_t sinceNs) const;
+
+    SearchLimits limits;
+    int64_t budgetMs = -1; // hard time limit, -1 for none
+    std::atomic<bool> stopFlag { false };
+    std::atomic<bool> pondering { false };
+    int64_t goNs = 0; // reporting clock
+    std::atomic<int64_t> startNs { 0 }; // time control clock, restarted by ponderhit
+    uint64_t nodeCount = 0;
+
+    std::array<MoveList, MAX_PLY + 1> moveLists;
+    std::array<std::array<uint32_t, MAX_PLY + 1>, MAX_PLY + 1> pv {};
+    std::array<int, MAX_PLY + 1> pvLength {};
+    MoveList prevPV;
+};
+
+#endif //TEMPO_SEARCH_H
@@ -0,0 +1,414 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "generator.h"
+#include "attacks.h"
+#include "move.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Generation keeps two bytes per position: the value (TB_UNKNOWN until decided) and the best
+// outcome over captures and promotions, which leave the table and are looked up in the smaller
+// ones. Values are then decided in order of plies: a lost position at ply n makes every unmove
+// predecessor won at n + 1, a won position at ply n makes a predecessor lost once all of its moves
+// are verified won for the opponent.
+//
+// A double push that can be taken en passant leads to a position the table does not hold: the
+// pushed-to position plus the en passant captures, whose values are fixed in the smaller tables.
+// Such a move wins for the pusher only if the opponent is lost both ways, which may be later than
+// the table position's loss; that win waits in the capture byte until its ply. A loss through it
+// may be an en passant win for the opponent that is only final once that ply is reached, so the
+// position is checked again then.
+
+static constexpr size_t CHUNK = 1 << 14;
+
+template <typename F>
+static void parallelFor(size_t n, unsigned threads, F f) {
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            for (size_t begin; (begin = next.fetch_add(CHUNK)) < n;)
+                f(t, begin, std::min(n, begin + CHUNK));
+        });
+    for (auto& thread : pool) thread.join();
+}
+
+static int materialValue(const TBMaterial& material, bool white) {
+    static constexpr int VALUES[] = { 1, 5, 3, 3, 9, 0 };
+    int sum = 0;
+    for (uint8_t i = 2; i < material.count; ++i)
+        if (isWhite(material.pieces[i]) == white) sum += VALUES[to_u(material.pieces[i]) % 6];
+    return sum;
+}
+
+std::string canonicalTableName(const TBMaterial& material) {
+    // Each side's pieces in the order QRBNP, so a promotion names the table the usual way
+    std::string name = material.name();
+    const size_t v = name.find('v');
+    const auto order = [](char c) { return std::string_view("KQRBNP").find(c); };
+    std::sort(name.begin() + 1, name.begin() + v, [&](char a, char b) { return order(a) < order(b); });
+    std::sort(name.begin() + v + 2, name.end(), [&](char a, char b) { return order(a) < order(b); });
+    const std::string white = name.substr(0, v), black = name.substr(v + 1);
+    const int w = materialValue(material, true), b = materialValue(material, false);
+    if (b > w || (b == w && black.size() > white.size())) return black + "v" + white;
+    return name;
+}
+
+namespace {
+
+bool leavesTable(uint32_t move) { return Move::isCapture(move) || Move::promo(move) != Move::PROMO_MASK; }
+
+struct Generator {
+    Generator(const TBMaterial& material, Tablebase& tb, unsigned threads) : material(material), tb(tb), threads(threads) {}
+
+    const TBMaterial& material;
+    Tablebase& tb;
+    unsigned threads;
+    std::vector<uint8_t> values;
+    std::vector<uint8_t> captures;
+    std::vector<std::unique_ptr<Board>> boards;
+    std::atomic<bool> missingTable{false};
+    std::mutex recheckMutex;
+    std::vector<std::pair<int, size_t>> rechecks; // (ply, index) of losses waiting on an en passant win
+
+    uint8_t load(size_t i) { return std::atomic_ref<uint8_t>(values[i]).load(std::memory_order_relaxed); }
+    bool claim(size_t i, uint8_t value) {
+        uint8_t expected = TB_UNKNOWN;
+        return std::atomic_ref<uint8_t>(values[i]).compare_exchange_strong(expected, value, std::memory_order_relaxed);
+    }
+
+    // false if two pieces share a square or a pawn stands on the first or last rank
+    bool setup(Board& board, size_t index, uint8_t* squares) const {
+        bool whiteToMove;
+        material.decode(index, squares, whiteToMove);
+        board.bb = {};
+        uint64_t occ = 0;
+        for (uint8_t i = 0; i < material.count; ++i) {
+            if (occ & (1ULL << squares[i])) return false;
+            occ |= 1ULL << squares[i];
+            board.bb[to_u(material.pieces[i])] |= 1ULL << squares[i];
+        }
+        if ((board.bb[to_u(Piece::WP)] | board.bb[to_u(Piece::BP)]) & (RANK_1 | RANK_8)) return false;
+        board.whiteToMove = whiteToMove;
+        board.castling = 0;
+        board.epSquare = NUM_SQUARES;
+        board.calcOcc();
+        return true;
+    }
+
+    void initialize(Board& board, size_t index) {
+        uint8_t squares[TB_MAX_PIECES];
+        // Orientations that encode() never produces are left out along with illegal positions
+        if (!setup(board, index, squares) || material.encode(squares, board.whiteToMove) != index ||
+            isSquareAttacked(board.bb, kingSquare(board.bb, !board.whiteToMove), !board.whiteToMove, board.occAll)) {
+            values[index] = TB_INVALID;
+            return;
+        }
+
+        MoveList moves;
+        board.genLegalMoves(moves);
+        if (moves.empty()) {
+            const bool inCheck = isSquareAttacked(board.bb, kingSquare(board.bb, board.whiteToMove), board.whiteToMove, board.occAll);
+            values[index] = inCheck ? tbValue(0) : TB_DRAW;
+            return;
+        }
+
+        bool quiet = false, drawingCapture = false;
+        int bestWin = INT_MAX, worstLoss = -1, recheck = -1;
+        for (auto m : moves) {
+            if (!leavesTable(m)) {
+                quiet = true;
+                if (!Move::isDPP(m)) continue;
+                uint8_t ep = TB_UNKNOWN;
+                board.move(m);
+                const bool taken = enPassantValue(board, ep);
+                board.undoMove(m);
+                if (taken && tbDecided(ep) && tbPly(ep) % 2) recheck = std::max(recheck, int(tbPly(ep)));
+                continue;
+            }
+            uint8_t child;
+            board.move(m);
+            const bool found = tb.probeValue(board, child);
+            board.undoMove(m);
+            if (!found) { missingTable = true; return; }
+            if (!tbDecided(child)) drawingCapture = true;
+            else if (tbPly(child) % 2 == 0) bestWin = std::min(bestWin, tbPly(child) + 1);
+            else worstLoss = std::max(worstLoss, tbPly(child) + 1);
+        }
+
+        if (bestWin != INT_MAX) captures[index] = tbValue(bestWin);
+        else if (drawingCapture) captures[index] = TB_DRAW;
+        else if (worstLoss >= 0) captures[index] = tbValue(worstLoss);
+
+        if (!quiet && captures[index] != TB_DRAW && !(tbDecided(captures[index]) && tbPly(captures[index]) % 2))
+            values[index] = captures[index]; // every move is a capture into a lost position
+        if (recheck >= 0) {
+            std::lock_guard lock(recheckMutex);
+            rechecks.emplace_back(recheck, index);
+        }
+    }
+
+    // The best the side to move gets from an en passant capture after a double push, false if it has none
+    bool enPassantValue(Board& board, uint8_t& best) {
+        if (board.epSquare == NUM_SQUARES) return false;
+        MoveList moves;
+        board.genLegalMoves(moves);
+        bool taken = false;
+        for (auto m : moves) {
+            if (!Move::isEP(m)) continue;
+            uint8_t child;
+            board.move(m);
+            const bool found = tb.probeValue(board, child);
+            board.undoMove(m);
+            if (!found) { missingTable = true; return false; }
+            best = taken ? tbBest(best, tbParent(child)) : tbParent(child);
+            taken = true;
+        }
+        return taken;
+    }
+
+    // The en passant value after the double push from index, false if the push cannot be taken
+    bool enPassantAfter(Board& board, size_t index, uint8_t from, uint8_t to, uint8_t& value) {
+        uint8_t squares[TB_MAX_PIECES];
+        setup(board, index, squares);
+        MoveList moves;
+        board.genLegalMoves(moves);
+        for (auto m : moves) {
+            if (!Move::isDPP(m) || Move::from(m) != from || Move::to(m) != to) continue;
+            board.move(m);
+            const bool taken = enPassantValue(board, value);
+            board.undoMove(m);
+            return taken;
+        }
+        return false;
+    }
+
+    // A win for index that only counts at a later ply, kept with the capture wins the ply loop claims
+    void deferWin(size_t index, int ply) {
+        std::atomic_ref<uint8_t> slot(captures[index]);
+        uint8_t cur = slot.load(std::memory_order_relaxed);
+        while (!(tbDecided(cur) && tbPly(cur) % 2 && tbPly(cur) <= ply) &&
+               !slot.compare_exchange_weak(cur, tbValue(ply), std::memory_order_relaxed)) {}
+    }
+
+    // Calls f(p, pushFrom, pushTo) with the index p of every position one quiet move before index.
+    // pushFrom is the pawn's square when the move was a double push an enemy pawn stands beside,
+    // NUM_SQUARES otherwise.
+    template <typename F>
+    void forEachPredecessor(size_t index, F f) const {
+        uint8_t squares[TB_MAX_PIECES];
+        bool whiteToMove;
+        material.decode(index, squares, whiteToMove);
+        uint64_t occ = 0, enemyPawns = 0;
+        for (uint8_t i = 0; i < material.count; ++i) {
+            occ |= 1ULL << squares[i];
+            if (material.pieces[i] == (whiteToMove ? Piece::WP : Piece::BP)) enemyPawns |= 1ULL << squares[i];
+        }
+
+        for (uint8_t i = 0; i < material.count; ++i) {
+            const Piece piece = material.pieces[i];
+            if (isWhite(piece) == whiteToMove) continue; // unmove the side that just moved
+            const uint8_t from = squares[i];
+            if (piece == Piece::WP || piece == Piece::BP) {
+                const bool white = piece == Piece::WP;
+                const int back = white ? -8 : 8;
+                const uint8_t single = from + back;
+                if (occ & (1ULL << single) || rankOf(single) == (white ? 0 : 7)) continue;
+                squares[i] = single;
+                f(material.encode(squares, !whiteToMove), NUM_SQUARES, from);
+                const uint8_t twice = single + back;
+                if (rankOf(from) == (white ? 3 : 4) && !(occ & (1ULL << twice))) {
+                    squares[i] = twice;
+                    const uint64_t beside = ((1ULL << from) << 1 & ~FILE_H_MASK) | ((1ULL << from) >> 1 & ~FILE_A_MASK);
+                    f(material.encode(squares, !whiteToMove), enemyPawns & beside ? twice : NUM_SQUARES, from);
+                }
+                squares[i] = from;
+                continue;
+            }
+            forEachSetBit(attacksFrom(piece, from, occ) & ~occ, [&](uint8_t to) {
+                squares[i] = to;
+                f(material.encode(squares, !whiteToMove), NUM_SQUARES, from);
+            });
+            squares[i] = from;
+        }
+    }
+
+    // Ply of the loss if every move from index reaches a position won for the opponent, -1 otherwise.
+    // ply is the one being propagated: every win up to it is decided.
+    int verifyLoss(Board& board, size_t index, int ply) {
+        uint8_t squares[TB_MAX_PIECES];
+        setup(board, index, squares);
+        const uint8_t capture = std::atomic_ref<uint8_t>(captures[index]).load(std::memory_order_relaxed);
+        if (capture == TB_DRAW || (tbDecided(capture) && tbPly(capture) % 2)) return -1;
+        int lossPly = tbDecided(capture) ? tbPly(capture) : 0;
+
+        MoveList moves;
+        board.genLegalMoves(moves);
+        for (auto m : moves) {
+            if (leavesTable(m)) continue;
+            board.move(m);
+            const uint8_t child = load(material.indexOf(board, false));
+            uint8_t ep = TB_UNKNOWN;
+            const bool taken = Move::isDPP(m) && enPassantValue(board, ep);
+            board.undoMove(m);
+            int win = tbDecided(child) && tbPly(child) % 2 ? tbPly(child) : -1;
+            if (taken && tbDecided(ep) && tbPly(ep) % 2) {
+                // An undecided table position may still turn out a quicker win until the en passant ply
+                if (!tbDecided(child) && tbPly(ep) > ply) return -1;
+                win = win < 0 ? tbPly(ep) : std::min(win, int(tbPly(ep)));
+            }
+            if (win < 0) return -1;
+            lossPly = std::max(lossPly, win + 1);
+        }
+        return lossPly;
+    }
+
+    // The predecessor p of a position lost at ply: won at ply + 1 unless the move there was a
+    // double push the opponent can take en passant
+    void claimWin(Board& board, size_t p, uint8_t pushFrom, uint8_t pushTo, int ply, std::atomic<bool>& overflow,
+                  const std::function<void(int)>& raise) {
+        int winPly = ply + 1;
+        uint8_t ep = TB_UNKNOWN;
+        if (pushFrom != NUM_SQUARES && enPassantAfter(board, p, pushFrom, pushTo, ep)) {
+            if (!tbDecided(ep) || tbPly(ep) % 2) return; // the capture holds the draw or wins
+            winPly = std::max(ply, int(tbPly(ep))) + 1;
+        }
+        if (winPly > TB_MAX_PLY) { overflow = true; return; }
+        if (winPly == ply + 1) {
+            if (claim(p, tbValue(winPly))) raise(winPly);
+            return;
+        }
+        deferWin(p, winPly);
+        raise(winPly);
+    }
+
+    bool run(int& maxPly) {
+        const size_t n = material.entries();
+        values.assign(n, TB_UNKNOWN);
+        captures.assign(n, TB_UNKNOWN);
+        for (unsigned t = 0; t < threads; ++t) boards.push_back(std::make_unique<Board>());
+
+        parallelFor(n, threads, [&](unsigned t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end && !missingTable; ++i) initialize(*boards[t], i);
+        });
+        if (missingTable) return false;
+
+        std::atomic<int> pending{-1}; // highest ply decided or promised so far
+        const std::function<void(int)> raise = [&](int ply) {
+            for (int cur = pending; ply > cur && !pending.compare_exchange_weak(cur, ply);) {}
+        };
+        for (size_t i = 0; i < n; ++i) {
+            if (tbDecided(values[i])) raise(tbPly(values[i]));
+            if (tbDecided(captures[i])) raise(tbPly(captures[i]));
+        }
+        for (auto [ply, index] : rechecks) raise(ply);
+        std::sort(rechecks.begin(), rechecks.end());
+        auto recheck = rechecks.begin();
+
+        std::atomic<bool> overflow{false};
+        const auto claimLoss = [&](Board& board, size_t p, int ply) {
+            const int lossPly = verifyLoss(board, p, ply);
+            if (lossPly < 0) return;
+            if (lossPly > TB_MAX_PLY) { overflow = true; return; }
+            if (claim(p, tbValue(lossPly))) raise(lossPly);
+        };
+        for (int ply = 0; ply <= pending; ++ply) {
+            const uint8_t current = tbValue(ply);
+            parallelFor(n, threads, [&](unsigned, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    if (ply % 2 && values[i] == TB_UNKNOWN && captures[i] == current) claim(i, current);
+                }
+            });
+            for (; recheck != rechecks.end() && recheck->first <= ply; ++recheck)
+                if (values[recheck->second] == TB_UNKNOWN) claimLoss(*boards[0], recheck->second, ply);
+            if (ply + 1 > TB_MAX_PLY) { overflow = pending > ply; break; }
+
+            parallelFor(n, threads, [&](unsigned t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    if (load(i) != current) continue;
+                    forEachPredecessor(i, [&](size_t p, uint8_t pushFrom, uint8_t pushTo) {
+                        if (load(p) != TB_UNKNOWN) return;
+                        if (ply % 2 == 0) claimWin(*boards[t], p, pushFrom, pushTo, ply, overflow, raise);
+                        else claimLoss(*boards[t], p, ply);
+                    });
+                }
+            });
+            if (overflow || missingTable) break;
+        }
+        if (missingTable) return false;
+        if (overflow) return false;
+
+        maxPly = 0;
+        for (auto& v : values) {
+            if (v == TB_UNKNOWN) v = TB_DRAW;
+            if (tbDecided(v)) maxPly = std::max(maxPly, int(tbPly(v)));
+        }
+        return true;
+    }
+};
+
+}
+
+bool generateTable(const std::string& name, Tablebase& tb, const TBGenOptions& options) {
+    TBMaterial material;
+    if (!TBMaterial::parse(name, material)) return false;
+    if (tb.has(name)) return true;
+
+    // Tables reached by captures and by promotions
+    for (uint8_t i = 2; i < material.count; ++i) {
+        TBMaterial sub = material;
+        std::copy(sub.pieces.begin() + i + 1, sub.pieces.begin() + sub.count, sub.pieces.begin() + i);
+        --sub.count;
+        if (!generateTable(canonicalTableName(sub), tb, options)) return false;
+        if (material.pieces[i] != Piece::WP && material.pieces[i] != Piece::BP) continue;
+        for (Piece promoted : { Piece::WQ, Piece::WR, Piece::WB, Piece::WN }) {
+            sub = material;
+            sub.pieces[i] = material.pieces[i] == Piece::WP ? promoted : Piece(to_u(promoted) + 6);
+            if (!generateTable(canonicalTableName(sub), tb, options)) return false;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Generator gen(material, tb, std::max(1u, options.threads));
+    int maxPly = 0;
+    if (!gen.run(maxPly)) {
+        std::cerr << name << ": generation failed" << std::endl;
+        return false;
+    }
+
+    const std::string path = options.dir + "/" + name + TB_EXTENSION;
+    TBHeader header{};
+    std::memcpy(header.magic, TB_MAGIC, sizeof(TB_MAGIC));
+    header.version = TB_VERSION;
+    header.count = material.count;
+    name.copy(header.name, sizeof(header.name) - 1);
+    header.entries = material.entries();
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(gen.values.data()), gen.values.size());
+    out.close();
+    if (!out || !tb.addTable(path)) {
+        std::cerr << name << ": could not write " << path << std::endl;
+        return false;
+    }
+
+    if (options.verbose) {
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << material.entries() << " positions, longest mate " << maxPly
+                  << " plies, " << secs << "s" << std::endl;
+    }
+    return true;
+}
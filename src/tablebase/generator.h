@@ -0,0 +1,25 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_TB_GENERATOR_H
+#define TEMPO_TB_GENERATOR_H
+
+#include "tablebase.h"
+#include <string>
+#include <thread>
+
+struct TBGenOptions {
+    std::string dir = ".";
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool verbose = true;
+};
+
+// Orders the sides so the one with more material is white, e.g. KvKQ -> KQvK
+std::string canonicalTableName(const TBMaterial& material);
+
+// Builds dir/<name>.ttb by retrograde analysis and opens it in tb. Every table reachable by a
+// capture is generated first unless tb already has it.
+bool generateTable(const std::string& name, Tablebase& tb, const TBGenOptions& options);
+
+#endif //TEMPO_TB_GENERATOR_H
@@ -0,0 +1,256 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "tablebase.h"
+#include "move.h"
+#include "utils.h"
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Triangle f <= 3, r <= 3, r <= f (Tempo files count from h) that the white king is folded into
+static constexpr std::array<int8_t, NUM_SQUARES> TRI_INDEX = [] {
+    std::array<int8_t, NUM_SQUARES> tmp{};
+    tmp.fill(-1);
+    int8_t n = 0;
+    for (uint8_t r = 0; r < 4; ++r)
+        for (uint8_t f = r; f < 4; ++f)
+            tmp[sq(f, r)] = n++;
+    return tmp;
+}();
+
+static constexpr std::array<uint8_t, TB_KING_SQUARES> TRI_SQUARE = [] {
+    std::array<uint8_t, TB_KING_SQUARES> tmp{};
+    for (uint8_t s = 0; s < NUM_SQUARES; ++s)
+        if (TRI_INDEX[s] >= 0) tmp[TRI_INDEX[s]] = s;
+    return tmp;
+}();
+
+// Files h-e, where the white king goes when pawns leave only the left-right mirror
+static constexpr uint8_t halfIndex(uint8_t square) { return rankOf(square) * 4 + fileOf(square); }
+static constexpr uint8_t halfSquare(uint8_t index) { return sq(index % 4, index / 4); }
+
+static constexpr uint8_t mirrorRank(uint8_t square) { return sq(fileOf(square), 7 - rankOf(square)); }
+
+static Piece pieceFromLetter(char c, bool white) {
+    switch (c) {
+        case 'K': return white ? Piece::WK : Piece::BK;
+        case 'Q': return white ? Piece::WQ : Piece::BQ;
+        case 'R': return white ? Piece::WR : Piece::BR;
+        case 'B': return white ? Piece::WB : Piece::BB;
+        case 'N': return white ? Piece::WN : Piece::BN;
+        case 'P': return white ? Piece::WP : Piece::BP;
+        default: return Piece::None;
+    }
+}
+
+static char letterFromPiece(Piece piece) {
+    static constexpr char LETTERS[] = { 'P', 'R', 'N', 'B', 'Q', 'K' };
+    return LETTERS[to_u(piece) % 6];
+}
+
+bool TBMaterial::parse(std::string_view name, TBMaterial& out) {
+    const size_t v = name.find('v');
+    if (v == std::string_view::npos) return false;
+    const std::string_view white = name.substr(0, v), black = name.substr(v + 1);
+    if (white.empty() || black.empty() || white[0] != 'K' || black[0] != 'K') return false;
+    if (white.size() + black.size() > TB_MAX_PIECES) return false;
+
+    out = TBMaterial{};
+    out.pieces[out.count++] = Piece::WK;
+    out.pieces[out.count++] = Piece::BK;
+    for (auto [side, isWhiteSide] : { std::pair{ white, true }, std::pair{ black, false } })
+        for (size_t i = 1; i < side.size(); ++i) {
+            Piece p = pieceFromLetter(side[i], isWhiteSide);
+            if (p == Piece::None || isKing(p)) return false;
+            out.pieces[out.count++] = p;
+        }
+    return true;
+}
+
+std::string TBMaterial::name() const {
+    std::string white = "K", black = "K";
+    for (uint8_t i = 2; i < count; ++i)
+        (isWhite(pieces[i]) ? white : black) += letterFromPiece(pieces[i]);
+    return white + "v" + black;
+}
+
+uint64_t TBMaterial::key() const {
+    uint64_t key = 0;
+    for (uint8_t i = 0; i < count; ++i) key += 1ULL << (4 * to_u(pieces[i]));
+    return key;
+}
+
+bool TBMaterial::hasPawns() const {
+    for (uint8_t i = 2; i < count; ++i)
+        if (pieces[i] == Piece::WP || pieces[i] == Piece::BP) return true;
+    return false;
+}
+
+size_t TBMaterial::entries() const {
+    size_t n = 2 * (hasPawns() ? TB_PAWN_KING_SQUARES : TB_KING_SQUARES);
+    for (uint8_t i = 1; i < count; ++i) n *= NUM_SQUARES;
+    return n;
+}
+
+void TBMaterial::decode(size_t index, uint8_t* squares, bool& whiteToMove) const {
+    for (uint8_t i = count - 1; i > 0; --i) {
+        squares[i] = index % NUM_SQUARES;
+        index /= NUM_SQUARES;
+    }
+    const uint8_t kingSquares = hasPawns() ? TB_PAWN_KING_SQUARES : TB_KING_SQUARES;
+    squares[0] = hasPawns() ? halfSquare(index % kingSquares) : TRI_SQUARE[index % kingSquares];
+    whiteToMove = index / kingSquares == 0;
+}
+
+size_t TBMaterial::encode(const uint8_t* squares, bool whiteToMove) const {
+    if (hasPawns()) {
+        // Pawns move up the board, so the white king is only mirrored onto files h-e
+        const uint8_t mirror = fileOf(squares[0]) > 3 ? 7 : 0;
+        auto transform = [&](uint8_t s) { return sq(fileOf(s) ^ mirror, rankOf(s)); };
+        size_t index = (whiteToMove ? 0 : 1) * TB_PAWN_KING_SQUARES + halfIndex(transform(squares[0]));
+        for (uint8_t i = 1; i < count; ++i)
+            index = index * NUM_SQUARES + transform(squares[i]);
+        return index;
+    }
+
+    // Pick the symmetry that brings the white king into the triangle and apply it to every piece
+    const bool flipFile = fileOf(squares[0]) > 3;
+    const bool flipRank = rankOf(squares[0]) > 3;
+    auto transform = [&](uint8_t s, bool diagonal) {
+        uint8_t f = fileOf(s), r = rankOf(s);
+        if (flipFile) f = 7 - f;
+        if (flipRank) r = 7 - r;
+        return diagonal ? sq(r, f) : sq(f, r);
+    };
+    const uint8_t folded = transform(squares[0], false);
+    bool diagonal = rankOf(folded) > fileOf(folded);
+    if (rankOf(folded) == fileOf(folded)) // king on the diagonal, the first piece off it decides
+        for (uint8_t i = 1; i < count; ++i) {
+            const uint8_t s = transform(squares[i], false);
+            if (rankOf(s) == fileOf(s)) continue;
+            diagonal = rankOf(s) > fileOf(s);
+            break;
+        }
+
+    size_t index = (whiteToMove ? 0 : 1) * TB_KING_SQUARES + TRI_INDEX[transform(squares[0], diagonal)];
+    for (uint8_t i = 1; i < count; ++i)
+        index = index * NUM_SQUARES + transform(squares[i], diagonal);
+    return index;
+}
+
+size_t TBMaterial::indexOf(const Board& board, bool flip) const {
+    Bitboards bb = board.bb;
+    if (flip) {
+        Bitboards flipped{};
+        for (uint8_t p = 0; p < to_u(Piece::PIECE_N); ++p)
+            forEachSetBit(bb[p], [&](uint8_t s) { flipped[(p + 6) % to_u(Piece::PIECE_N)] |= 1ULL << mirrorRank(s); });
+        bb = flipped;
+    }
+    uint8_t squares[TB_MAX_PIECES];
+    for (uint8_t i = 0; i < count; ++i) {
+        uint64_t& set = bb[to_u(pieces[i])];
+        squares[i] = bitscanForward(set);
+        set = lsbReset(set);
+    }
+    return encode(squares, board.whiteToMove != flip);
+}
+
+uint64_t materialKey(const Bitboards& bb, bool flip) {
+    uint64_t key = 0;
+    for (uint8_t p = 0; p < to_u(Piece::PIECE_N); ++p) {
+        const uint8_t code = flip ? (p + 6) % to_u(Piece::PIECE_N) : p;
+        key += uint64_t(__builtin_popcountll(bb[p])) << (4 * code);
+    }
+    return key;
+}
+
+// ---------- Tablebase ----------
+
+bool Tablebase::addTable(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(TBHeader)) { ::close(fd); return false; }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    TBHeader header{};
+    std::memcpy(&header, map, sizeof(header));
+    TBMaterial material;
+    header.name[sizeof(header.name) - 1] = '\0';
+    if (std::memcmp(header.magic, TB_MAGIC, sizeof(TB_MAGIC)) != 0 || header.version != TB_VERSION ||
+        !TBMaterial::parse(header.name, material) || header.count != material.count ||
+        header.entries != material.entries() || size_t(st.st_size) != sizeof(TBHeader) + header.entries) {
+        munmap(map, st.st_size);
+        return false;
+    }
+    madvise(map, st.st_size, MADV_RANDOM);
+
+    auto it = tables.find(material.key());
+    if (it != tables.end()) munmap(it->second.map, it->second.bytes);
+    tables[material.key()] = { material, static_cast<const uint8_t*>(map) + sizeof(TBHeader), map, size_t(st.st_size) };
+    largest = std::max(largest, material.count);
+    return true;
+}
+
+size_t Tablebase::openDirectory(const std::string& dir) {
+    size_t opened = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        if (entry.path().extension() == TB_EXTENSION && addTable(entry.path().string())) ++opened;
+    return opened;
+}
+
+bool Tablebase::has(std::string_view name) const {
+    TBMaterial material;
+    if (!TBMaterial::parse(name, material)) return false;
+    const uint64_t key = material.key();
+    const uint64_t flipped = (key >> 24) | ((key & 0xFFFFFF) << 24); // white nibbles 0-5, black 6-11
+    return tables.count(key) || tables.count(flipped);
+}
+
+bool Tablebase::probeValue(const Board& board, uint8_t& value) const {
+    if (__builtin_popcountll(board.occAll) > largest || board.castling) return false;
+    bool flip = false;
+    auto it = tables.find(materialKey(board.bb));
+    if (it == tables.end()) {
+        it = tables.find(materialKey(board.bb, true));
+        if (it == tables.end()) return false;
+        flip = true;
+    }
+    value = it->second.values[it->second.material.indexOf(board, flip)];
+    if (board.epSquare == NUM_SQUARES || value == TB_INVALID) return true;
+
+    // The table's value leaves out en passant, which the side to move may prefer
+    Board copy;
+    copy.setPosition(board);
+    MoveList moves;
+    copy.genLegalMoves(moves);
+    for (auto m : moves) {
+        if (!Move::isEP(m)) continue;
+        uint8_t child;
+        copy.move(m);
+        const bool found = probeValue(copy, child);
+        copy.undoMove(m);
+        if (!found) return false;
+        value = tbBest(value, tbParent(child));
+    }
+    return true;
+}
+
+bool Tablebase::probe(const Board& board, TBResult& out) const {
+    uint8_t value;
+    if (!probeValue(board, value) || value == TB_INVALID) return false;
+    out = tbResult(value);
+    return true;
+}
+
+Tablebase::~Tablebase() {
+    for (auto& [key, table] : tables) munmap(table.map, table.bytes);
+}
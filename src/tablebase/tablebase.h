@@ -0,0 +1,122 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_TABLEBASE_H
+#define TEMPO_TABLEBASE_H
+
+#include "board.h"
+#include "types.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Win/draw/loss plus distance-to-mate tables for small endgames, one file per material signature
+// such as KQvKR or KRPvKR (white listed first). Pawnless positions are indexed with the white king
+// folded into a 10 square triangle by the board's 8 symmetries, so a 5 piece table is
+// 2 * 10 * 64^4 bytes; with pawns only the left-right mirror applies and the king has 32 squares.
+// Tables hold positions without castling or en passant rights: probes of a board with castling
+// rights find nothing, and an en passant capture on the board is looked up in the table it leads to.
+
+inline constexpr uint8_t TB_MAX_PIECES = 5;
+inline constexpr uint8_t TB_KING_SQUARES = 10;
+inline constexpr uint8_t TB_PAWN_KING_SQUARES = 32;
+
+// One byte per position: 2 + plies to mate, even plies mean the side to move gets mated
+inline constexpr uint8_t TB_UNKNOWN = 0; // only during generation
+inline constexpr uint8_t TB_DRAW = 1;
+inline constexpr uint8_t TB_PLY_OFFSET = 2;
+inline constexpr uint8_t TB_INVALID = 0xFF;
+inline constexpr uint8_t TB_MAX_PLY = TB_INVALID - 1 - TB_PLY_OFFSET;
+
+inline bool tbDecided(uint8_t v) { return v >= TB_PLY_OFFSET && v != TB_INVALID; }
+inline uint8_t tbPly(uint8_t v) { return v - TB_PLY_OFFSET; }
+inline uint8_t tbValue(uint8_t ply) { return ply + TB_PLY_OFFSET; }
+
+struct TBResult {
+    int8_t wdl;  // side to move: 1 win, 0 draw, -1 loss
+    uint8_t dtm; // plies to mate, 0 for draws
+};
+
+// What a move into a position of value child is worth to the side making it
+inline uint8_t tbParent(uint8_t child) { return tbDecided(child) ? tbValue(tbPly(child) + 1) : TB_DRAW; }
+// The better of two values for the side to move: the quickest win, then a draw, then the slowest loss
+inline uint8_t tbBest(uint8_t a, uint8_t b) {
+    const auto rank = [](uint8_t v) {
+        if (!tbDecided(v)) return 0;
+        return tbPly(v) % 2 ? TB_MAX_PLY + 1 - tbPly(v) : tbPly(v) - TB_MAX_PLY - 1;
+    };
+    return rank(a) >= rank(b) ? a : b;
+}
+
+inline TBResult tbResult(uint8_t v) {
+    if (!tbDecided(v)) return { 0, 0 };
+    return { int8_t(tbPly(v) % 2 ? 1 : -1), tbPly(v) };
+}
+
+struct TBMaterial {
+    // [0] WK, [1] BK, then white extras, then black extras
+    std::array<Piece, TB_MAX_PIECES> pieces{};
+    uint8_t count = 0;
+
+    // "KQvKR", "KPvKR"
+    static bool parse(std::string_view name, TBMaterial& out);
+    std::string name() const;
+    uint64_t key() const;
+    bool hasPawns() const;
+    size_t entries() const;
+
+    // squares in pieces[] order; false if two pieces share a square
+    void decode(size_t index, uint8_t* squares, bool& whiteToMove) const;
+    size_t encode(const uint8_t* squares, bool whiteToMove) const;
+    // flip mirrors the ranks and swaps colors, for boards whose material is this table reversed
+    size_t indexOf(const Board& board, bool flip) const;
+};
+
+// Piece counts packed 4 bits per piece code; flip swaps the colors
+uint64_t materialKey(const Bitboards& bb, bool flip = false);
+
+struct TBHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    char name[16];
+    uint64_t entries;
+};
+
+inline constexpr char TB_MAGIC[8] = { 'T', 'E', 'M', 'P', 'O', 'T', 'B', '\0' };
+inline constexpr uint32_t TB_VERSION = 1;
+inline constexpr const char* TB_EXTENSION = ".ttb";
+
+// Memory-mapped, read-only tables. probe() is a hash lookup plus one index computation.
+class Tablebase {
+public:
+    bool addTable(const std::string& path);
+    size_t openDirectory(const std::string& dir);
+    bool has(std::string_view name) const;
+    size_t size() const { return tables.size(); }
+    uint8_t maxPieces() const { return largest; }
+
+    // false if no table covers the board's material or the board has castling rights
+    bool probe(const Board& board, TBResult& out) const;
+    bool probeValue(const Board& board, uint8_t& value) const;
+
+    Tablebase() = default;
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+    ~Tablebase();
+
+private:
+    struct Table {
+        TBMaterial material;
+        const uint8_t* values;
+        void* map;
+        size_t bytes;
+    };
+    std::unordered_map<uint64_t, Table> tables;
+    uint8_t largest = 0;
+};
+
+#endif //TEMPO_TABLEBASE_H
@@ -0,0 +1,106 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "threadpool.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static bool pinTo(std::thread& thread, unsigned cpu) {
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof set, &set) == 0;
+#else
+    (void)thread; (void)cpu;
+    return false;
+#endif
+}
+
+ThreadPool::ThreadPool(unsigned threads, CpuTopology topology, bool pin) : cpus(std::move(topology)) {
+    if (cpus.cpuCount() == 0) cpus.nodes = { { 0, { 0 } } };
+    if (threads == 0) threads = unsigned(cpus.cpuCount());
+    for (unsigned w = 0; w < threads; ++w) {
+        // Worker w takes the w-th CPU counting node by node
+        size_t index = w % cpus.cpuCount();
+        unsigned node = 0;
+        while (index >= cpus.nodes[node].cpus.size()) index -= cpus.nodes[node++].cpus.size();
+        placement.push_back({ node, int(cpus.nodes[node].cpus[index]) });
+    }
+    workers.reserve(threads);
+    for (unsigned w = 0; w < threads; ++w) {
+        workers.emplace_back([this, w] { workerLoop(w); });
+        // Pinned before its first job, so everything it touches is placed on its node
+        if (!pin || !pinTo(workers.back(), unsigned(placement[w].cpu))) placement[w].cpu = -1;
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+size_t ThreadPool::nodesUsed() const {
+    std::vector<bool> used(cpus.nodes.size());
+    for (const auto& p : placement) used[p.node] = true;
+    return size_t(std::count(used.begin(), used.end(), true));
+}
+
+void ThreadPool::onEachWorker(const Job& fn) {
+    run([&](unsigned worker, size_t) { fn(worker); }, workers.size(), true);
+}
+
+void ThreadPool::onEachNode(const Job& fn) {
+    std::vector<int> first(cpus.nodes.size(), -1);
+    for (unsigned w = 0; w < size(); ++w)
+        if (first[placement[w].node] < 0) first[placement[w].node] = int(w);
+    onEachWorker([&](unsigned worker) {
+        if (first[placement[worker].node] == int(worker)) fn(worker);
+    });
+}
+
+void ThreadPool::forEach(size_t n, const ItemJob& fn) { run(fn, n, false); }
+
+void ThreadPool::run(const ItemJob& fn, size_t n, bool eachWorker) {
+    if (n == 0 || workers.empty()) return;
+    {
+        std::lock_guard lock(mutex);
+        job = &fn;
+        items = n;
+        perWorker = eachWorker;
+        next.store(0, std::memory_order_relaxed);
+        busy = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+    std::unique_lock lock(mutex);
+    finished.wait(lock, [this] { return busy == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        if (perWorker) (*job)(worker, worker);
+        else
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < items;) (*job)(worker, i);
+        std::lock_guard lock(mutex);
+        if (--busy == 0) finished.notify_one();
+    }
+}
@@ -0,0 +1,90 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_THREADPOOL_H
+#define TEMPO_THREADPOOL_H
+
+#include "topology.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Workers pinned one per CPU, a node's CPUs filled before the next node's, so n workers stay on
+// as few sockets as they fit. Anything a worker allocates and first writes itself (its Board, move
+// stacks, caches) lands in its own node's memory, so per-thread state is built inside
+// onEachWorker rather than by the caller. Workers sleep between jobs; the caller waits for each.
+class ThreadPool {
+public:
+    using Job = std::function<void(unsigned worker)>;
+    using ItemJob = std::function<void(unsigned worker, size_t item)>;
+
+    // threads == 0: one per CPU in topology. More threads than CPUs wrap around the CPUs again.
+    explicit ThreadPool(unsigned threads = 0, CpuTopology topology = CpuTopology::detect(), bool pin = true);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return unsigned(workers.size()); }
+    const CpuTopology& topology() const { return cpus; }
+    // Index into topology().nodes of the node a worker runs on
+    unsigned nodeOf(unsigned worker) const { return placement[worker].node; }
+    // -1 when the worker is not pinned (pinning off or refused)
+    int cpuOf(unsigned worker) const { return placement[worker].cpu; }
+    // Nodes that have at least one worker
+    size_t nodesUsed() const;
+
+    // fn(worker) once on every worker
+    void onEachWorker(const Job& fn);
+    // fn(worker) on the first worker of every node used, e.g. to build that node's copy of a table
+    void onEachNode(const Job& fn);
+    // fn(worker, item) for every item in [0, n), claimed in order by whichever worker is free
+    void forEach(size_t n, const ItemJob& fn);
+
+private:
+    struct Placement { unsigned node; int cpu; };
+
+    void run(const ItemJob& fn, size_t items, bool perWorker);
+    void workerLoop(unsigned worker);
+
+    CpuTopology cpus;
+    std::vector<Placement> placement;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    uint64_t generation = 0;
+    size_t busy = 0;
+    bool stopping = false;
+
+    const ItemJob* job = nullptr;
+    size_t items = 0;
+    bool perWorker = false; // items are worker indices, each worker runs exactly its own
+    std::atomic<size_t> next { 0 };
+};
+
+// One copy of T per NUMA node in use, each built on a worker of its node so its pages are local
+// there. For large read-mostly tables every thread probes; writable shared tables are better
+// interleaved (interleaveMemory) than replicated.
+template <typename T>
+class NodeReplicated {
+public:
+    template <typename Factory>
+    NodeReplicated(ThreadPool& pool, Factory make) : pool(pool), copies(pool.topology().nodes.size()) {
+        pool.onEachNode([&](unsigned worker) { copies[pool.nodeOf(worker)] = std::make_unique<T>(make()); });
+    }
+
+    T& forWorker(unsigned worker) { return *copies[pool.nodeOf(worker)]; }
+    const T& forWorker(unsigned worker) const { return *copies[pool.nodeOf(worker)]; }
+
+private:
+    ThreadPool& pool;
+    std::vector<std::unique_ptr<T>> copies;
+};
+
+#endif //TEMPO_THREADPOOL_H
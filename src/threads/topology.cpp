@@ -0,0 +1,116 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "topology.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::vector<unsigned> parseCpuList(std::string_view list) {
+    std::vector<unsigned> cpus;
+    while (!list.empty() && (list.back() == '\n' || list.back() == ' ')) list.remove_suffix(1);
+    while (!list.empty()) {
+        const std::string_view range = list.substr(0, list.find(','));
+        list.remove_prefix(std::min(list.size(), range.size() + 1));
+        unsigned first = 0, last = 0;
+        const auto [end, ec] = std::from_chars(range.data(), range.data() + range.size(), first);
+        if (ec != std::errc()) return {};
+        last = first;
+        if (end != range.data() + range.size()) {
+            if (*end != '-' || std::from_chars(end + 1, range.data() + range.size(), last).ptr != range.data() + range.size() ||
+                last < first)
+                return {};
+        }
+        for (unsigned cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+static std::vector<unsigned> readCpuList(const std::filesystem::path& file) {
+    std::ifstream in(file);
+    std::string line;
+    return std::getline(in, line) ? parseCpuList(line) : std::vector<unsigned>{};
+}
+
+// CPUs the scheduler lets this process use; empty if unknown
+static std::vector<unsigned> allowedCpus() {
+    std::vector<unsigned> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof set, &set) == 0)
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+#endif
+    return cpus;
+}
+
+CpuTopology CpuTopology::detect(const std::string& sysRoot) {
+    const std::filesystem::path root(sysRoot);
+    // The affinity mask only describes this machine
+    const std::vector<unsigned> allowed = sysRoot == "/sys/devices/system" ? allowedCpus() : std::vector<unsigned>{};
+    const auto permitted = [&](std::vector<unsigned> cpus) {
+        if (!allowed.empty())
+            std::erase_if(cpus, [&](unsigned cpu) { return !std::binary_search(allowed.begin(), allowed.end(), cpu); });
+        return cpus;
+    };
+
+    CpuTopology topology;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root / "node", ec)) {
+        const std::string name = entry.path().filename().string();
+        unsigned id;
+        if (name.rfind("node", 0) != 0 ||
+            std::from_chars(name.data() + 4, name.data() + name.size(), id).ptr != name.data() + name.size())
+            continue;
+        std::vector<unsigned> cpus = permitted(readCpuList(entry.path() / "cpulist"));
+        if (!cpus.empty()) topology.nodes.push_back({ id, std::move(cpus) });
+    }
+    std::sort(topology.nodes.begin(), topology.nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+
+    if (topology.nodes.empty()) {
+        std::vector<unsigned> cpus = permitted(readCpuList(root / "cpu" / "online"));
+        if (cpus.empty()) cpus = allowed;
+        if (cpus.empty()) cpus = { 0 };
+        topology.nodes.push_back({ 0, std::move(cpus) });
+    }
+    return topology;
+}
+
+size_t CpuTopology::cpuCount() const {
+    size_t n = 0;
+    for (const auto& node : nodes) n += node.cpus.size();
+    return n;
+}
+
+bool interleaveMemory(void* data, size_t bytes, const CpuTopology& topology) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (topology.nodes.size() < 2 || !data || bytes == 0) return false;
+    constexpr int MPOL_INTERLEAVE_MODE = 3; // MPOL_INTERLEAVE from <numaif.h>, without needing libnuma
+    constexpr size_t MASK_BITS = 1024;
+    unsigned long mask[MASK_BITS / (8 * sizeof(unsigned long))] = {};
+    for (const auto& node : topology.nodes) {
+        if (node.id >= MASK_BITS) return false;
+        mask[node.id / (8 * sizeof(unsigned long))] |= 1UL << (node.id % (8 * sizeof(unsigned long)));
+    }
+    // mbind wants a page-aligned start; the pages around a partial one are bound along with it
+    const long page = sysconf(_SC_PAGESIZE);
+    const auto start = reinterpret_cast<uintptr_t>(data) & ~uintptr_t(page - 1);
+    const size_t length = reinterpret_cast<uintptr_t>(data) + bytes - start;
+    return syscall(SYS_mbind, start, length, MPOL_INTERLEAVE_MODE, mask, MASK_BITS, 0) == 0;
+#else
+    (void)data; (void)bytes; (void)topology;
+    return false;
+#endif
+}
@@ -0,0 +1,36 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_TOPOLOGY_H
+#define TEMPO_TOPOLOGY_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// "0-3,8,10-11" as written in /sys cpulist files; empty if malformed
+std::vector<unsigned> parseCpuList(std::string_view list);
+
+struct NumaNode {
+    unsigned id;                // the N of /sys/devices/system/node/nodeN
+    std::vector<unsigned> cpus; // ascending, only those this process may run on
+};
+
+// The NUMA nodes (sockets, or sub-socket clusters) and their CPUs, read from sysfs. Nodes without
+// an allowed CPU are left out; without NUMA information everything is one node 0.
+struct CpuTopology {
+    std::vector<NumaNode> nodes;
+
+    // sysRoot stands in for /sys/devices/system, so tests can describe a machine they do not run on
+    static CpuTopology detect(const std::string& sysRoot = "/sys/devices/system");
+
+    size_t cpuCount() const;
+};
+
+// Binds pages not yet touched to be spread round-robin over the nodes' memory, for shared tables
+// every thread probes. False where the kernel refuses (no NUMA support, one node).
+bool interleaveMemory(void* data, size_t bytes, const CpuTopology& topology);
+
+#endif //TEMPO_TOPOLOGY_H
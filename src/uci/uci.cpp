@@ -0,0 +1,243 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "uci.h"
+#include "notation.h"
+#include "mate.h"
+#include "perft.h"
+#include <algorithm>
+
+UCI::UCI(std::istream& in, std::ostream& out) : in(in), out(out), thread([this] { worker(); }) {}
+
+UCI::~UCI() {
+    stopSearch();
+    {
+        std::lock_guard lock(mutex);
+        quitting = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+void UCI::loop() {
+    std::string line;
+    while (std::getline(in, line))
+        if (!execute(line)) return;
+}
+
+bool UCI::execute(std::string_view line) {
+    std::istringstream args{std::string(line)};
+    std::string cmd;
+    args >> cmd;
+
+    if (cmd == "uci") {
+        send("id name Tempo");
+        send("id author Kaveh Fayyazi");
+        send("option name Ponder type check default false");
+        send("uciok");
+    } else if (cmd == "isready") {
+        send("readyok");
+    } else if (cmd == "ucinewgame") {
+        stopSearch();
+        board.setFromFEN(START_FEN);
+    } else if (cmd == "position") {
+        stopSearch();
+        position(args);
+    } else if (cmd == "go") {
+        go(args);
+    } else if (cmd == "stop") {
+        stopSearch();
+    } else if (cmd == "ponderhit") {
+        std::lock_guard lock(mutex);
+        if (searching) {
+            search.ponderhit();
+            holding = infinite;
+            cv.notify_all();
+        }
+    } else if (cmd == "quit") {
+        stopSearch();
+        return false;
+    }
+    // setoption, debug, register and unknown commands are ignored
+    return true;
+}
+
+void UCI::position(std::istringstream& args) {
+    std::string token, fen;
+    args >> token;
+    if (token == "startpos") {
+        fen = START_FEN;
+        args >> token;
+    } else if (token == "fen") {
+        while (args >> token && token != "moves") fen += token + ' ';
+    } else {
+        return;
+    }
+    if (!board.setFromFEN(fen)) {
+        send("info string invalid fen " + fen);
+        return;
+    }
+
+    if (token != "moves") return;
+    while (args >> token) {
+        const uint32_t m = moveFromUCI(board, token);
+        if (m == Move::NONE) {
+            send("info string illegal move " + token);
+            return;
+        }
+        board.move(m);
+    }
+}
+
+void UCI::go(std::istringstream& args) {
+    stopSearch();
+
+    SearchLimits limits;
+    Job next = Job::Search;
+    int depth = 1;
+    std::string token;
+    while (args >> token) {
+        if (token == "depth") args >> limits.depth;
+        else if (token == "nodes") args >> limits.nodes;
+        else if (token == "movetime") args >> limits.moveTime;
+        else if (token == "wtime") args >> limits.time[0];
+        else if (token == "btime") args >> limits.time[1];
+        else if (token == "winc") args >> limits.inc[0];
+        else if (token == "binc") args >> limits.inc[1];
+        else if (token == "movestogo") args >> limits.movesToGo;
+        else if (token == "infinite") limits.infinite = true;
+        else if (token == "ponder") limits.ponder = true;
+        else if (token == "perft" || token == "mate") {
+            next = token == "perft" ? Job::Perft : Job::Mate;
+            args >> depth;
+            break;
+        }
+    }
+
+    if (next == Job::Search) search.start(limits);
+    stopFlag.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(mutex);
+        pending = searching = true;
+        job = next;
+        jobDepth = depth;
+        infinite = next == Job::Search && limits.infinite;
+        holding = next == Job::Search && (limits.infinite || limits.ponder);
+    }
+    cv.notify_all();
+}
+
+// Perft that gives up once stop is set; the subtrees below the check are too small to notice
+static uint64_t stoppablePerft(Board& board, int depth, const std::atomic<bool>& stop) {
+    if (depth <= 3) return Perft(board, uint8_t(std::max(depth, 0)));
+    MoveList moves;
+    board.genLegalMoves(moves);
+    uint64_t nodes = 0;
+    for (auto m : moves) {
+        if (stop.load(std::memory_order_relaxed)) break;
+        board.move(m);
+        nodes += stoppablePerft(board, depth - 1, stop);
+        board.undoMove(m);
+    }
+    return nodes;
+}
+
+// Divide: node count below each root move, then the total. A stopped perft has no total.
+std::string UCI::perft(int depth) {
+    MoveList moves;
+    board.genLegalMoves(moves);
+    uint64_t total = 0;
+    for (auto m : moves) {
+        board.move(m);
+        const uint64_t nodes = depth > 1 ? stoppablePerft(board, depth - 1, stopFlag) : 1;
+        board.undoMove(m);
+        if (stopFlag.load(std::memory_order_relaxed)) return "info string perft stopped";
+        total += nodes;
+        send(moveToUCI(m) + ": " + std::to_string(nodes));
+    }
+    send("");
+    return "Nodes searched: " + std::to_string(depth > 0 ? total : 1);
+}
+
+// Mate search by proof numbers until found, disproved or stopped. Without a mate the bestmove is
+// just the first legal move.
+std::string UCI::mate(int moves) {
+    MateLimits limits;
+    limits.maxMoves = moves;
+    limits.stop = &stopFlag;
+    const MateResult r = solveMate(board, limits);
+    if (r.status == MateStatus::Mate) {
+        std::string line = "info depth " + std::to_string(2 * r.moves - 1) + " score mate " + std::to_string(r.moves) +
+                           " nodes " + std::to_string(r.nodes) + " pv";
+        for (auto m : r.line) line += ' ' + moveToUCI(m);
+        send(line);
+    } else {
+        send(std::string("info string ") + (r.status == MateStatus::NoMate ? "no mate" : "unknown") + " in " +
+             std::to_string(moves) + " nodes " + std::to_string(r.nodes));
+    }
+    MoveList legal;
+    board.genLegalMoves(legal);
+    return "bestmove " + (!r.line.empty() ? moveToUCI(r.line[0]) : legal.empty() ? "0000" : moveToUCI(legal[0]));
+}
+
+void UCI::stopSearch() {
+    std::unique_lock lock(mutex);
+    if (!searching) return;
+    search.stop();
+    stopFlag.store(true, std::memory_order_relaxed);
+    holding = false;
+    cv.notify_all();
+    cv.wait(lock, [&] { return !searching; });
+}
+
+void UCI::wait() {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&] { return !searching; });
+}
+
+void UCI::worker() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        cv.wait(lock, [&] { return pending || quitting; });
+        if (quitting) return;
+        pending = false;
+        const Job current = job;
+        const int depth = jobDepth;
+        lock.unlock();
+
+        std::string line;
+        if (current == Job::Perft) line = perft(depth);
+        else if (current == Job::Mate) line = mate(depth);
+        else {
+            uint32_t ponderMove = Move::NONE;
+            const uint32_t best = search.run(board, [this](const SearchReport& r) { report(r); }, &ponderMove);
+            line = "bestmove " + moveToUCI(best);
+            if (ponderMove != Move::NONE) line += " ponder " + moveToUCI(ponderMove);
+        }
+
+        lock.lock();
+        cv.wait(lock, [&] { return !holding || quitting; });
+        send(line);
+        searching = false;
+        cv.notify_all();
+    }
+}
+
+void UCI::send(const std::string& line) {
+    std::lock_guard lock(outMutex);
+    out << line << '\n' << std::flush;
+}
+
+void UCI::report(const SearchReport& r) {
+    std::string line = "info depth " + std::to_string(r.depth) + " score ";
+    if (isMateScore(r.score))
+        line += "mate " + std::to_string(r.score > 0 ? (SCORE_MATE - r.score + 1) / 2 : -(SCORE_MATE + r.score) / 2);
+    else
+        line += "cp " + std::to_string(r.score);
+    const uint64_t nps = r.elapsedMs > 0 ? r.nodes * 1000 / uint64_t(r.elapsedMs) : r.nodes * 1000;
+    line += " nodes " + std::to_string(r.nodes) + " nps " + std::to_string(nps) + " time " + std::to_string(r.elapsedMs);
+    line += " pv";
+    for (auto m : r.pv) line += ' ' + moveToUCI(m);
+    send(line);
+}
@@ -0,0 +1,69 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_UCI_H
+#define TEMPO_UCI_H
+
+#include "board.h"
+#include "search.h"
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// UCI front end. The thread calling loop() reads and parses commands; searches, perft and mate
+// solves run asynchronously on a worker thread that prints bestmove (or the perft total) when done,
+// so stop and isready are answered mid-search.
+class UCI {
+public:
+    explicit UCI(std::istream& in = std::cin, std::ostream& out = std::cout);
+    ~UCI();
+
+    // Reads commands until quit or end of input
+    void loop();
+
+    // Handles a single command line, returns false on quit
+    bool execute(std::string_view line);
+
+    // Blocks until the running go has sent its last line, for scripted input
+    void wait();
+
+private:
+    void position(std::istringstream& args);
+    void go(std::istringstream& args);
+    // Run on the worker, each returns the line that ends its answer
+    std::string perft(int depth);
+    std::string mate(int moves);
+    void stopSearch(); // stops a running search and waits until its bestmove has been sent
+    void worker();
+    void send(const std::string& line);
+    void report(const SearchReport& r);
+
+    std::istream& in;
+    std::ostream& out;
+    std::mutex outMutex;
+
+    Board board; // only touched by the worker while a search is running
+    Search search;
+    std::atomic<bool> stopFlag { false }; // ends a go perft or go mate, search has its own
+
+    enum class Job { Search, Perft, Mate };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool pending = false;   // a go is waiting for the worker
+    Job job = Job::Search;
+    int jobDepth = 0;       // perft depth or mate moves
+    bool searching = false; // from go until bestmove has been sent
+    bool holding = false;   // go infinite / go ponder: bestmove waits for stop or ponderhit
+    bool infinite = false;
+    bool quitting = false;
+    std::thread thread;
+};
+
+#endif //TEMPO_UCI_H
@@ -4,17 +4,244 @@
 
 #include "catch.hpp"
 #include "board.h"
+#include "hashtable.h"
+#include "largepages.h"
+#include "notation.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <type_traits>
 
 // Change the fields in Board to public.
 
 TEST_CASE("Occupancy Bitboards") {
     Board b = Board();
     REQUIRE(b.occWhite == 0x000000000000FFFFULL);
-    REQUIRE(b.occBlack == 0xFFFF000000000000ULL);
+    REQUIRE(b.occBlack() == 0xFFFF000000000000ULL);
     REQUIRE(b.occAll == 0xFFFF00000000FFFFULL);
 }
 
 TEST_CASE("Castling") {
     Board b = Board();
     REQUIRE(b.castling == 0x0F);
-}
\ No newline at end of file
+}
+TEST_CASE("Move counters") {
+    Board b = Board();
+    const uint32_t e2e4 = moveFromUCI(b, "e2e4");
+    b.move(e2e4);
+    REQUIRE(b.halfMoveClock == 0);
+    REQUIRE(b.fullMoveTotal == 1);
+    const uint32_t g8f6 = moveFromUCI(b, "g8f6");
+    b.move(g8f6);
+    REQUIRE(b.halfMoveClock == 1);
+    REQUIRE(b.fullMoveTotal == 2);
+    b.undoMove(g8f6);
+    b.undoMove(e2e4);
+    REQUIRE(b.halfMoveClock == 0);
+    REQUIRE(b.fullMoveTotal == 1);
+    REQUIRE(b.gameRecord.empty());
+
+    REQUIRE(b.setFromFEN("4k3/8/8/8/8/8/8/4K2R w K - 99 60"));
+    REQUIRE_FALSE(b.isFiftyMoveDraw());
+    b.move(moveFromUCI(b, "h1h2"));
+    REQUIRE(b.isFiftyMoveDraw());
+}
+
+TEST_CASE("Repetition detection") {
+    Board b = Board();
+    REQUIRE(b.repetitions() == 0);
+    for (int i = 0; i < 2; ++i)
+        for (auto uci : { "g1f3", "g8f6", "f3g1", "f6g8" }) b.move(moveFromUCI(b, uci));
+    REQUIRE(b.repetitions() == 2);
+
+    b.move(moveFromUCI(b, "e2e3")); // irreversible, earlier positions cannot recur
+    for (auto uci : { "g8f6", "g1f3", "f6g8" }) {
+        b.move(moveFromUCI(b, uci));
+        REQUIRE(b.repetitions() == 0);
+    }
+    b.move(moveFromUCI(b, "f3g1"));
+    REQUIRE(b.repetitions() == 1);
+}
+
+TEST_CASE("Null move") {
+    Board b = Board();
+    b.move(moveFromUCI(b, "e2e4"));
+    const uint64_t key = b.getKey();
+    const uint8_t ep = b.epSquare;
+    b.makeNullMove();
+    REQUIRE(b.whiteToMove);
+    REQUIRE(b.epSquare == NUM_SQUARES);
+    REQUIRE(b.getKey() == b.computeKey());
+    REQUIRE(b.repetitions() == 0);
+    b.undoNullMove();
+    REQUIRE_FALSE(b.whiteToMove);
+    REQUIRE(b.getKey() == key);
+    REQUIRE(b.epSquare == ep);
+}
+
+TEST_CASE("Large allocations are aligned, zeroed and movable") {
+    for (bool huge : { false, true }) {
+        LargeAllocation table(3 << 20, huge);
+        REQUIRE(table);
+        REQUIRE(table.size() == 2 * HUGE_PAGE_SIZE);
+        REQUIRE(reinterpret_cast<uintptr_t>(table.data()) % HUGE_PAGE_SIZE == 0);
+        if (!huge) REQUIRE(table.mode() == PageMode::Normal);
+        const uint64_t* words = table.as<uint64_t>();
+        REQUIRE(words[0] == 0);
+        REQUIRE(words[table.size() / sizeof(uint64_t) - 1] == 0);
+
+        table.as<uint64_t>()[7] = 42;
+        LargeAllocation moved = std::move(table);
+        REQUIRE_FALSE(table);
+        REQUIRE(moved.as<uint64_t>()[7] == 42);
+    }
+}
+
+TEST_CASE("Positions copy between boards and threads") {
+    STATIC_REQUIRE(std::is_trivially_copyable_v<Position>);
+    STATIC_REQUIRE(alignof(Position) == 64);
+
+    Board b = Board();
+    REQUIRE(b.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+    b.move(moveFromUCI(b, "e1g1"));
+    const Position position = b;
+    MoveList expected;
+    b.genLegalMoves(expected);
+
+    MoveList moves;
+    uint64_t key = 0;
+    std::thread([&] {
+        Board other = Board();
+        other.setPosition(position);
+        other.genLegalMoves(moves);
+        key = other.computeKey();
+    }).join();
+    REQUIRE(moves == expected);
+    REQUIRE(key == b.getKey()); // one set of key tables for every board
+
+    // A copied board generates from its own pieces
+    Board copy = b;
+    copy.move(moves.front());
+    MoveList fromOriginal;
+    b.genLegalMoves(fromOriginal);
+    REQUIRE(fromOriginal == expected);
+    copy.undoMove(moves.front());
+    REQUIRE(copy.getKey() == b.getKey());
+}
+
+TEST_CASE("Zobrist keys are the same on every run") {
+    const Zobrist fresh;
+    REQUIRE(fresh.seed == ZOBRIST_SEED);
+    REQUIRE(fresh.pieces == zobristKeys().pieces);
+    REQUIRE(fresh.fingerprint() == zobristKeys().fingerprint());
+    REQUIRE(Zobrist(ZOBRIST_SEED + 1).fingerprint() != fresh.fingerprint());
+
+    // Keys made on another thread agree too
+    uint64_t key = 0;
+    std::thread([&] { key = Board().getKey(); }).join();
+    REQUIRE(key == Board().getKey());
+}
+
+TEST_CASE("Hash files keep their entries and reject other keys") {
+    const auto path = (std::filesystem::temp_directory_path() / "tempo_hash_test.tth").string();
+    std::filesystem::remove(path);
+    Board b = Board();
+    uint64_t value = 0;
+    {
+        HashTable table;
+        REQUIRE(table.open(path, 1));
+        REQUIRE(table.persistent());
+        REQUIRE(table.entries() == (1 << 20) / HashTable::ENTRY_SIZE);
+        REQUIRE_FALSE(table.probe(b.getKey(), 5, value));
+        table.store(b.getKey(), 5, 4865609);
+        table.store(b.getKey(), 4, 197281);
+        table.flush();
+    }
+    REQUIRE(std::filesystem::file_size(path) == sizeof(HashFileHeader) + (1 << 20));
+
+    // Reopened, also read-only by a second table at the same time; the size asked for is ignored
+    HashTable warm, reader;
+    REQUIRE(warm.open(path, 64));
+    REQUIRE(reader.open(path, 0, true));
+    REQUIRE(warm.probe(b.getKey(), 5, value));
+    REQUIRE(value == 4865609);
+    REQUIRE(warm.probe(b.getKey(), 4, value));
+    REQUIRE(value == 197281);
+    REQUIRE_FALSE(warm.probe(b.getKey(), 3, value));
+    warm.store(b.getKey() ^ 1, 2, 400);
+    REQUIRE(reader.probe(b.getKey() ^ 1, 2, value)); // shared mapping
+    REQUIRE(value == 400);
+    reader.store(b.getKey(), 3, 8902);
+    REQUIRE_FALSE(warm.probe(b.getKey(), 3, value));
+
+    // A file written under other Zobrist keys is refused and the table keeps its mapping
+    HashFileHeader header;
+    {
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(&header), sizeof header);
+    }
+    header.zobristSeed ^= 1;
+    {
+        std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+        out.write(reinterpret_cast<const char*>(&header), sizeof header);
+    }
+    HashTable stale;
+    REQUIRE_FALSE(stale.open(path, 1));
+    REQUIRE_FALSE(stale.persistent());
+    REQUIRE_FALSE(warm.open(path, 1));
+    REQUIRE(warm.persistent());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("FEN round trips and rejects impossible positions") {
+    Board b = Board();
+    REQUIRE(b.toFEN() == START_FEN);
+    for (auto fen : { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                      "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+                      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 12 40",
+                      "4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1" }) {
+        REQUIRE(b.setFromFEN(fen));
+        char out[Board::MAX_FEN_LENGTH];
+        REQUIRE(b.writeFEN(out) == std::strlen(fen));
+        REQUIRE(std::string(out) == fen);
+        REQUIRE(b.getKey() == b.computeKey());
+    }
+
+    // Clocks may be left off, blanks around fields are skipped
+    REQUIRE(b.setFromFEN("  4k3/8/8/8/8/8/8/4K3   b  -  - \n"));
+    REQUIRE(b.toFEN() == "4k3/8/8/8/8/8/8/4K3 b - - 0 1");
+
+    REQUIRE(b.setFromFEN(START_FEN));
+    for (auto fen : { "",
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1",      // side
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN w KQkq - 0 1",       // short rank
+                      "rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",      // long rank
+                      "rnbqkbnr/pppppppp/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",        // seven ranks
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - x 1",      // clock
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 x",    // trailing field
+                      "rnbqqbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",      // no black king
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBKKBNR w KQkq - 0 1",      // two white kings
+                      "rnbqkbnP/pppppppp/8/8/8/8/PPPPPPP1/RNBQKBNR w KQkq - 0 1",      // pawn on rank 8
+                      "rnbqkbnr/pppppppp/8/8/8/P7/PPPPPPPP/RNBQKBNR w KQkq - 0 1",     // nine pawns
+                      "rnbqkbnr/pppppppp/8/8/8/N7/PPPPPPPP/RNBQKBNR w KQkq - 0 1",     // seventeen pieces
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN1 w KQkq - 0 1",      // no rook for K
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KKkq - 0 1",      // repeated right
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1",     // ep for the mover
+                      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e6 0 1",     // no pawn pushed
+                      "4k3/8/8/8/8/8/8/4K2r b - - 0 1" }) {                            // mover gives check
+        INFO(fen);
+        REQUIRE_FALSE(b.setFromFEN(fen));
+        REQUIRE(b.toFEN() == START_FEN); // untouched
+    }
+
+    // EPD: four fields, then the operations
+    std::string_view operations;
+    REQUIRE(b.setFromEPD("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - bm e2a6; id \"kiwipete\"; ",
+                         &operations));
+    REQUIRE(operations == "bm e2a6; id \"kiwipete\";");
+    REQUIRE(b.toFEN() == "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    REQUIRE(b.setFromEPD("4k3/8/8/8/8/8/8/4K3 w - -", &operations));
+    REQUIRE(operations.empty());
+}
@@ -0,0 +1,91 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "notation.h"
+#include "polyglot.h"
+#include <cstdio>
+#include <filesystem>
+
+static std::vector<uint32_t> playUCI(Board& b, std::initializer_list<const char*> ucis) {
+    std::vector<uint32_t> moves;
+    for (auto u : ucis) {
+        uint32_t m = moveFromUCI(b, u);
+        REQUIRE(m != Move::NONE);
+        moves.push_back(m);
+        b.move(m);
+    }
+    for (size_t i = moves.size(); i > 0; --i) b.undoMove(moves[i - 1]);
+    return moves;
+}
+
+TEST_CASE("Polyglot move encoding round trips") {
+    Board b = Board();
+    uint32_t e2e4 = moveFromUCI(b, "e2e4");
+    REQUIRE(moveToPolyglot(e2e4) == ((1 * 8 + 4) << 6 | (3 * 8 + 4))); // a1 = 0 in Polyglot
+    REQUIRE(polyglotToMove(b, moveToPolyglot(e2e4)) == e2e4);
+    REQUIRE(polyglotToMove(b, moveToPolyglot(moveFromUCI(b, "g1f3"))) == moveFromUCI(b, "g1f3"));
+}
+
+TEST_CASE("Polyglot key tracks side to move, castling and ep") {
+    Board b = Board();
+    auto moves = playUCI(b, { "e2e4", "d7d5", "e4e5", "f7f5" });
+    const uint64_t start = polyglotKey(b);
+    for (size_t i = 0; i < 3; ++i) b.move(moves[i]);
+    const uint64_t noEP = polyglotKey(b);
+    b.move(moves[3]); // f7f5 next to the e5 pawn
+    const uint64_t withEP = polyglotKey(b);
+    REQUIRE(start != noEP);
+    REQUIRE(noEP != withEP);
+    for (size_t i = 4; i > 0; --i) b.undoMove(moves[i - 1]);
+    REQUIRE(polyglotKey(b) == start);
+}
+
+TEST_CASE("Polyglot keys match the published test positions") {
+    // The key list of the Polyglot book format description
+    const std::pair<std::vector<const char*>, uint64_t> positions[] = {
+        { {}, 0x463b96181691fc9cULL },
+        { { "e2e4" }, 0x823c9b50fd114196ULL },
+        { { "e2e4", "d7d5" }, 0x0756b94461c50fb0ULL },
+        { { "e2e4", "d7d5", "e4e5" }, 0x662fafb965db29d4ULL },
+        { { "e2e4", "d7d5", "e4e5", "f7f5" }, 0x22a48b5a8e47ff78ULL },
+        { { "e2e4", "d7d5", "e4e5", "f7f5", "e1e2" }, 0x652a607ca3f242c1ULL },
+        { { "e2e4", "d7d5", "e4e5", "f7f5", "e1e2", "e8f7" }, 0x00fdd303c946bdd9ULL },
+        { { "a2a4", "b7b5", "h2h4", "b5b4", "c2c4" }, 0x3c8123ea7b067637ULL },
+        { { "a2a4", "b7b5", "h2h4", "b5b4", "c2c4", "b4c3", "a1a3" }, 0x5c3f9b829b279560ULL },
+    };
+    for (const auto& [ucis, key] : positions) {
+        Board b = Board();
+        for (auto uci : ucis) b.move(moveFromUCI(b, uci));
+        REQUIRE(polyglotKey(b) == key);
+    }
+}
+
+TEST_CASE("Book built from games probes back legal moves") {
+    Board b = Board();
+    PolyglotBookBuilder builder;
+    REQUIRE(builder.addGame(b, playUCI(b, { "e2e4", "e7e5", "g1f3", "b8c6" }), 1));
+    REQUIRE(builder.addGame(b, playUCI(b, { "e2e4", "c7c5" }), 0));
+    REQUIRE(builder.addGame(b, playUCI(b, { "d2d4", "d7d5" }), -1));
+
+    const auto path = (std::filesystem::temp_directory_path() / "tempo_book_test.bin").string();
+    REQUIRE(builder.write(path));
+
+    PolyglotBook book;
+    REQUIRE(book.open(path));
+    PolyglotEntry found[4];
+    REQUIRE(book.entries(polyglotKey(b), found, 4) == 1); // d2d4 lost, so only e2e4 is stored
+    REQUIRE(found[0].weight == 3);
+
+    REQUIRE(book.probeBest(b) == moveFromUCI(b, "e2e4"));
+    for (uint64_t r = 0; r < 8; ++r) REQUIRE(book.probe(b, r) == moveFromUCI(b, "e2e4"));
+
+    b.move(moveFromUCI(b, "e2e4"));
+    uint32_t reply = book.probe(b, 12345);
+    REQUIRE((reply == moveFromUCI(b, "e7e5") || reply == moveFromUCI(b, "c7c5")));
+
+    book.close();
+    std::remove(path.c_str());
+}
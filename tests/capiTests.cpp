@@ -0,0 +1,162 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "notation.h"
+#include "polyglot.h"
+#include "tempo.h"
+#include "training.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct PositionDeleter { void operator()(tempo_position* p) const { tempo_position_free(p); } };
+struct PoolDeleter { void operator()(tempo_pool* p) const { tempo_pool_free(p); } };
+using PositionHandle = std::unique_ptr<tempo_position, PositionDeleter>;
+using PoolHandle = std::unique_ptr<tempo_pool, PoolDeleter>;
+
+const char* FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+constexpr tempo_move move(const char* from, const char* to, unsigned promo = TEMPO_PROMO_NONE) {
+    return tempo_move((from[0] - 'a') + (from[1] - '1') * 8 | ((to[0] - 'a') + (to[1] - '1') * 8) << 6 | promo << 12);
+}
+
+}
+
+TEST_CASE("C interface positions") {
+    REQUIRE(tempo_api_version() == TEMPO_API_VERSION);
+    PositionHandle p(tempo_position_new());
+    REQUIRE(p);
+    REQUIRE(tempo_position_white_to_move(p.get()) == 1);
+
+    tempo_move moves[TEMPO_MAX_MOVES];
+    REQUIRE(tempo_position_legal_moves(p.get(), moves, TEMPO_MAX_MOVES) == 20);
+    REQUIRE(tempo_position_legal_moves(p.get(), moves, 19) == TEMPO_ERR_CAPACITY);
+    REQUIRE(std::find(moves, moves + 20, move("e2", "e4")) != moves + 20);
+    REQUIRE(std::find(moves, moves + 20, move("g1", "f3")) != moves + 20);
+
+    size_t applied = 0;
+    const tempo_move opening[] = { move("e2", "e4"), move("e7", "e5"), move("g1", "f3") };
+    REQUIRE(tempo_position_apply_moves(p.get(), opening, 3, &applied) == TEMPO_OK);
+    REQUIRE(applied == 3);
+    REQUIRE(tempo_position_white_to_move(p.get()) == 0);
+
+    PositionHandle q(tempo_position_new());
+    REQUIRE(tempo_position_apply_uci(q.get(), " e2e4  e7e5 g1f3", &applied) == TEMPO_OK);
+    REQUIRE(applied == 3);
+    REQUIRE(tempo_position_key(q.get()) == tempo_position_key(p.get()));
+
+    // An illegal move stops the sequence where it stands
+    const tempo_move bad[] = { move("b8", "c6"), move("e1", "e3") };
+    REQUIRE(tempo_position_apply_moves(p.get(), bad, 2, &applied) == TEMPO_ERR_MOVE);
+    REQUIRE(applied == 1);
+    REQUIRE(tempo_position_apply_uci(q.get(), "b8c6 e1e3", &applied) == TEMPO_ERR_MOVE);
+    REQUIRE(tempo_position_key(q.get()) == tempo_position_key(p.get()));
+
+    REQUIRE(tempo_position_set_fen(p.get(), "not a fen") == TEMPO_ERR_FEN);
+    REQUIRE(tempo_position_set_fen(nullptr, FENS[0]) == TEMPO_ERR_ARGUMENT);
+
+    // Castling and underpromotion in the interface's square numbering
+    REQUIRE(tempo_position_set_fen(p.get(), FENS[4]) == TEMPO_OK);
+    const tempo_move special[] = { move("e1", "g1"), move("b8", "a6"), move("d7", "c8", TEMPO_PROMO_KNIGHT) };
+    REQUIRE(tempo_position_apply_moves(p.get(), special, 3, &applied) == TEMPO_OK);
+    Board expected = Board();
+    expected.setFromFEN(FENS[4]);
+    for (auto uci : { "e1g1", "b8a6", "d7c8n" }) expected.move(moveFromUCI(expected, uci));
+    REQUIRE(tempo_position_key(p.get()) == polyglotKey(expected));
+}
+
+TEST_CASE("C interface packed records") {
+    Board b = Board();
+    REQUIRE(b.setFromFEN(FENS[1]));
+    TrainingRecord records[2];
+    REQUIRE(packRecord(b, 0, 1, records[0]));
+    records[1] = records[0];
+    records[1].pieces[0] = 0xFF; // piece codes past the black king
+
+    PositionHandle p(tempo_position_new());
+    REQUIRE(tempo_position_set_record(p.get(), &records[0]) == TEMPO_OK);
+    REQUIRE(tempo_position_key(p.get()) == polyglotKey(b));
+    REQUIRE(tempo_position_set_record(p.get(), &records[1]) == TEMPO_ERR_RECORD);
+
+    uint32_t counts[2];
+    REQUIRE(tempo_batch_count_records(nullptr, records, 1, counts) == TEMPO_OK);
+    REQUIRE(counts[0] == 48);
+    REQUIRE(tempo_batch_count_records(nullptr, records, 2, counts) == TEMPO_ERR_RECORD);
+    REQUIRE(counts[0] == 48);
+    REQUIRE(counts[1] == 0);
+
+    // Records must hold positions setFromFEN would accept, or castling and ep moves corrupt the board
+    const auto record = [](const char* fen) {
+        Board from = Board();
+        REQUIRE(from.setFromFEN(fen));
+        TrainingRecord r;
+        REQUIRE(packRecord(from, 0, 1, r));
+        return r;
+    };
+    TrainingRecord bad = record("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+    bad.castling = W_K_FLAG; // no rook on h1
+    REQUIRE(tempo_position_set_record(p.get(), &bad) == TEMPO_ERR_RECORD);
+    bad = record("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+    bad.epSquare = sq(3, 5); // e6 with no pawn on e5
+    REQUIRE(tempo_position_set_record(p.get(), &bad) == TEMPO_ERR_RECORD);
+    bad = record("4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+    bad.pieces[0] &= 0x0F; // the a1 rook, after the e1 king, made a pawn
+    REQUIRE(tempo_position_set_record(p.get(), &bad) == TEMPO_ERR_RECORD);
+    bad = record("4k3/8/8/8/8/8/8/4K2r w - - 0 1");
+    bad.blackToMove = 1; // white in check with black to move
+    REQUIRE(tempo_position_set_record(p.get(), &bad) == TEMPO_ERR_RECORD);
+    bad.blackToMove = 0;
+    REQUIRE(tempo_position_set_record(p.get(), &bad) == TEMPO_OK);
+}
+
+TEST_CASE("C interface batches match with and without a pool") {
+    constexpr size_t COPIES = 8; // each FEN several times, as separate handles
+    const size_t n = std::size(FENS) * COPIES;
+    std::vector<PositionHandle> owned;
+    std::vector<tempo_position*> positions;
+    for (size_t i = 0; i < n; ++i) {
+        owned.emplace_back(tempo_position_new());
+        REQUIRE(tempo_position_set_fen(owned.back().get(), FENS[i % std::size(FENS)]) == TEMPO_OK);
+        positions.push_back(owned.back().get());
+    }
+    const uint64_t PERFT3[] = { 8902, 97862, 2812, 9467, 62379 };
+
+    PoolHandle pool(tempo_pool_new(4));
+    REQUIRE(pool);
+    REQUIRE(tempo_pool_threads(pool.get()) == 4);
+
+    for (tempo_pool* runner : { static_cast<tempo_pool*>(nullptr), pool.get() }) {
+        std::vector<uint64_t> nodes(n);
+        REQUIRE(tempo_batch_perft(runner, positions.data(), n, 3, nodes.data()) == TEMPO_OK);
+        for (size_t i = 0; i < n; ++i) REQUIRE(nodes[i] == PERFT3[i % std::size(FENS)]);
+
+        std::vector<uint32_t> counts(n), listed(n);
+        std::vector<tempo_move> moves(n * TEMPO_MAX_MOVES);
+        REQUIRE(tempo_batch_count_moves(runner, positions.data(), n, counts.data()) == TEMPO_OK);
+        REQUIRE(tempo_batch_legal_moves(runner, positions.data(), n, moves.data(), TEMPO_MAX_MOVES, listed.data()) == TEMPO_OK);
+        REQUIRE(counts == listed);
+        for (size_t i = 0; i < n; ++i) {
+            tempo_move single[TEMPO_MAX_MOVES];
+            REQUIRE(tempo_position_legal_moves(positions[i], single, TEMPO_MAX_MOVES) == int(counts[i]));
+            REQUIRE(std::equal(single, single + counts[i], moves.begin() + i * TEMPO_MAX_MOVES));
+        }
+
+        // Too small a stride still reports the full counts
+        std::vector<tempo_move> few(n * 16);
+        REQUIRE(tempo_batch_legal_moves(runner, positions.data(), n, few.data(), 16, listed.data()) == TEMPO_ERR_CAPACITY);
+        REQUIRE(counts == listed);
+    }
+
+    REQUIRE(tempo_batch_perft(pool.get(), positions.data(), n, TEMPO_MAX_PERFT_DEPTH + 1, nullptr) == TEMPO_ERR_ARGUMENT);
+}
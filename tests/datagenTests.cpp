@@ -0,0 +1,73 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "training.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+TEST_CASE("Training records round trip positions") {
+    for (auto fen : { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                      "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+                      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 7 40" }) {
+        INFO(fen);
+        Board b = Board(), restored = Board();
+        REQUIRE(b.setFromFEN(fen));
+        TrainingRecord record;
+        REQUIRE(packRecord(b, -123, 2, record));
+        unpackRecord(record, restored);
+        REQUIRE(restored.bb == b.bb);
+        REQUIRE(restored.whiteToMove == b.whiteToMove);
+        REQUIRE(restored.castling == b.castling);
+        REQUIRE(restored.epSquare == b.epSquare);
+        REQUIRE(restored.halfMoveClock == b.halfMoveClock);
+        REQUIRE(record.score == -123);
+        REQUIRE(record.result == 2);
+    }
+}
+
+TEST_CASE("Data generation writes a deduplicated, filtered position budget") {
+    const auto dir = std::filesystem::temp_directory_path() / "tempo_datagen_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    DataGenOptions options;
+    options.prefix = (dir / "shard").string();
+    options.positions = 300;
+    options.shardSize = 64;
+    options.threads = 2;
+    options.limits.depth = 1;
+    options.dedupMB = 1;
+    const DataGenStats stats = generateData(options);
+    REQUIRE(stats.positions == 300);
+
+    std::set<uint64_t> keys;
+    size_t records = 0;
+    Board b = Board();
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        REQUIRE(std::filesystem::file_size(entry) <= 64 * sizeof(TrainingRecord));
+        std::ifstream in(entry.path(), std::ios::binary);
+        for (TrainingRecord record; in.read(reinterpret_cast<char*>(&record), sizeof(record));) {
+            unpackRecord(record, b);
+            REQUIRE_FALSE(b.inCheck());
+            REQUIRE(record.result <= 2);
+            keys.insert(b.getKey());
+            ++records;
+        }
+    }
+    REQUIRE(records == 300);
+    REQUIRE(keys.size() == records);
+    REQUIRE_FALSE(stats.writeFailed);
+
+    // A prefix in a directory that does not exist: nothing reaches a shard, nothing is counted
+    options.prefix = (dir / "missing" / "shard").string();
+    options.threads = 1;
+    const DataGenStats failed = generateData(options);
+    REQUIRE(failed.writeFailed);
+    REQUIRE(failed.positions == 0);
+    std::filesystem::remove_all(dir);
+}
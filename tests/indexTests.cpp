@@ -0,0 +1,156 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "match.h"
+#include "notation.h"
+#include "positionindex.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+static const char* TRANSPOSED =
+    "[Event \"A\"]\n\n1. d4 d5 2. Nf3 Nf6 1/2-1/2\n\n"
+    "[Event \"B\"]\n\n1. Nf3 d5 2. d4 Nf6 *\n\n"
+    "[Event \"C\"]\n\n1. e4 e5 0-1\n";
+
+static uint64_t keyAfter(std::initializer_list<const char*> moves, std::string_view fen = START_FEN) {
+    Board b = Board();
+    b.setFromFEN(fen);
+    for (auto m : moves) b.move(moveFromUCI(b, m));
+    return b.getKey();
+}
+
+TEST_CASE("Position index finds every game through a position") {
+    const auto dir = std::filesystem::temp_directory_path() / "tempo_index_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "a.pgn") << TRANSPOSED;
+    // The second file: a long game, so small buffers spill several runs
+    std::string shuffle = "[Event \"D\"]\n\n";
+    for (int i = 0; i < 400; ++i) shuffle += i % 2 == 0 ? "Nf3 Nf6 Ng1 Ng8 " : "Nc3 Nc6 Nb1 Nb8 ";
+    std::ofstream(dir / "b.pgn") << shuffle << "*\n";
+
+    IndexBuildOptions options;
+    options.threads = 2;
+    options.memoryBytes = 2 * 1024 * sizeof(IndexEntry);
+    IndexBuildStats stats;
+    const std::string path = (dir / "corpus.tki").string();
+    REQUIRE(buildPositionIndex({ (dir / "a.pgn").string(), (dir / "b.pgn").string() }, path, options, stats));
+    REQUIRE(stats.games == 4);
+    REQUIRE(stats.failed == 0);
+    REQUIRE(stats.entries == 5 + 5 + 3 + 1601);
+    REQUIRE(stats.runs >= 2);
+    REQUIRE(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()) == 3);
+
+    PositionIndex index;
+    REQUIRE(index.open(path));
+    REQUIRE(index.size() == stats.entries);
+    REQUIRE(index.games() == 4);
+
+    // Every game starts from the initial position; the shuffling one comes back to it every four plies
+    const auto start = index.find(Board().getKey());
+    REQUIRE(start.size() == 3 + 401);
+    REQUIRE(start[0].game() == 0);
+    REQUIRE(start[0].ply() == 0);
+    const uint64_t secondFile = std::filesystem::file_size(dir / "a.pgn");
+    REQUIRE(start[3].game() == secondFile);
+    REQUIRE(start[4].ply() == 4);
+
+    // A and B transpose after four plies (not after three: B's last move there is a double push,
+    // and the keys hash the en passant square)
+    const auto transposed = index.find(keyAfter({ "d2d4", "d7d5", "g1f3", "g8f6" }));
+    REQUIRE(transposed.size() == 2);
+    REQUIRE(transposed[0].ply() == 4);
+    REQUIRE(transposed[1].ply() == 4);
+    REQUIRE(transposed[1].game() == std::string_view(TRANSPOSED).find("[Event \"B\"]"));
+    REQUIRE(index.find(keyAfter({ "e2e4", "e7e5" })).size() == 1);
+    REQUIRE(index.find(keyAfter({ "a2a3" })).empty());
+
+    // Merged two runs at a time, in several passes, the index comes out the same
+    options.mergeFanIn = 2;
+    IndexBuildStats fannedStats;
+    const std::string fanned = (dir / "fanned.tki").string();
+    REQUIRE(buildPositionIndex({ (dir / "a.pgn").string(), (dir / "b.pgn").string() }, fanned, options, fannedStats));
+    REQUIRE(fannedStats.runs > 2);
+    const auto contents = [](const std::string& file) {
+        std::ifstream in(file, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    };
+    REQUIRE(contents(fanned) == contents(path));
+    std::filesystem::remove(fanned);
+    REQUIRE(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()) == 3);
+
+    // An index opened under other keys is refused
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(offsetof(IndexHeader, zobristSeed));
+        file.put('x');
+    }
+    PositionIndex stale;
+    REQUIRE_FALSE(stale.open(path));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Position index reads packed self-play games") {
+    const std::vector<std::string> openings = { std::string(START_FEN), "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1" };
+    const auto record = [&](size_t index, std::initializer_list<const char*> ucis) {
+        GameRecord game{};
+        game.index = index;
+        Board b = Board();
+        b.setFromFEN(openings[index % openings.size()]);
+        for (auto uci : ucis) {
+            game.moves.push_back(moveFromUCI(b, uci));
+            b.move(game.moves.back());
+        }
+        game.result = GameResult::Draw;
+        game.termination = Termination::MaxPlies;
+        return game;
+    };
+    std::string packed;
+    packGame(record(0, { "e2e4", "e7e5" }), packed);
+    const uint64_t second = packed.size();
+    packGame(record(3, { "a1a8" }), packed);
+    const uint64_t third = packed.size();
+    packGame(record(2, { "d2d4", "d7d5" }), packed);
+    GameRecord misplaced = record(1, { "a1a8" });
+    misplaced.index = 4; // picks the start position, where a1a8 does not replay
+    packGame(misplaced, packed);
+    packed.append(3, '\0'); // a record cut short
+
+    const auto dir = std::filesystem::temp_directory_path() / "tempo_index_packed_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "games.bin", std::ios::binary) << packed;
+
+    IndexBuildOptions options;
+    options.threads = 2;
+    options.packed = true;
+    options.openings = openings;
+    IndexBuildStats stats;
+    const std::string path = (dir / "games.tki").string();
+    REQUIRE(buildPositionIndex({ (dir / "games.bin").string() }, path, options, stats));
+    REQUIRE(stats.games == 5);
+    REQUIRE(stats.failed == 2);
+    REQUIRE(stats.entries == 3 + 2 + 3);
+
+    // Games are named by the offset of their record
+    PositionIndex index;
+    REQUIRE(index.open(path));
+    const auto start = index.find(Board().getKey());
+    REQUIRE(start.size() == 2);
+    REQUIRE(start[0].game() == 0);
+    REQUIRE(start[1].game() == third);
+    const auto mate = index.find(keyAfter({ "a1a8" }, openings[1]));
+    REQUIRE(mate.size() == 1);
+    REQUIRE(mate[0].game() == second);
+    REQUIRE(mate[0].ply() == 1);
+    const auto queens = index.find(keyAfter({ "d2d4", "d7d5" }));
+    REQUIRE(queens.size() == 1);
+    REQUIRE(queens[0].ply() == 2);
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,141 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "attacks.h"
+#include "board.h"
+#include "fill.h"
+#include "notation.h"
+#include <algorithm>
+#include <iterator>
+#include <random>
+
+static const char* VALIDATION_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/8/8/2k5/3Pp3/8/8/4K2Q b - d3 0 1", // ep capture of the checking pawn
+    "8/8/8/8/k2Pp2Q/8/8/4K3 b - d3 0 1",  // ep capture exposing the king along the rank
+    "4k3/1P6/2P5/8/B3N3/8/4R3/4K3 w - - 0 1", // discovered checks, a checking promotion
+    "5k2/8/8/8/8/8/8/4K2R w K - 0 1",       // castling with check
+    "4k3/8/8/8/8/4K3/8/4R3 w - - 0 1",      // the king discovering check
+};
+
+// Every (from, to, promo) triple must validate exactly when it is in the legal move list
+static void checkPosition(Board& b) {
+    MoveList legal;
+    b.genLegalMoves(legal);
+    size_t accepted = 0;
+    for (uint8_t from = 0; from < NUM_SQUARES; ++from)
+        for (uint8_t to = 0; to < NUM_SQUARES; ++to)
+            for (uint8_t promo : { uint8_t(0), uint8_t(1), uint8_t(2), uint8_t(3), Move::PROMO_MASK }) {
+                const uint32_t m = b.encodeMove(from, to, promo);
+                const bool ok = b.isPseudoLegal(m) && b.isLegal(m);
+                const bool generated = std::find(legal.begin(), legal.end(), m) != legal.end();
+                if (ok != generated) FAIL_CHECK(moveToUCI(m) << " validated " << ok << " generated " << generated);
+                accepted += ok;
+            }
+    REQUIRE(accepted == legal.size());
+    REQUIRE(b.countLegalMoves() == int(legal.size()));
+
+    for (auto m : legal) {
+        const bool predicted = b.givesCheck(m);
+        b.move(m);
+        const bool checks = b.inCheck();
+        b.undoMove(m);
+        if (predicted != checks) FAIL_CHECK(moveToUCI(m) << " givesCheck " << predicted);
+    }
+
+    MoveList checks, expected;
+    b.genLegalChecks(checks);
+    std::copy_if(legal.begin(), legal.end(), std::back_inserter(expected), [&](uint32_t m) { return b.givesCheck(m); });
+    std::sort(checks.begin(), checks.end());
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(checks == expected);
+}
+
+TEST_CASE("Move validation agrees with the generator") {
+    for (auto fen : VALIDATION_FENS) {
+        INFO(fen);
+        Board b = Board();
+        REQUIRE(b.setFromFEN(fen));
+        checkPosition(b);
+
+        MoveList moves;
+        b.genLegalMoves(moves);
+        for (auto m : moves) {
+            b.move(m);
+            checkPosition(b);
+            b.undoMove(m);
+        }
+    }
+}
+
+TEST_CASE("Move validation rejects stale and corrupt moves") {
+    Board b = Board();
+    const uint32_t e2e4 = moveFromUCI(b, "e2e4");
+    REQUIRE(b.isPseudoLegal(e2e4));
+    REQUIRE_FALSE(b.isPseudoLegal(Move::NONE));
+    REQUIRE_FALSE(b.isPseudoLegal(e2e4 | Move::CAPTURED_FLAG));
+    REQUIRE_FALSE(b.isPseudoLegal(b.encodeMove(sq(3, 1), sq(3, 4)))); // e2e5
+
+    b.move(e2e4);
+    REQUIRE_FALSE(b.isPseudoLegal(e2e4)); // black to move now
+    REQUIRE(moveFromUCI(b, "e7e5") != Move::NONE);
+    REQUIRE(moveFromUCI(b, "e1e2") == Move::NONE);
+}
+
+// Square by square against the attack scan, with the defending king lifted off the board
+static void checkAttackMaps(const Board& b) {
+    for (bool white : { true, false }) {
+        const uint64_t occ = b.occAll & ~b.bb[to_u(getOurKing(!white))];
+        uint64_t expected = 0;
+        for (uint8_t s = 0; s < NUM_SQUARES; ++s)
+            if (isSquareAttacked(b.bb, s, !white, occ)) expected |= 1ULL << s;
+        REQUIRE(b.attackedBy(white ? Color::White : Color::Black) == expected);
+
+        for (Piece p : white ? WHITE_PIECES : BLACK_PIECES) {
+            uint64_t pieceExpected = 0;
+            forEachSetBit(b.bb[to_u(p)], [&](uint8_t from) { pieceExpected |= attacksFrom(p, from, occ); });
+            REQUIRE(b.attackedByPiece(p) == pieceExpected);
+        }
+    }
+}
+
+TEST_CASE("Attack maps follow make, unmake and null moves") {
+    for (auto fen : VALIDATION_FENS) {
+        INFO(fen);
+        Board b = Board();
+        REQUIRE(b.setFromFEN(fen));
+        checkAttackMaps(b);
+
+        MoveList moves;
+        b.genLegalMoves(moves);
+        for (auto m : moves) {
+            b.move(m);
+            checkAttackMaps(b);
+            b.makeNullMove();
+            checkAttackMaps(b);
+            b.undoNullMove();
+            b.undoMove(m);
+            checkAttackMaps(b);
+        }
+    }
+}
+
+TEST_CASE("Slider fills match a lookup per piece") {
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 20000; ++i) {
+        // Sparse occupancy half the time, so rays run into the board edges
+        const uint64_t occ = i % 2 ? rng() & rng() & rng() : rng();
+        const uint64_t rookLike = occ & rng() & rng(), bishopLike = occ & rng() & rng();
+        uint64_t expected = 0;
+        forEachSetBit(rookLike, [&](uint8_t from) { expected |= rookAttacks(from, occ); });
+        forEachSetBit(bishopLike, [&](uint8_t from) { expected |= bishopAttacks(from, occ); });
+        REQUIRE(slidingAttacksScalar(rookLike, bishopLike, occ) == expected);
+        REQUIRE(slidingAttacks(rookLike, bishopLike, occ) == expected);
+    }
+}
@@ -0,0 +1,132 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "mate.h"
+#include "notation.h"
+#include "uci.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+// Plays the line and checks that it ends in mate with the board restored afterwards
+static void requireMatingLine(Board& b, const MateResult& r) {
+    REQUIRE(r.line.size() == size_t(2 * r.moves - 1));
+    const uint64_t key = b.getKey();
+    MoveList legal;
+    for (auto m : r.line) {
+        b.genLegalMoves(legal);
+        REQUIRE(std::find(legal.begin(), legal.end(), m) != legal.end());
+        b.move(m);
+    }
+    b.genLegalMoves(legal);
+    REQUIRE(legal.empty());
+    REQUIRE(b.inCheck());
+    for (auto it = r.line.rbegin(); it != r.line.rend(); ++it) b.undoMove(*it);
+    REQUIRE(b.getKey() == key);
+}
+
+TEST_CASE("Mate solver finds shortest mates") {
+    struct Puzzle { const char* fen; int moves; const char* first; };
+    for (const Puzzle& p : {
+            Puzzle{ "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1, "a1a8" },
+            Puzzle{ "k7/8/2K5/8/8/8/8/7R w - - 0 1", 2, "c6b6" }, // quiet first move
+            Puzzle{ "r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5Q2/PPPP1PPP/RNB1K1NR w KQkq - 0 1", 1, "f3f7" } }) {
+        INFO(p.fen);
+        Board b = Board();
+        REQUIRE(b.setFromFEN(p.fen));
+        MateLimits limits;
+        limits.maxMoves = 4;
+        const MateResult r = solveMate(b, limits);
+        REQUIRE(r.status == MateStatus::Mate);
+        REQUIRE(r.moves == p.moves);
+        REQUIRE(moveToUCI(r.line.front()) == p.first);
+        REQUIRE(r.nodes > 0);
+        REQUIRE(r.memoryBytes >= size_t(limits.hashMB) << 20);
+        requireMatingLine(b, r);
+    }
+}
+
+TEST_CASE("Mate solver proves the absence of mate") {
+    Board b = Board();
+    MateLimits limits;
+    limits.maxMoves = 2;
+    MateResult r = solveMate(b, limits);
+    REQUIRE(r.status == MateStatus::NoMate);
+    REQUIRE(r.line.empty());
+
+    // Stalemating is no mate
+    REQUIRE(b.setFromFEN("k7/8/1Q6/8/8/8/8/7K w - - 0 1"));
+    limits.maxMoves = 1;
+    REQUIRE(solveMate(b, limits).status == MateStatus::NoMate);
+
+    // Forced-mate mode only looks at checks, so the quiet mate in two is out of reach
+    REQUIRE(b.setFromFEN("k7/8/2K5/8/8/8/8/7R w - - 0 1"));
+    limits.maxMoves = 2;
+    limits.checksOnly = true;
+    r = solveMate(b, limits);
+    REQUIRE(r.status == MateStatus::NoMate);
+}
+
+TEST_CASE("Mate solver respects the node limit") {
+    Board b = Board();
+    REQUIRE(b.setFromFEN("r1bqkbnr/pppp1ppp/2n5/4p3/2B1P3/5Q2/PPPP1PPP/RNB1K1NR w KQkq - 0 1"));
+    b.move(moveFromUCI(b, "b1c3")); // no mate for black here
+    MateLimits limits;
+    limits.maxMoves = 6;
+    limits.nodes = 2000;
+    const MateResult r = solveMate(b, limits);
+    REQUIRE(r.status == MateStatus::Unknown);
+    REQUIRE(r.nodes <= limits.nodes);
+}
+
+TEST_CASE("Mate solver table is reused across solves") {
+    MateSolver solver(4);
+    Board b = Board();
+    REQUIRE(b.setFromFEN("k7/8/2K5/8/8/8/8/7R w - - 0 1"));
+    MateLimits limits;
+    limits.maxMoves = 3;
+    const MateResult first = solver.solve(b, limits);
+    const MateResult second = solver.solve(b, limits);
+    REQUIRE(first.status == MateStatus::Mate);
+    REQUIRE(second.moves == first.moves);
+    REQUIRE(second.line == first.line);
+    REQUIRE(second.nodes < first.nodes);
+}
+
+TEST_CASE("UCI go mate answers from the mate solver") {
+    std::istringstream in;
+    std::ostringstream out;
+    UCI uci(in, out);
+    REQUIRE(uci.execute("position fen k7/8/2K5/8/8/8/8/7R w - - 0 1"));
+    REQUIRE(uci.execute("go mate 3"));
+    uci.wait();
+    REQUIRE(out.str().find("score mate 2") != std::string::npos);
+    REQUIRE(out.str().find("bestmove c6b6") != std::string::npos);
+}
+
+TEST_CASE("UCI go mate and go perft leave stop and isready answered") {
+    std::istringstream in;
+    std::ostringstream out;
+    UCI uci(in, out);
+    for (const char* go : { "go mate 40", "go perft 9" }) {
+        INFO(go);
+        REQUIRE(uci.execute("position startpos"));
+        REQUIRE(uci.execute(go));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(uci.execute("isready"));
+
+        const auto t0 = std::chrono::steady_clock::now();
+        REQUIRE(uci.execute("stop")); // returns once the answer has ended
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+        REQUIRE(ms < 100);
+        const std::string s = out.str();
+        const size_t ready = s.rfind("readyok");
+        REQUIRE(ready != std::string::npos);
+        REQUIRE(s.find(std::string(go) == "go mate 40" ? "bestmove" : "perft stopped", ready) != std::string::npos);
+        out.str("");
+    }
+}
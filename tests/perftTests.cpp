@@ -17,6 +17,18 @@ TEST_CASE("Perft leaves board state unchanged") {
     REQUIRE(initKey == finalKey);
 }
 
+TEST_CASE("Hashed perft matches perft") {
+    HashTable table(1);
+    for (auto fen : { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" }) {
+        Board b = Board();
+        REQUIRE(b.setFromFEN(fen));
+        const uint64_t expected = Perft(b, 4);
+        REQUIRE(HashedPerft(b, 4, table) == expected);
+        REQUIRE(HashedPerft(b, 4, table) == expected); // warm
+    }
+}
+
 TEST_CASE("Perft initial position node counts") {
     Board b = Board();
     REQUIRE(Perft(b, 1) == 20);
@@ -27,13 +39,11 @@ TEST_CASE("Perft initial position node counts") {
     REQUIRE(Perft(b, 6) == 119060324);
 }
 
-//TEST_CASE("Perft Kiwipete position node counts") {
-//    Board b = Board();
-//    b.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - ");
-//    REQUIRE(Perft(b, 1) == 48);
-//    REQUIRE(Perft(b, 2) == 2039);
-//    REQUIRE(Perft(b, 3) == 97862);
-//    REQUIRE(Perft(b, 4) == 4085603);
-//    REQUIRE(Perft(b, 5) == 193690690);
-//    REQUIRE(Perft(b, 6) == 8031647685);
-//}
\ No newline at end of file
+TEST_CASE("Perft Kiwipete position node counts") {
+    Board b = Board();
+    REQUIRE(b.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - "));
+    REQUIRE(Perft(b, 1) == 48);
+    REQUIRE(Perft(b, 2) == 2039);
+    REQUIRE(Perft(b, 3) == 97862);
+    REQUIRE(Perft(b, 4) == 4085603);
+}
@@ -0,0 +1,102 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "notation.h"
+#include "pgn.h"
+#include <algorithm>
+#include <mutex>
+
+static const char* SAN_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "6k1/5ppp/8/8/R7/8/8/R3K2R w K - 0 1", // rooks sharing a file and a rank
+};
+
+static const char* TWO_GAMES =
+    "[Event \"Opera\"]\n"
+    "[Result \"1-0\"]\n"
+    "\n"
+    "1. e4 e5 2. Nf3 d6 3. d4 Bg4 {a comment} 4. dxe5 Bxf3 5. Qxf3 dxe5 6. Bc4 Nf6 7. Qb3 Qe7\n"
+    "8. Nc3 (8. Qxb7 Qb4+ (8... Qxb7?)) c6 9. Bg5 b5 10. Nxb5 cxb5 11. Bxb5+ Nbd7 12. O-O-O Rd8\n"
+    "13. Rxd7 Rxd7 14. Rd1 Qe6 15. Bxd7+ Nxd7 16. Qb8+ Nxb8 17. Rd8# 1-0\n"
+    "\n"
+    "[Event \"Promotion\"]\n"
+    "[FEN \"8/P6k/8/8/8/8/8/K7 w - - 0 1\"]\n"
+    "\n"
+    "1. a8=Q $1 Kg6 2. Qg8+ *\n";
+
+TEST_CASE("SAN round trips every legal move") {
+    for (auto fen : SAN_FENS) {
+        INFO(fen);
+        Board b = Board();
+        REQUIRE(b.setFromFEN(fen));
+        MoveList legal;
+        b.genLegalMoves(legal);
+        for (auto m : legal) {
+            const std::string san = moveToSAN(b, m);
+            INFO(san);
+            REQUIRE(moveFromSAN(b, san) == m);
+        }
+    }
+
+    Board b = Board();
+    REQUIRE(b.setFromFEN("6k1/5ppp/8/8/R7/8/8/R3K2R w K - 0 1"));
+    REQUIRE(moveToSAN(b, moveFromUCI(b, "a1a2")) == "R1a2");
+    REQUIRE(moveToSAN(b, moveFromUCI(b, "h1h2")) == "Rh2");
+    REQUIRE(moveToSAN(b, moveFromUCI(b, "e1g1")) == "O-O");
+    REQUIRE(moveToSAN(b, moveFromUCI(b, "a4a8")) == "Ra8#");
+    REQUIRE(moveFromSAN(b, "Ra3") == Move::NONE); // either rook
+    REQUIRE(moveFromSAN(b, "Nf3") == Move::NONE);
+}
+
+TEST_CASE("PGN games are split and replayed") {
+    const std::string_view text = TWO_GAMES;
+    const size_t second = nextGameStart(text, 1);
+    REQUIRE(nextGameStart(text, 0) == 0);
+    REQUIRE(text.substr(second, 22) == "[Event \"Promotion\"]\n[F");
+    REQUIRE(nextGameStart(text, second + 1) == text.size());
+
+    Board b = Board();
+    MoveList legal;
+    PgnGame game;
+    REQUIRE(replayGame(text.substr(0, second), b, game, legal));
+    REQUIRE(game.moves.size() == 33);
+    REQUIRE(game.result == "1-0");
+    REQUIRE(b.inCheck());
+
+    REQUIRE(replayGame(text.substr(second), b, game, legal));
+    REQUIRE(game.moves.size() == 3);
+    REQUIRE(game.result == "*");
+    REQUIRE(game.finalKey == b.getKey());
+
+    REQUIRE_FALSE(replayGame("1. e4 e5 2. Ke3 *", b, game, legal));
+    REQUIRE(game.error == "Ke3");
+    REQUIRE(game.moves.size() == 2);
+}
+
+TEST_CASE("Parallel PGN replay matches a single thread") {
+    std::string text;
+    for (int i = 0; i < 4000; ++i) text += TWO_GAMES; // a few chunks
+
+    std::mutex mutex;
+    std::vector<std::pair<size_t, uint64_t>> single, parallel;
+    const auto collect = [&](std::vector<std::pair<size_t, uint64_t>>& into) {
+        return [&](const PgnGame& game) {
+            std::lock_guard lock(mutex);
+            into.emplace_back(game.offset, game.finalKey);
+        };
+    };
+    const PgnStats one = replayPgn(text, 1, collect(single));
+    const PgnStats four = replayPgn(text, 4, collect(parallel));
+    REQUIRE(one.games == 8000);
+    REQUIRE(one.failed == 0);
+    REQUIRE(four.games == one.games);
+    REQUIRE(four.plies == one.plies);
+    std::sort(parallel.begin(), parallel.end());
+    REQUIRE(parallel == single);
+}
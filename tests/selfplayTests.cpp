@@ -0,0 +1,118 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "match.h"
+#include "notation.h"
+#include <algorithm>
+#include <mutex>
+
+// Plays the given UCI moves in turn, starting over at the end of the list
+static MoveSelector scripted(std::vector<std::string> moves) {
+    return [moves, i = size_t(0)](Board& board, const MoveList&) mutable {
+        return MoveChoice{ moveFromUCI(board, moves[i++ % moves.size()]), 0, 0 };
+    };
+}
+
+static GameRecord play(const char* fen, const MoveSelector& select, MatchOptions options = {}) {
+    Board board = Board();
+    GameRecord game;
+    game.index = 0;
+    game.opening = fen;
+    playGame(board, game, select, options);
+    return game;
+}
+
+TEST_CASE("Self-play adjudicates finished games") {
+    SearchLimits limits;
+    limits.depth = 2;
+    GameRecord game = play("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", searchSelector(limits)(0));
+    REQUIRE(game.termination == Termination::Checkmate);
+    REQUIRE(game.result == GameResult::WhiteWins);
+    REQUIRE(game.moves.size() == 1);
+
+    game = play("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", scripted({ "h8g8" }));
+    REQUIRE(game.termination == Termination::Stalemate);
+    REQUIRE(game.result == GameResult::Draw);
+    REQUIRE(game.moves.empty());
+
+    game = play(START_FEN.data(), scripted({ "g1f3", "g8f6", "f3g1", "f6g8" }));
+    REQUIRE(game.termination == Termination::Repetition);
+    REQUIRE(game.moves.size() == 8);
+
+    game = play("7k/8/8/8/8/8/8/K7 w - - 99 80", scripted({ "a1a2" }));
+    REQUIRE(game.termination == Termination::FiftyMoves);
+    REQUIRE(game.moves.size() == 1);
+
+    game = play(START_FEN.data(), scripted({ "e2e5" }));
+    REQUIRE(game.termination == Termination::NoMove);
+    REQUIRE(game.result == GameResult::BlackWins);
+
+    MatchOptions options;
+    options.maxPlies = 10;
+    game = play(START_FEN.data(), scripted({ "g1f3", "g8f6", "b1c3", "b8c6", "f3g1", "f6g8", "c3b1", "c6b8" }), options);
+    REQUIRE(game.termination == Termination::MaxPlies);
+    REQUIRE(game.moves.size() == 10);
+}
+
+TEST_CASE("Self-play match runs games on every worker") {
+    MatchOptions options;
+    options.games = 12;
+    options.threads = 3;
+    options.maxPlies = 60;
+    options.randomPlies = 8;
+    SearchLimits limits;
+    limits.depth = 1;
+
+    std::mutex mutex;
+    std::vector<size_t> seen;
+    bool scored = true;
+    const MatchStats stats = playMatch({ std::string(START_FEN) }, options, searchSelector(limits), [&](const GameRecord& game) {
+        std::lock_guard lock(mutex);
+        seen.push_back(game.index);
+        scored &= game.moves.size() == game.scores.size();
+    });
+    REQUIRE(stats.games == 12);
+    REQUIRE(scored);
+    REQUIRE(stats.whiteWins + stats.blackWins + stats.draws == 12);
+    std::sort(seen.begin(), seen.end());
+    for (size_t i = 0; i < seen.size(); ++i) REQUIRE(seen[i] == i);
+}
+
+TEST_CASE("Self-play games pack to 16-bit moves and back") {
+    const char* fen = "r3k2r/P7/8/8/8/8/8/R3K2R w KQkq - 0 1";
+    MatchOptions options;
+    options.maxPlies = 4;
+    GameRecord game = play(fen, scripted({ "e1g1", "e8c8", "a7a8q", "c8c7" }), options);
+    game.index = 70000;
+    REQUIRE(game.moves.size() == 4);
+    GameRecord mate = play("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", scripted({ "a1a8" }));
+
+    std::string file;
+    packGame(game, file);
+    REQUIRE(file.size() == sizeof(PackedGameHeader) + 4 * sizeof(uint16_t));
+    packGame(mate, file);
+
+    std::string_view data = file;
+    GameRecord back;
+    REQUIRE(unpackGame(data, fen, back));
+    REQUIRE(back.index == 70000);
+    REQUIRE(back.moves == game.moves);
+    REQUIRE(back.termination == Termination::MaxPlies);
+    REQUIRE(back.result == GameResult::Draw);
+    REQUIRE(unpackGame(data, "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", back));
+    REQUIRE(back.moves == mate.moves);
+    REQUIRE(back.termination == Termination::Checkmate);
+    REQUIRE(back.result == GameResult::WhiteWins);
+    REQUIRE(data.empty());
+
+    // Cut short, or replayed from the wrong opening
+    data = std::string_view(file).substr(0, file.size() - 1);
+    REQUIRE(unpackGame(data, fen, back));
+    REQUIRE_FALSE(unpackGame(data, "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", back));
+    REQUIRE(data.size() == sizeof(PackedGameHeader) + 1);
+    data = file;
+    REQUIRE_FALSE(unpackGame(data, START_FEN, back));
+    REQUIRE(data.size() == file.size());
+}
@@ -0,0 +1,170 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "server.h"
+#include <algorithm>
+#include <filesystem>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+std::string answer(std::string_view line, const ServerOptions& options = {}) {
+    static ServerWorker worker;
+    ServerRequest request;
+    if (const std::string error = parseRequest(line, request); !error.empty()) return errorResponse(request.id, error);
+    return respond(request, worker, options);
+}
+
+bool contains(const std::string& text, std::string_view part) { return text.find(part) != std::string::npos; }
+
+int connectTo(const std::string& path) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    REQUIRE(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof address) == 0);
+    return fd;
+}
+
+// Reads until received holds the given number of lines
+void readLines(int fd, std::string& received, size_t lines) {
+    char chunk[4096];
+    while (std::count(received.begin(), received.end(), '\n') < ptrdiff_t(lines)) {
+        const ssize_t n = ::recv(fd, chunk, sizeof chunk, 0);
+        REQUIRE(n > 0);
+        received.append(chunk, size_t(n));
+    }
+}
+
+}
+
+TEST_CASE("Server requests") {
+    REQUIRE(answer(R"({"id":1,"op":"perft","depth":3})") == R"({"id":1,"ok":true,"nodes":8902})");
+    REQUIRE(answer(R"({"op":"perft","depth":2,"fen":"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"})") ==
+            R"({"id":null,"ok":true,"nodes":2039})");
+
+    const std::string legal = answer(R"({"id":"a\"b","op":"legal","moves":["e2e4","e7e5"],"extra":{"x":[1,2]}})");
+    REQUIRE(contains(legal, R"({"id":"a\"b","ok":true,"moves":[)"));
+    REQUIRE(contains(legal, R"("e1e2")"));
+    REQUIRE(std::count(legal.begin(), legal.end(), ',') == 2 + 28);
+
+    REQUIRE(answer(R"({"id":3,"op":"validate","moves":"e2e4  e7e5 e1e3"})") ==
+            R"({"id":3,"ok":true,"valid":false,"applied":2,"illegal":"e1e3"})");
+    REQUIRE(answer(R"({"id":4,"op":"validate","moves":[]})") == R"({"id":4,"ok":true,"valid":true,"applied":0})");
+
+    REQUIRE(answer(R"({"id":5,"op":"eval"})") == R"({"id":5,"ok":true,"score":0})");
+    const std::string searched = answer(R"({"id":6,"op":"eval","depth":3,"fen":"6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"})");
+    REQUIRE(contains(searched, R"("best":"a1a8")"));
+
+    REQUIRE(answer(R"({"id":7,"op":"perft","depth":9})") == R"({"id":7,"ok":false,"error":"perft needs a depth from 0 to 7"})");
+    REQUIRE(answer(R"({"id":8,"op":"legal","moves":["e2e5"]})") == R"({"id":8,"ok":false,"error":"illegal move e2e5"})");
+    REQUIRE(answer(R"({"id":9,"op":"legal","fen":"8/8/8 w"})") == R"({"id":9,"ok":false,"error":"bad FEN"})");
+    REQUIRE(answer(R"({"id":10,"op":"fly"})") == R"({"id":10,"ok":false,"error":"unknown op"})");
+    REQUIRE(contains(answer(R"({"id":11,"op":"perft","depth":-1})"), "non-negative"));
+    REQUIRE(contains(answer(R"({"op":"legal"} x)"), "trailing"));
+    REQUIRE(contains(answer(R"({"op":"legal",)"), "malformed"));
+}
+
+TEST_CASE("Latency percentiles") {
+    LatencyHistogram h;
+    REQUIRE(h.percentile(50) == 0);
+    for (int i = 0; i < 98; ++i) h.record(100);
+    h.record(5000);
+    h.record(5000);
+    REQUIRE(h.count() == 100);
+    REQUIRE(h.percentile(50) >= 100);
+    REQUIRE(h.percentile(50) <= 125);
+    REQUIRE(h.percentile(99) >= 5000);
+    REQUIRE(h.percentile(99) <= 6250);
+}
+
+TEST_CASE("Server answers over a socket") {
+    const auto path = (std::filesystem::temp_directory_path() / "tempo_server_test.sock").string();
+    ServerOptions options;
+    options.threads = 2;
+    options.maxBatch = 4;
+    AnalysisServer server(options);
+    REQUIRE(server.listenUnix(path));
+    std::thread serving([&] { server.serve(); });
+
+    const int fd = connectTo(path);
+
+    // Several requests in one write, the last split across two
+    std::string requests;
+    for (int depth = 1; depth <= 4; ++depth)
+        requests += R"({"id":)" + std::to_string(depth) + R"(,"op":"perft","depth":)" + std::to_string(depth) + "}\n";
+    requests += "not json\n{\"id\":9,\"op\":\"val";
+    REQUIRE(::send(fd, requests.data(), requests.size(), 0) == ssize_t(requests.size()));
+    const std::string rest = "idate\",\"moves\":\"e2e4\"}\n";
+    REQUIRE(::send(fd, rest.data(), rest.size(), 0) == ssize_t(rest.size()));
+
+    std::string received;
+    readLines(fd, received, 6);
+    REQUIRE(contains(received, R"({"id":1,"ok":true,"nodes":20})"));
+    REQUIRE(contains(received, R"({"id":4,"ok":true,"nodes":197281})"));
+    REQUIRE(contains(received, R"({"id":null,"ok":false,"error":"expected a JSON object"})"));
+    REQUIRE(contains(received, R"({"id":9,"ok":true,"valid":true,"applied":1})"));
+
+    received.clear();
+    const std::string stats = "{\"id\":\"s\",\"op\":\"stats\"}\n";
+    REQUIRE(::send(fd, stats.data(), stats.size(), 0) == ssize_t(stats.size()));
+    readLines(fd, received, 1);
+    REQUIRE(contains(received, R"({"id":"s","ok":true,"queue":0,"threads":2,)"));
+    REQUIRE(contains(received, R"("count":5,)"));
+    REQUIRE(contains(received, R"("perft":{"count":4,)"));
+    REQUIRE(contains(received, R"("validate":{"count":1,)"));
+
+    ::close(fd);
+    server.stop();
+    serving.join();
+}
+
+TEST_CASE("Server answers cheap requests around a deep one and caps its queue") {
+    const auto path = (std::filesystem::temp_directory_path() / "tempo_server_busy_test.sock").string();
+    const std::string deep = "{\"id\":1,\"op\":\"perft\",\"depth\":5}\n";
+    {
+        // The deep perft goes to one worker alone and the other answers the legal moves first
+        ServerOptions options;
+        options.threads = 2;
+        AnalysisServer server(options);
+        REQUIRE(server.listenUnix(path));
+        std::thread serving([&] { server.serve(); });
+        const int fd = connectTo(path);
+        const std::string requests = deep + "{\"id\":2,\"op\":\"legal\"}\n";
+        REQUIRE(::send(fd, requests.data(), requests.size(), 0) == ssize_t(requests.size()));
+        std::string received;
+        readLines(fd, received, 2);
+        REQUIRE(received.rfind("{\"id\":2,", 0) == 0);
+        REQUIRE(contains(received, R"({"id":1,"ok":true,"nodes":4865609})"));
+        ::close(fd);
+        server.stop();
+        serving.join();
+    }
+    {
+        // One worker busy with the deep perft, room for two more
+        ServerOptions options;
+        options.threads = 1;
+        options.maxQueue = 2;
+        AnalysisServer server(options);
+        REQUIRE(server.listenUnix(path));
+        std::thread serving([&] { server.serve(); });
+        const int fd = connectTo(path);
+        REQUIRE(::send(fd, deep.data(), deep.size(), 0) == ssize_t(deep.size()));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::string requests;
+        for (int id = 10; id < 16; ++id) requests += "{\"id\":" + std::to_string(id) + ",\"op\":\"legal\"}\n";
+        REQUIRE(::send(fd, requests.data(), requests.size(), 0) == ssize_t(requests.size()));
+        std::string received;
+        readLines(fd, received, 7);
+        REQUIRE(contains(received, R"("ok":false,"error":"busy"})"));
+        REQUIRE(contains(received, R"({"id":1,"ok":true,"nodes":4865609})"));
+        ::close(fd);
+        server.stop();
+        serving.join();
+    }
+}
@@ -0,0 +1,166 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "attacks.h"
+#include "board.h"
+#include "generator.h"
+#include "notation.h"
+#include <filesystem>
+
+static void place(Board& b, std::initializer_list<std::pair<Piece, const char*>> pieces, bool whiteToMove) {
+    b.bb = {};
+    for (auto [piece, square] : pieces) b.bb[to_u(piece)] |= 1ULL << squareFromName(square);
+    b.whiteToMove = whiteToMove;
+    b.castling = 0;
+    b.epSquare = NUM_SQUARES;
+    b.calcOcc();
+}
+
+TEST_CASE("Tablebase material names and index round trip") {
+    TBMaterial m;
+    REQUIRE(TBMaterial::parse("KRvKN", m));
+    REQUIRE(m.count == 4);
+    REQUIRE(m.name() == "KRvKN");
+    REQUIRE(m.entries() == 2 * 10 * 64 * 64 * 64);
+    REQUIRE(TBMaterial::parse("KPvKR", m));
+    REQUIRE(m.hasPawns());
+    REQUIRE(m.entries() == 2 * 32 * 64 * 64 * 64);
+    REQUIRE_FALSE(TBMaterial::parse("KQRvKRN", m));
+    REQUIRE(canonicalTableName(TBMaterial{ { Piece::WK, Piece::BK, Piece::BQ }, 3 }) == "KQvK");
+    REQUIRE(canonicalTableName(TBMaterial{ { Piece::WK, Piece::BK, Piece::WP, Piece::WQ }, 4 }) == "KQPvK");
+
+    // Mirror images share an index
+    REQUIRE(TBMaterial::parse("KQvK", m));
+    Board a = Board(), b = Board();
+    place(a, { { Piece::WK, "b6" }, { Piece::WQ, "h7" }, { Piece::BK, "a8" } }, true);
+    place(b, { { Piece::WK, "g3" }, { Piece::WQ, "a2" }, { Piece::BK, "h1" } }, true);
+    REQUIRE(m.indexOf(a, false) == m.indexOf(b, false));
+
+    // With pawns only the left-right mirror applies
+    REQUIRE(TBMaterial::parse("KPvK", m));
+    place(a, { { Piece::WK, "b6" }, { Piece::WP, "c5" }, { Piece::BK, "a8" } }, true);
+    place(b, { { Piece::WK, "g6" }, { Piece::WP, "f5" }, { Piece::BK, "h8" } }, true);
+    REQUIRE(m.indexOf(a, false) == m.indexOf(b, false));
+    place(b, { { Piece::WK, "b3" }, { Piece::WP, "c4" }, { Piece::BK, "a1" } }, true);
+    REQUIRE(m.indexOf(a, false) != m.indexOf(b, false));
+}
+
+TEST_CASE("Generated KQvK and KRvK tables") {
+    const auto dir = (std::filesystem::temp_directory_path() / "tempo_tb_test").string();
+    std::filesystem::create_directories(dir);
+    Tablebase tb;
+    REQUIRE(generateTable("KQvK", tb, { dir, 2, false }));
+    REQUIRE(generateTable("KRvK", tb, { dir, 2, false }));
+    REQUIRE(tb.has("KvK"));
+
+    Board b = Board();
+    TBResult r;
+
+    // Qa7# / Qb7#
+    place(b, { { Piece::WK, "b6" }, { Piece::WQ, "h7" }, { Piece::BK, "a8" } }, true);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == 1);
+    REQUIRE(r.dtm == 1);
+
+    // Same position with colors reversed goes through the KQvK table
+    place(b, { { Piece::BK, "b3" }, { Piece::BQ, "h2" }, { Piece::WK, "a1" } }, false);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == 1);
+    REQUIRE(r.dtm == 1);
+
+    // Black is mated
+    place(b, { { Piece::WK, "g6" }, { Piece::WR, "a8" }, { Piece::BK, "h8" } }, false);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == -1);
+    REQUIRE(r.dtm == 0);
+
+    // Black to move takes the hanging rook
+    place(b, { { Piece::WK, "a1" }, { Piece::WR, "g7" }, { Piece::BK, "h8" } }, false);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == 0);
+
+    // Reopening from disk gives the same answers
+    Tablebase disk;
+    REQUIRE(disk.openDirectory(dir) == 3);
+    place(b, { { Piece::WK, "b6" }, { Piece::WQ, "h7" }, { Piece::BK, "a8" } }, true);
+    REQUIRE(disk.probe(b, r));
+    REQUIRE(r.dtm == 1);
+
+    std::filesystem::remove_all(dir);
+}
+
+// The value every position should have given the values of the positions its moves reach
+static uint8_t valueFromMoves(const Tablebase& tb, Board& b) {
+    MoveList moves;
+    b.genLegalMoves(moves);
+    if (moves.empty())
+        return isSquareAttacked(b.bb, kingSquare(b.bb, b.whiteToMove), b.whiteToMove, b.occAll) ? tbValue(0) : TB_DRAW;
+    uint8_t best = TB_INVALID;
+    for (auto m : moves) {
+        uint8_t child;
+        b.move(m);
+        REQUIRE(tb.probeValue(b, child));
+        b.undoMove(m);
+        best = best == TB_INVALID ? tbParent(child) : tbBest(best, tbParent(child));
+    }
+    return best;
+}
+
+TEST_CASE("Generated KPvK table") {
+    const auto dir = (std::filesystem::temp_directory_path() / "tempo_tb_pawn_test").string();
+    std::filesystem::create_directories(dir);
+    Tablebase tb;
+    REQUIRE(generateTable("KPvK", tb, { dir, 2, false }));
+    for (auto name : { "KvK", "KQvK", "KRvK", "KBvK", "KNvK" }) REQUIRE(tb.has(name));
+
+    Board b = Board();
+    TBResult r;
+
+    // The pawn runs: a7, a8=Q and mate
+    place(b, { { Piece::WK, "c1" }, { Piece::WP, "a6" }, { Piece::BK, "h8" } }, true);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == 1);
+
+    // Black takes the pawn
+    place(b, { { Piece::WK, "h1" }, { Piece::WP, "e3" }, { Piece::BK, "d3" } }, false);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == 0);
+
+    // Rook pawn with the defending king in the corner
+    place(b, { { Piece::WK, "b6" }, { Piece::WP, "a6" }, { Piece::BK, "a8" } }, false);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == 0);
+
+    // Colors reversed, and castling rights, which the tables do not hold
+    place(b, { { Piece::BK, "c8" }, { Piece::BP, "a3" }, { Piece::WK, "h1" } }, false);
+    REQUIRE(tb.probe(b, r));
+    REQUIRE(r.wdl == 1);
+    place(b, { { Piece::WK, "e1" }, { Piece::WP, "a6" }, { Piece::BK, "h8" } }, true);
+    REQUIRE(tb.probe(b, r));
+    b.castling = to_u(Castling::W_K);
+    REQUIRE_FALSE(tb.probe(b, r));
+
+    // Every position agrees with its moves
+    TBMaterial m;
+    REQUIRE(TBMaterial::parse("KPvK", m));
+    uint8_t squares[TB_MAX_PIECES];
+    bool whiteToMove;
+    size_t checked = 0;
+    for (size_t index = 0; index < m.entries(); index += 7) {
+        m.decode(index, squares, whiteToMove);
+        if (squares[0] == squares[1] || squares[0] == squares[2] || squares[1] == squares[2]) continue;
+        place(b, {}, whiteToMove);
+        for (uint8_t i = 0; i < m.count; ++i) b.bb[to_u(m.pieces[i])] |= 1ULL << squares[i];
+        b.calcOcc();
+        uint8_t value;
+        REQUIRE(tb.probeValue(b, value));
+        if (value == TB_INVALID) continue;
+        REQUIRE(value == valueFromMoves(tb, b));
+        ++checked;
+    }
+    REQUIRE(checked > 10000);
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,87 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "perft.h"
+#include "threadpool.h"
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+using Cpus = std::vector<unsigned>;
+
+TEST_CASE("CPU lists and topology from sysfs") {
+    REQUIRE(parseCpuList("0-3,8,10-11\n") == Cpus{ 0, 1, 2, 3, 8, 10, 11 });
+    REQUIRE(parseCpuList("5") == Cpus{ 5 });
+    REQUIRE(parseCpuList("3-1").empty());
+    REQUIRE(parseCpuList("1,x").empty());
+
+    // A two socket machine with hyperthreads numbered after the cores
+    const auto root = std::filesystem::temp_directory_path() / "tempo_topology_test";
+    std::filesystem::remove_all(root);
+    const auto write = [&](const std::string& dir, const std::string& cpulist) {
+        std::filesystem::create_directories(root / "node" / dir);
+        std::ofstream(root / "node" / dir / "cpulist") << cpulist << '\n';
+    };
+    write("node1", "4-7,12-15");
+    write("node0", "0-3,8-11");
+    write("node2", ""); // memory only
+    std::filesystem::create_directories(root / "node" / "power");
+
+    const CpuTopology topology = CpuTopology::detect(root.string());
+    REQUIRE(topology.nodes.size() == 2);
+    REQUIRE(topology.nodes[0].id == 0);
+    REQUIRE(topology.nodes[0].cpus == Cpus{ 0, 1, 2, 3, 8, 9, 10, 11 });
+    REQUIRE(topology.nodes[1].id == 1);
+    REQUIRE(topology.cpuCount() == 16);
+
+    // Workers fill node 0 before node 1; unpinned, so this runs anywhere
+    ThreadPool pool(10, topology, false);
+    REQUIRE(pool.size() == 10);
+    REQUIRE(pool.nodesUsed() == 2);
+    REQUIRE(pool.nodeOf(7) == 0);
+    REQUIRE(pool.nodeOf(8) == 1);
+    REQUIRE(pool.cpuOf(0) == -1);
+
+    std::filesystem::remove_all(root);
+    const CpuTopology none = CpuTopology::detect(root.string());
+    REQUIRE(none.nodes.size() == 1);
+    REQUIRE(none.cpuCount() == 1);
+}
+
+TEST_CASE("Thread pool runs every item and every worker once") {
+    ThreadPool pool(3);
+    REQUIRE(pool.size() == 3);
+    REQUIRE(pool.nodesUsed() >= 1);
+
+    std::vector<int> ran(pool.size());
+    pool.onEachWorker([&](unsigned w) { ++ran[w]; });
+    REQUIRE(ran == std::vector<int>(pool.size(), 1));
+
+    std::vector<std::atomic<int>> hits(1000);
+    for (int round = 0; round < 3; ++round)
+        pool.forEach(hits.size(), [&](unsigned, size_t i) { hits[i].fetch_add(1); });
+    REQUIRE(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h.load() == 3; }));
+
+    // One copy per node in use, built on that node
+    NodeReplicated<std::vector<uint64_t>> table(pool, [] { return std::vector<uint64_t>(1 << 12, 7); });
+    uint64_t sum = 0;
+    for (unsigned w = 0; w < pool.size(); ++w) sum += std::accumulate(table.forWorker(w).begin(), table.forWorker(w).end(), uint64_t(0));
+    REQUIRE(sum == pool.size() * 7ULL * (1 << 12));
+}
+
+TEST_CASE("Parallel perft matches perft") {
+    ThreadPool pool(4);
+    Board b = Board();
+    REQUIRE(b.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+    std::vector<uint64_t> perWorker;
+    REQUIRE(ParallelPerft(b, 3, pool, &perWorker) == 97862);
+    REQUIRE(std::accumulate(perWorker.begin(), perWorker.end(), uint64_t(0)) == 97862);
+    REQUIRE(ParallelPerft(b, 2, pool) == 2039);
+    REQUIRE(b.getKey() == b.computeKey());
+
+    Board start = Board();
+    REQUIRE(ParallelPerft(start, 4, pool) == 197281);
+}
@@ -0,0 +1,125 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "tuner.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+// Positions from seeded random games, each at a random length
+static std::vector<Board> randomPositions(size_t count) {
+    std::mt19937_64 rng(7);
+    std::vector<Board> positions;
+    while (positions.size() < count) {
+        Board b = Board();
+        const size_t plies = 10 + rng() % 60;
+        for (size_t ply = 0; ply < plies; ++ply) {
+            MoveList moves;
+            b.genLegalMoves(moves);
+            if (moves.size() == 0) break;
+            b.move(moves[rng() % moves.size()]);
+        }
+        positions.push_back(b);
+    }
+    return positions;
+}
+
+TEST_CASE("Tuning sets hold the eval's features") {
+    const auto positions = randomPositions(1500);
+    const auto path = (std::filesystem::temp_directory_path() / "tempo_tuner_test.bin").string();
+    TuningSet fromBoards, fromRecords;
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        REQUIRE(file);
+        for (const auto& b : positions) {
+            fromBoards.add(b, 1, 17);
+            TrainingRecord record;
+            REQUIRE(packRecord(b, 17, 1, record));
+            REQUIRE(std::fwrite(&record, sizeof record, 1, file) == 1);
+        }
+        // Corrupt records: piece codes 12-15, which would index past the weights, and a square
+        // dropped from the occupancy, which shifts every later code (a black pawn onto h8)
+        TrainingRecord record;
+        REQUIRE(packRecord(positions[0], 0, 1, record));
+        record.pieces[3] = 0xFF;
+        REQUIRE(std::fwrite(&record, sizeof record, 1, file) == 1);
+        REQUIRE(packRecord(Board(), 0, 1, record));
+        record.occupancy &= ~(1ULL << e1);
+        REQUIRE(std::fwrite(&record, sizeof record, 1, file) == 1);
+        std::fclose(file);
+    }
+    uint64_t skippedRecords = 0;
+    REQUIRE(fromRecords.loadRecords(path, &skippedRecords));
+    REQUIRE(skippedRecords == 2);
+    std::filesystem::remove(path);
+    REQUIRE(fromBoards.size() == positions.size());
+    REQUIRE(fromRecords.size() == positions.size());
+    REQUIRE(fromBoards.blocks() == 2);
+
+    for (size_t p = 0; p < positions.size(); p += 37) {
+        const int white = positions[p].whiteToMove ? evaluate(positions[p]) : -evaluate(positions[p]);
+        REQUIRE(fromBoards.evaluate(p, defaultEvalWeights()) == white);
+        REQUIRE(fromRecords.evaluate(p, defaultEvalWeights()) == white);
+    }
+
+    // Text labels, FEN with a bracketed result or EPD with c9
+    const auto text = (std::filesystem::temp_directory_path() / "tempo_tuner_test.epd").string();
+    std::ofstream(text) << "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 [0.5]\n"
+                           "4k3/8/8/8/8/8/8/3QK3 b - - [1-0]\n"
+                           "4k3/8/8/8/8/8/8/3qK3 w - - c9 \"0-1\"; id \"x\";\n"
+                           "\n"
+                           "4k3/8/8/8/8/8/8/3qK3 w - - id \"no result\";\n"
+                           "not a position [1.0]\n";
+    TuningSet labeled;
+    uint64_t skipped = 0;
+    REQUIRE(labeled.loadText(text, &skipped));
+    std::filesystem::remove(text);
+    REQUIRE(labeled.size() == 3);
+    REQUIRE(skipped == 2);
+    REQUIRE(labeled.evaluate(0, defaultEvalWeights()) == 0);
+    REQUIRE(labeled.evaluate(1, defaultEvalWeights()) > 800);
+    REQUIRE(labeled.evaluate(2, defaultEvalWeights()) < -800);
+}
+
+TEST_CASE("Tuning recovers the weights that scored the positions") {
+    // Scores from a knight worth 450 rather than 320; with lambda 0 the targets are those scores
+    EvalWeights truth = defaultEvalWeights();
+    truth.material[2] = 450;
+    TuningSet set;
+    for (const auto& b : randomPositions(6000)) {
+        const int white = b.whiteToMove ? evaluate(b, truth) : -evaluate(b, truth);
+        set.add(b, white > 0 ? 2 : white < 0 ? 0 : 1, int16_t(white));
+    }
+
+    ThreadPool pool(3, CpuTopology::detect(), false);
+    TunerOptions options;
+    options.lambda = 0;
+    options.scale = 1;
+    options.batchSize = 2048;
+    options.learningRate = 2;
+    Tuner tuner(set, pool, defaultEvalWeights(), options);
+    REQUIRE(tuner.scale() == 1);
+    REQUIRE(tuner.weights().material == defaultEvalWeights().material); // untouched until a step
+    REQUIRE(tuner.weights().pst == defaultEvalWeights().pst);
+    const double before = tuner.error();
+    double last = before;
+    for (int e = 0; e < 30; ++e) last = tuner.epoch();
+    REQUIRE(last < before / 2);
+    REQUIRE(tuner.error() < before / 2);
+
+    const EvalWeights tuned = tuner.weights();
+    REQUIRE(std::abs(tuned.material[2] - 450) < std::abs(320 - 450) / 2);
+    REQUIRE(tuned.material[5] == 0);
+
+    // With the scale left to fit, K comes out positive and the error does not grow
+    Tuner fitted(set, pool);
+    REQUIRE(fitted.scale() > 0);
+    const double start = fitted.error();
+    fitted.epoch();
+    REQUIRE(fitted.error() <= start);
+}
@@ -0,0 +1,88 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "catch.hpp"
+#include "board.h"
+#include "notation.h"
+#include "search.h"
+#include "uci.h"
+#include <chrono>
+#include <thread>
+
+TEST_CASE("FEN start position matches the default board") {
+    Board a = Board();
+    Board b = Board();
+    REQUIRE(b.setFromFEN(START_FEN));
+    REQUIRE(a.bb == b.bb);
+    REQUIRE(b.castling == 0x0F);
+    REQUIRE(b.epSquare == NUM_SQUARES);
+    REQUIRE(b.computeKey() == b.getKey());
+
+    REQUIRE_FALSE(b.setFromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1"));
+    REQUIRE_FALSE(b.setFromFEN("8/8/8/8/8/8/8/8 w - - 0 1")); // no kings
+    REQUIRE(b.bb == a.bb);
+}
+
+TEST_CASE("Incremental key matches a full recomputation") {
+    Board b = Board();
+    REQUIRE(b.setFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"));
+    for (auto uci : { "e1g1", "b4c3", "d2c3", "e8c8", "a2a4", "h3g2", "g1g2" }) {
+        const uint32_t m = moveFromUCI(b, uci);
+        REQUIRE(m != Move::NONE);
+        b.move(m);
+        REQUIRE(b.getKey() == b.computeKey());
+    }
+}
+
+TEST_CASE("Search finds a back rank mate") {
+    Board b = Board();
+    REQUIRE(b.setFromFEN("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1"));
+    Search search;
+    int lastScore = 0;
+    const uint32_t best = search.think(b, SearchLimits{ .depth = 3 }, [&](const SearchReport& r) { lastScore = r.score; });
+    REQUIRE(moveToUCI(best) == "a1a8");
+    REQUIRE(lastScore == SCORE_MATE - 1);
+    REQUIRE(b.computeKey() == b.getKey()); // board restored
+}
+
+TEST_CASE("Search respects the node limit") {
+    Board b = Board();
+    Search search;
+    REQUIRE(search.think(b, SearchLimits{ .nodes = 500 }) != Move::NONE);
+    REQUIRE(search.nodes() <= 500);
+}
+
+TEST_CASE("UCI handshake and depth limited go") {
+    std::istringstream in;
+    std::ostringstream out;
+    {
+        UCI uci(in, out);
+        REQUIRE(uci.execute("uci"));
+        REQUIRE(uci.execute("isready"));
+        REQUIRE(uci.execute("position startpos moves e2e4 e7e5"));
+        REQUIRE(uci.execute("go depth 2"));
+        REQUIRE(uci.execute("isready"));
+        REQUIRE_FALSE(uci.execute("quit"));
+    }
+    const std::string s = out.str();
+    REQUIRE(s.find("uciok") != std::string::npos);
+    REQUIRE(s.find("readyok") != std::string::npos);
+    REQUIRE(s.find("bestmove ") != std::string::npos);
+}
+
+TEST_CASE("UCI stop ends an infinite search promptly") {
+    std::istringstream in;
+    std::ostringstream out;
+    UCI uci(in, out);
+    uci.execute("position startpos");
+    uci.execute("go infinite");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(out.str().find("bestmove") == std::string::npos); // held until stop
+
+    const auto t0 = std::chrono::steady_clock::now();
+    uci.execute("stop"); // returns once bestmove has been sent
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+    REQUIRE(out.str().find("bestmove") != std::string::npos);
+    REQUIRE(ms < 20);
+}
@@ -0,0 +1,57 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "board.h"
+#include "notation.h"
+#include "polyglot.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Builds a Polyglot book from a text stream of games, one game per line:
+//   e2e4 e7e5 g1f3 b8c6 1-0
+// The trailing result (1-0, 0-1, 1/2-1/2, *) is optional and treated as a draw when missing.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: BookBuilder <games.txt|-> <out.bin> [maxPly]" << std::endl;
+        return 1;
+    }
+    const std::string inPath = argv[1], outPath = argv[2];
+    const size_t maxPly = argc > 3 ? std::stoul(argv[3]) : 40;
+
+    std::ifstream file;
+    if (inPath != "-") file.open(inPath);
+    std::istream& in = inPath == "-" ? std::cin : file;
+    if (!in) { std::cerr << "could not open " << inPath << std::endl; return 1; }
+
+    Board board = Board();
+    PolyglotBookBuilder builder;
+    std::vector<uint32_t> moves;
+    std::string line, token;
+    size_t games = 0, skipped = 0;
+
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        moves.clear();
+        int result = 0;
+        bool ok = true;
+        while (tokens >> token) {
+            if (token == "1-0") { result = 1; break; }
+            if (token == "0-1") { result = -1; break; }
+            if (token == "1/2-1/2" || token == "*") break;
+            uint32_t m = moveFromUCI(board, token);
+            if (m == Move::NONE) { ok = false; break; }
+            moves.push_back(m);
+            board.move(m);
+        }
+        for (size_t i = moves.size(); i > 0; --i) board.undoMove(moves[i - 1]);
+        if (moves.empty()) continue;
+        if (!ok || !builder.addGame(board, moves, result, maxPly)) { ++skipped; continue; }
+        ++games;
+    }
+
+    if (!builder.write(outPath)) { std::cerr << "could not write " << outPath << std::endl; return 1; }
+    std::cout << games << " games, " << skipped << " skipped, " << builder.size() << " entries" << std::endl;
+    return 0;
+}
@@ -0,0 +1,38 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "training.h"
+#include <iostream>
+
+// Generates labeled positions from self-play, e.g. `DataGen -p 100000000 -n 5000 -o data/run1`.
+// Records are the 32-byte TrainingRecord of training.h, written to <prefix>-<worker>-<n>.bin.
+int main(int argc, char** argv) {
+    const auto usage = [] {
+        std::cerr << "usage: DataGen [-p positions] [-o prefix] [-s shardSize] [-t threads] [-d depth | -n nodes] "
+                     "[-r randomPlies] [-seed n] [-dedup MB]" << std::endl;
+        return 1;
+    };
+    DataGenOptions options;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) return usage();
+        const std::string arg = argv[i], value = argv[i + 1];
+        if (arg == "-p") options.positions = std::stoull(value);
+        else if (arg == "-o") options.prefix = value;
+        else if (arg == "-s") options.shardSize = std::max<uint64_t>(1, std::stoull(value));
+        else if (arg == "-t") options.threads = std::stoul(value);
+        else if (arg == "-d") { options.limits.depth = std::stoi(value); options.limits.nodes = 0; }
+        else if (arg == "-n") options.limits.nodes = std::stoull(value);
+        else if (arg == "-r") options.randomPlies = std::stoul(value);
+        else if (arg == "-seed") options.seed = std::stoull(value);
+        else if (arg == "-dedup") options.dedupMB = std::stoul(value);
+        else return usage();
+    }
+
+    const DataGenStats stats = generateData(options);
+    if (stats.writeFailed) std::cerr << "cannot write shards to " << options.prefix << ", stopped" << std::endl;
+    std::cout << "positions " << stats.positions << " from " << stats.games << " games, " << stats.duplicates
+              << " duplicates, " << stats.filtered << " filtered in " << int(stats.seconds) << " s: "
+              << uint64_t(stats.positions / stats.seconds) << " positions/s on " << options.threads << " threads" << std::endl;
+    return stats.writeFailed ? 1 : 0;
+}
@@ -0,0 +1,222 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "training.h"
+#include "largepages.h"
+#include "match.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+bool packRecord(const Board& board, int whiteScore, uint8_t result, TrainingRecord& out) {
+    if (std::popcount(board.occAll) > 32) return false;
+    out = {};
+    out.occupancy = board.occAll;
+    size_t i = 0;
+    forEachSetBit(board.occAll, [&](uint8_t square) {
+        uint8_t code = 0;
+        while (!(board.bb[code] & (1ULL << square))) ++code;
+        out.pieces[i / 2] |= code << (i % 2 * 4);
+        ++i;
+    });
+    out.score = int16_t(std::clamp(whiteScore, -SCORE_INF, SCORE_INF));
+    out.result = result;
+    out.blackToMove = !board.whiteToMove;
+    out.epSquare = board.epSquare;
+    out.castling = board.castling;
+    out.halfMoveClock = uint8_t(std::min<int>(board.halfMoveClock, 255));
+    return true;
+}
+
+bool isValidRecord(const TrainingRecord& record) {
+    if (std::popcount(record.occupancy) > 32 || record.result > 2 || record.blackToMove > 1) return false;
+    Bitboards bb{};
+    size_t i = 0;
+    bool codes = true;
+    forEachSetBit(record.occupancy, [&](uint8_t square) {
+        const uint8_t code = (record.pieces[i / 2] >> (i % 2 * 4)) & 0xF;
+        if (code < bb.size()) bb[code] |= 1ULL << square;
+        else codes = false;
+        ++i;
+    });
+    return codes && Board::isValidPosition(bb, !record.blackToMove, record.castling, record.epSquare);
+}
+
+void unpackRecord(const TrainingRecord& record, Board& board) {
+    board.bb = {};
+    size_t i = 0;
+    forEachSetBit(record.occupancy, [&](uint8_t square) {
+        board.bb[(record.pieces[i / 2] >> (i % 2 * 4)) & 0xF] |= 1ULL << square;
+        ++i;
+    });
+    board.calcOcc();
+    board.whiteToMove = !record.blackToMove;
+    board.epSquare = record.epSquare;
+    board.castling = record.castling;
+    board.halfMoveClock = record.halfMoveClock;
+    board.fullMoveTotal = 1;
+    board.pliesFromNull = 0;
+    board.gameRecord.clear();
+    board.key = board.computeKey();
+}
+
+namespace {
+
+// Keys of the positions written so far, shared by the workers: open addressing over a huge-page
+// table. A key whose neighbourhood is full gets through, so a full table only lets duplicates in.
+class KeyFilter {
+public:
+    explicit KeyFilter(size_t mb) : table(std::max<size_t>(mb, 1) << 20), slots(table.size() / sizeof(uint64_t)) {}
+
+    // false if key was seen before
+    bool insert(uint64_t key) {
+        static constexpr size_t PROBES = 8;
+        if (key == 0) key = 1; // 0 marks an empty slot
+        size_t i = static_cast<size_t>((static_cast<unsigned __int128>(key) * slots) >> 64);
+        for (size_t probe = 0; probe < PROBES; ++probe, i = i + 1 == slots ? 0 : i + 1) {
+            std::atomic_ref<uint64_t> slot(table.as<uint64_t>()[i]);
+            uint64_t seen = slot.load(std::memory_order_relaxed);
+            if (seen == 0 && slot.compare_exchange_strong(seen, key, std::memory_order_relaxed)) return true;
+            if (seen == key) return false;
+        }
+        return true;
+    }
+
+private:
+    LargeAllocation table;
+    size_t slots;
+};
+
+// Buffered writer for one worker's shards
+class ShardWriter {
+public:
+    ShardWriter(const DataGenOptions& options, unsigned worker) : options(options), worker(worker) {
+        buffer.reserve(BUFFERED);
+    }
+    // Whatever was not flushed is dropped: the owner flushes and checks
+    ~ShardWriter() { if (file) std::fclose(file); }
+
+    // Buffers the record, writing the buffer out once full; false once a write has failed
+    bool add(const TrainingRecord& record) {
+        if (failed) return false;
+        buffer.push_back(record);
+        return buffer.size() < BUFFERED || flush();
+    }
+
+    // Writes out the buffered records, each shard flushed to the OS before they count as written
+    bool flush() {
+        for (size_t done = 0; done < buffer.size() && !failed;) {
+            if (!file || inShard == options.shardSize) {
+                if (file && std::fclose(file) != 0) failed = true;
+                const std::string path = options.prefix + "-" + std::to_string(worker) + "-" + std::to_string(shard++) + ".bin";
+                file = failed ? nullptr : std::fopen(path.c_str(), "wb");
+                inShard = 0;
+                if (!file) { failed = true; break; }
+            }
+            const size_t n = std::min<size_t>(buffer.size() - done, options.shardSize - inShard);
+            if (std::fwrite(buffer.data() + done, sizeof(TrainingRecord), n, file) != n || std::fflush(file) != 0) {
+                failed = true;
+                break;
+            }
+            done += n;
+            inShard += n;
+            written += n;
+        }
+        if (!failed) buffer.clear();
+        return !failed;
+    }
+
+    uint64_t recordsWritten() const { return written; }
+
+private:
+    static constexpr size_t BUFFERED = 1 << 15; // 1 MB of records per write
+
+    const DataGenOptions& options;
+    unsigned worker;
+    std::vector<TrainingRecord> buffer;
+    std::FILE* file = nullptr;
+    uint64_t inShard = 0;
+    uint64_t written = 0;
+    size_t shard = 0;
+    bool failed = false;
+};
+
+}
+
+DataGenStats generateData(const DataGenOptions& options) {
+    const unsigned threads = std::max(1u, options.threads);
+    const auto begin = std::chrono::steady_clock::now();
+    KeyFilter seen(options.dedupMB);
+    std::atomic<uint64_t> nextGame{0}, written{0};
+    std::atomic<bool> done{false};
+    std::vector<DataGenStats> partial(threads);
+    std::vector<std::thread> pool;
+
+    MatchOptions match;
+    match.maxPlies = options.maxPlies;
+    match.randomPlies = options.randomPlies;
+
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            Board board = Board();
+            const MoveSelector select = searchSelector(options.limits)(t);
+            ShardWriter writer(options, t);
+            GameRecord game;
+            TrainingRecord record;
+            DataGenStats& stats = partial[t];
+
+            while (!done.load(std::memory_order_relaxed)) {
+                game.index = (options.seed << 32) + nextGame.fetch_add(1);
+                game.opening = START_FEN;
+                playGame(board, game, select, match);
+                ++stats.games;
+                const uint8_t result = game.result == GameResult::WhiteWins ? 2 : game.result == GameResult::BlackWins ? 0 : 1;
+
+                // Replay the game and sample every position after the random opening
+                board.setFromFEN(game.opening);
+                for (size_t ply = 0; ply < game.moves.size() && !done.load(std::memory_order_relaxed); ++ply) {
+                    const uint32_t m = game.moves[ply];
+                    const int score = game.scores[ply];
+                    if (ply >= options.randomPlies) {
+                        if (board.inCheck() || Move::isCapture(m) || Move::promo(m) != Move::PROMO_MASK ||
+                            std::abs(score) > options.maxScore) {
+                            ++stats.filtered;
+                        } else if (!seen.insert(board.getKey())) {
+                            ++stats.duplicates;
+                        } else if (written.fetch_add(1) >= options.positions) {
+                            done.store(true, std::memory_order_relaxed);
+                        } else {
+                            packRecord(board, board.whiteToMove ? score : -score, result, record);
+                            if (!writer.add(record)) {
+                                stats.writeFailed = true;
+                                done.store(true, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                    board.move(m);
+                }
+            }
+            if (!stats.writeFailed && !writer.flush()) {
+                stats.writeFailed = true;
+                done.store(true, std::memory_order_relaxed);
+            }
+            stats.positions = writer.recordsWritten();
+        });
+    for (auto& thread : pool) thread.join();
+
+    DataGenStats total;
+    for (const auto& s : partial) {
+        total.games += s.games;
+        total.positions += s.positions;
+        total.duplicates += s.duplicates;
+        total.filtered += s.filtered;
+        total.writeFailed |= s.writeFailed;
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return total;
+}
@@ -0,0 +1,70 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_TRAINING_H
+#define TEMPO_TRAINING_H
+
+#include "board.h"
+#include "search.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// One labeled position, 32 bytes on disk in host byte order:
+//   occupancy, then a 4-bit piece code per occupied square in ascending square order (at most 32)
+//   score from white's point of view, result from white's point of view (0 loss, 1 draw, 2 win),
+//   side to move, en passant square (NUM_SQUARES for none), castling rights, halfmove clock
+struct TrainingRecord {
+    uint64_t occupancy;
+    std::array<uint8_t, 16> pieces;
+    int16_t score;
+    uint8_t result;
+    uint8_t blackToMove;
+    uint8_t epSquare;
+    uint8_t castling;
+    uint8_t halfMoveClock;
+    uint8_t reserved;
+};
+static_assert(sizeof(TrainingRecord) == 32);
+
+// result is 0, 1 or 2 as above; false if the position has more than 32 pieces
+bool packRecord(const Board& board, int whiteScore, uint8_t result, TrainingRecord& out);
+// Whether a record read from outside holds a position: at most 32 real piece codes, a result of
+// 0 to 2, and a position Board::isValidPosition accepts
+bool isValidRecord(const TrainingRecord& record);
+// Sets board to the record's position, with an empty history; the record is trusted, so one that
+// did not come from packRecord is checked with isValidRecord first
+void unpackRecord(const TrainingRecord& record, Board& board);
+
+struct DataGenOptions {
+    std::string prefix = "data";   // shards are written as <prefix>-<worker>-<n>.bin
+    uint64_t positions = 1'000'000; // stop once this many records are written
+    uint64_t shardSize = 10'000'000; // records per shard file
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    SearchLimits limits { .nodes = 5000 }; // labels every move played, from the mover's search
+    size_t randomPlies = 8;          // random opening moves, never sampled
+    size_t maxPlies = 400;
+    uint64_t seed = 0;               // picks the random openings, change it for a different data set
+    size_t dedupMB = 256;            // keys already written, in a lossy shared table
+    int maxScore = 3000;             // positions scored beyond this are dropped, mates included
+};
+
+struct DataGenStats {
+    uint64_t games = 0;
+    uint64_t positions = 0;  // written to a shard
+    uint64_t duplicates = 0; // skipped as already written
+    uint64_t filtered = 0;   // skipped as in check, not quiet, or decided
+    bool writeFailed = false; // a shard could not be written, generation stopped there
+    double seconds = 0;
+};
+
+// Plays seeded randomized self-play games on every worker and samples their positions: those in
+// check, those where the move played captures or promotes, and those scored past maxScore are
+// dropped, the rest are labeled with the score the search gave them and the game's result. Each
+// worker buffers its records and writes its own shards; the position budget is shared. The first
+// write that fails stops every worker, and records that never reached a shard are not counted.
+DataGenStats generateData(const DataGenOptions& options);
+
+#endif //TEMPO_TRAINING_H
@@ -0,0 +1,91 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "notation.h"
+#include "positionindex.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// Builds and queries a position index over PGN collections or SelfPlay game files, e.g.
+//   KeyIndex build -t 8 -m 2048 -o corpus.tki a.pgn b.pgn
+//   KeyIndex build -P -b openings.txt -o selfplay.tki games.bin
+//   KeyIndex query corpus.tki startpos e2e4 c7c5
+//   KeyIndex query corpus.tki "<fen>"
+// A query prints one line per game that reached the position, `<game offset> <ply>`, in file order.
+// Offsets in later files count on from the end of the earlier ones. Packed games (-P) are replayed
+// from the openings they were played from, so -b must name SelfPlay's openings file, if it had one.
+int main(int argc, char** argv) {
+    const auto usage = [] {
+        std::cerr << "usage: KeyIndex build [-t threads] [-m MB] [-T tempdir] [-P [-b openings.txt]] -o index.tki games...\n"
+                     "       KeyIndex query index.tki startpos|<fen> [uci moves...]" << std::endl;
+        return 1;
+    };
+    const std::string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "build") {
+        IndexBuildOptions options;
+        std::string outPath;
+        std::vector<std::string> inputs;
+        std::string openingsPath;
+        for (int i = 2; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "-t" && i + 1 < argc) options.threads = std::stoul(argv[++i]);
+            else if (arg == "-m" && i + 1 < argc) options.memoryBytes = std::stoull(argv[++i]) << 20;
+            else if (arg == "-T" && i + 1 < argc) options.tempDir = argv[++i];
+            else if (arg == "-o" && i + 1 < argc) outPath = argv[++i];
+            else if (arg == "-b" && i + 1 < argc) openingsPath = argv[++i];
+            else if (arg == "-P") options.packed = true;
+            else inputs.push_back(arg);
+        }
+        if (outPath.empty() || inputs.empty() || (!openingsPath.empty() && !options.packed)) return usage();
+        if (!openingsPath.empty()) {
+            std::ifstream in(openingsPath);
+            if (!in) { std::cerr << "could not open " << openingsPath << std::endl; return 1; }
+            for (std::string line; std::getline(in, line);)
+                if (!line.empty()) options.openings.push_back(line);
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        IndexBuildStats stats;
+        if (!buildPositionIndex(inputs, outPath, options, stats)) {
+            std::cerr << "index build failed (unreadable input or write error)" << std::endl;
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "games " << stats.games << " failed " << stats.failed << " positions " << stats.entries
+                  << " runs " << stats.runs << " in " << int(seconds * 1000) << " ms" << std::endl;
+        return 0;
+    }
+
+    if (mode == "query" && argc >= 4) {
+        PositionIndex index;
+        if (!index.open(argv[2])) {
+            std::cerr << "cannot open " << argv[2] << " (written with other keys or format?)" << std::endl;
+            return 1;
+        }
+        Board board = Board();
+        const std::string fen = argv[3];
+        if (fen != "startpos" && !board.setFromFEN(fen)) {
+            std::cerr << "bad FEN: " << fen << std::endl;
+            return 1;
+        }
+        for (int i = 4; i < argc; ++i) {
+            const uint32_t m = moveFromUCI(board, argv[i]);
+            if (m == Move::NONE) {
+                std::cerr << "illegal move " << argv[i] << std::endl;
+                return 1;
+            }
+            board.move(m);
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        const auto found = index.find(board.getKey());
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+        for (const auto& entry : found) std::cout << entry.game() << ' ' << entry.ply() << '\n';
+        std::cout << found.size() << " hits among " << index.games() << " games in " << us << " us" << std::endl;
+        return 0;
+    }
+    return usage();
+}
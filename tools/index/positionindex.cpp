@@ -0,0 +1,340 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "positionindex.h"
+#include "board.h"
+#include "match.h"
+#include "pgn.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr size_t MAX_READ_BUFFER = 1 << 16; // entries per run during the merge
+
+static IndexHeader makeHeader(uint64_t entries, uint64_t games) {
+    const auto& keys = zobristKeys();
+    IndexHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version = INDEX_VERSION;
+    header.entrySize = sizeof(IndexEntry);
+    header.zobristSeed = keys.seed;
+    header.zobristFingerprint = keys.fingerprint();
+    header.entries = entries;
+    header.games = games;
+    return header;
+}
+
+namespace {
+
+// Streams one sorted run back in blocks
+struct RunReader {
+    std::FILE* file = nullptr;
+    std::vector<IndexEntry> block;
+    size_t pos = 0, length = 0;
+
+    RunReader(const std::string& path, size_t blockEntries) : file(std::fopen(path.c_str(), "rb")), block(blockEntries) {}
+    ~RunReader() { if (file) std::fclose(file); }
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    bool next(IndexEntry& out) {
+        if (pos == length) {
+            length = file ? std::fread(block.data(), sizeof(IndexEntry), block.size(), file) : 0;
+            pos = 0;
+            if (length == 0) return false;
+        }
+        out = block[pos++];
+        return true;
+    }
+};
+
+// What a replay thread keeps for one input file
+struct ThreadState {
+    Board board = Board();
+    std::vector<IndexEntry> entries;
+};
+
+}
+
+// Memory-maps a file of packed games and unpacks each, from the opening its index picks, on
+// threads workers. The records are walked once for their offsets, which the workers then claim in
+// chunks; sink sees every game that replays, with its record's offset. A record cut short at the
+// end of the file counts as a failed game. False if the file cannot be mapped.
+static bool replayPackedFile(const std::string& path, unsigned threads, const std::vector<std::string>& openings,
+                             const std::function<void(uint64_t offset, const GameRecord&)>& sink, PgnStats& stats) {
+    stats = {};
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    const std::string_view data(static_cast<const char*>(map), st.st_size);
+
+    std::vector<uint64_t> offsets;
+    size_t pos = 0;
+    for (PackedGameHeader header; data.size() - pos >= sizeof header;) {
+        std::memcpy(&header, data.data() + pos, sizeof header);
+        const size_t bytes = sizeof header + header.plies * sizeof(uint16_t);
+        if (data.size() - pos < bytes) break;
+        offsets.push_back(pos);
+        pos += bytes;
+    }
+
+    std::atomic<size_t> next{0}, failed{0};
+    const size_t chunk = std::clamp<size_t>(offsets.size() / (threads * 16), 1, 1024);
+    const auto work = [&] {
+        GameRecord game;
+        for (size_t begin; (begin = next.fetch_add(chunk)) < offsets.size();)
+            for (size_t i = begin, end = std::min(offsets.size(), begin + chunk); i < end; ++i) {
+                std::string_view record = data.substr(offsets[i]);
+                PackedGameHeader header;
+                std::memcpy(&header, record.data(), sizeof header);
+                const std::string_view opening =
+                    openings.empty() ? START_FEN : std::string_view(openings[header.index % openings.size()]);
+                if (unpackGame(record, opening, game)) sink(offsets[i], game);
+                else ++failed;
+            }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto& thread : pool) thread.join();
+    munmap(map, st.st_size);
+
+    stats.games = offsets.size() + (pos != data.size());
+    stats.failed = failed + (pos != data.size());
+    stats.bytes = data.size();
+    return true;
+}
+
+// k-way merge of sorted runs into out, memoryBytes shared out as their read blocks. False on a
+// run that cannot be opened or a failed write.
+static bool mergeRuns(const std::vector<std::string>& runs, std::FILE* out, size_t memoryBytes, uint64_t& written) {
+    const size_t blockEntries = std::clamp<size_t>(memoryBytes / std::max<size_t>(runs.size(), 1) / sizeof(IndexEntry),
+                                                   1024, MAX_READ_BUFFER);
+    std::vector<std::unique_ptr<RunReader>> readers;
+    using Head = std::pair<IndexEntry, size_t>;
+    const auto later = [](const Head& a, const Head& b) { return b.first < a.first; };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    bool ok = true;
+    for (const auto& run : runs) {
+        readers.push_back(std::make_unique<RunReader>(run, blockEntries));
+        IndexEntry first;
+        if (!readers.back()->file) ok = false;
+        else if (readers.back()->next(first)) heads.push({ first, readers.size() - 1 });
+    }
+    while (ok && !heads.empty()) {
+        auto [entry, run] = heads.top();
+        heads.pop();
+        ok = std::fwrite(&entry, sizeof entry, 1, out) == 1;
+        ++written;
+        if (readers[run]->next(entry)) heads.push({ entry, run });
+    }
+    return ok;
+}
+
+bool buildPositionIndex(const std::vector<std::string>& inputs, const std::string& out,
+                        const IndexBuildOptions& options, IndexBuildStats& stats) {
+    stats = {};
+    const unsigned threads = std::max(1u, options.threads);
+    const size_t capacity = std::max<size_t>(options.memoryBytes / threads / sizeof(IndexEntry), 1024);
+    const std::filesystem::path outPath(out);
+    const std::filesystem::path tempDir = !options.tempDir.empty() ? std::filesystem::path(options.tempDir)
+                                        : outPath.has_parent_path() ? outPath.parent_path() : std::filesystem::path(".");
+    const std::string runPrefix = (tempDir / outPath.filename()).string() + "." + std::to_string(getpid()) + ".run";
+
+    std::mutex mutex;
+    std::vector<std::string> runs;
+    std::vector<std::unique_ptr<ThreadState>> states;
+    std::atomic<bool> writeFailed{false};
+    std::atomic<uint64_t> entries{0};
+    const auto removeRuns = [&] { for (const auto& run : runs) std::filesystem::remove(run); };
+
+    // Sorts a full buffer and writes it as a run, on the thread that filled it
+    const auto spill = [&](std::vector<IndexEntry>& buffer) {
+        if (buffer.empty()) return;
+        std::sort(buffer.begin(), buffer.end());
+        std::string path;
+        {
+            std::lock_guard lock(mutex);
+            path = runPrefix + std::to_string(runs.size());
+            runs.push_back(path);
+        }
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        const bool ok = file && std::fwrite(buffer.data(), sizeof(IndexEntry), buffer.size(), file) == buffer.size();
+        if (file && std::fclose(file) != 0) writeFailed = true;
+        if (!ok) writeFailed = true;
+        entries += buffer.size();
+        buffer.clear();
+    };
+
+    // The entries of one game, into the buffer of the thread replaying it. Replay threads are
+    // started per file; each finds its state through a thread_local tagged with the file being
+    // replayed.
+    static std::atomic<uint64_t> passes{0};
+    uint64_t pass = 0, gameBase = 0;
+    const auto addGame = [&](uint64_t game, std::string_view fen, const MoveList& moves) {
+        thread_local std::pair<uint64_t, ThreadState*> local { 0, nullptr };
+        if (local.first != pass) {
+            std::lock_guard lock(mutex);
+            states.push_back(std::make_unique<ThreadState>());
+            states.back()->entries.reserve(capacity);
+            local = { pass, states.back().get() };
+        }
+        ThreadState& state = *local.second;
+        Board& board = state.board;
+        if (!board.setFromFEN(fen)) return;
+        const uint64_t id = (gameBase + game) << 16;
+        const size_t plies = std::min<size_t>(moves.size(), INDEX_MAX_PLY);
+        for (size_t ply = 0; ply <= plies; ++ply) {
+            if (state.entries.size() == capacity) spill(state.entries);
+            state.entries.push_back({ board.getKey(), id | ply });
+            if (ply < plies) board.move(moves[ply]);
+        }
+    };
+    for (const auto& path : inputs) {
+        pass = ++passes;
+        PgnStats read;
+        const bool mapped = options.packed
+            ? replayPackedFile(path, threads, options.openings, [&](uint64_t offset, const GameRecord& game) {
+                  addGame(offset, game.opening, game.moves);
+              }, read)
+            : replayPgnFile(path, threads, [&](const PgnGame& game) {
+                  addGame(game.offset, game.fen.empty() ? START_FEN : game.fen, game.moves);
+              }, read);
+        if (!mapped) {
+            removeRuns();
+            return false;
+        }
+        for (auto& state : states) spill(state->entries);
+        states.clear();
+        stats.games += read.games;
+        stats.failed += read.failed;
+        gameBase += read.bytes;
+    }
+    stats.entries = entries;
+    stats.runs = runs.size();
+    if (writeFailed) {
+        removeRuns();
+        return false;
+    }
+
+    // Runs past the fan-in are merged a group at a time into longer runs first, so no more than
+    // mergeFanIn of them are ever open at once
+    std::vector<char> writeBuffer(1 << 22);
+    const auto create = [&](const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file) std::setvbuf(file, writeBuffer.data(), _IOFBF, writeBuffer.size());
+        return file;
+    };
+    const size_t fanIn = std::max<size_t>(options.mergeFanIn, 2);
+    size_t nextRun = runs.size();
+    while (runs.size() > fanIn) {
+        std::vector<std::string> merged;
+        for (size_t first = 0; first < runs.size(); first += fanIn) {
+            const std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(first + fanIn, runs.size()));
+            if (group.size() == 1) {
+                merged.push_back(group.front());
+                continue;
+            }
+            merged.push_back(runPrefix + std::to_string(nextRun++));
+            std::FILE* file = create(merged.back());
+            uint64_t written = 0;
+            bool ok = file && mergeRuns(group, file, options.memoryBytes, written);
+            if (file && std::fclose(file) != 0) ok = false;
+            if (!ok) {
+                merged.insert(merged.end(), runs.begin() + first, runs.end());
+                runs = std::move(merged);
+                removeRuns();
+                return false;
+            }
+            for (const auto& run : group) std::filesystem::remove(run);
+        }
+        runs = std::move(merged);
+    }
+
+    // The last merge, written under a temporary name and renamed over out when complete
+    const std::string partial = out + ".partial";
+    std::FILE* file = create(partial);
+    if (!file) {
+        removeRuns();
+        return false;
+    }
+    const IndexHeader header = makeHeader(stats.entries, stats.games);
+    uint64_t written = 0;
+    bool ok = std::fwrite(&header, sizeof header, 1, file) == 1 && mergeRuns(runs, file, options.memoryBytes, written);
+    ok = std::fclose(file) == 0 && ok && written == stats.entries;
+    removeRuns();
+    if (!ok || std::rename(partial.c_str(), out.c_str()) != 0) {
+        std::filesystem::remove(partial);
+        return false;
+    }
+    return true;
+}
+
+// ---------- PositionIndex ----------
+
+PositionIndex::~PositionIndex() { close(); }
+
+void PositionIndex::close() {
+    if (map) munmap(map, bytes);
+    map = nullptr;
+    bytes = 0;
+    entries = {};
+    gameCount = 0;
+}
+
+bool PositionIndex::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(IndexHeader)) { ::close(fd); return false; }
+    void* file = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (file == MAP_FAILED) return false;
+
+    IndexHeader header;
+    std::memcpy(&header, file, sizeof header);
+    const IndexHeader expected = makeHeader(header.entries, header.games);
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+        header.entrySize != expected.entrySize || header.zobristSeed != expected.zobristSeed ||
+        header.zobristFingerprint != expected.zobristFingerprint ||
+        size_t(st.st_size) != sizeof(IndexHeader) + header.entries * sizeof(IndexEntry)) {
+        munmap(file, st.st_size);
+        return false;
+    }
+    madvise(file, st.st_size, MADV_RANDOM);
+
+    close();
+    map = file;
+    bytes = size_t(st.st_size);
+    entries = { reinterpret_cast<const IndexEntry*>(static_cast<const char*>(file) + sizeof(IndexHeader)), header.entries };
+    gameCount = header.games;
+    return true;
+}
+
+std::span<const IndexEntry> PositionIndex::find(uint64_t key) const {
+    const auto first = std::partition_point(entries.begin(), entries.end(), [&](const IndexEntry& e) { return e.key < key; });
+    const auto last = std::partition_point(first, entries.end(), [&](const IndexEntry& e) { return e.key == key; });
+    return { first, last };
+}
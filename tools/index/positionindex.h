@@ -0,0 +1,102 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_POSITIONINDEX_H
+#define TEMPO_POSITIONINDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One position of one game: Board::getKey() before the ply-th move (ply 0 is the starting
+// position, the last ply the final one). Games are named by byte offset into the collection (of
+// the game text, or of the record in a packed file), the files of a multi-file build counting on
+// from each other.
+struct IndexEntry {
+    uint64_t key;
+    uint64_t gamePly; // game << 16 | ply, so entries sort by key, then game, then ply
+
+    uint64_t game() const { return gamePly >> 16; }
+    uint16_t ply() const { return uint16_t(gamePly); }
+    bool operator<(const IndexEntry& other) const {
+        return key != other.key ? key < other.key : gamePly < other.gamePly;
+    }
+};
+
+static_assert(sizeof(IndexEntry) == 16);
+
+// First 64 bytes of an index file; the sorted entries follow. Keys only mean something under the
+// Zobrist tables that made them, so their seed and digest are checked on open like a hash file's.
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t zobristSeed;
+    uint64_t zobristFingerprint;
+    uint64_t entries;
+    uint64_t games;
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(IndexHeader) == 64);
+
+inline constexpr char INDEX_MAGIC[8] = { 'T', 'E', 'M', 'P', 'O', 'I', 'X', '\0' };
+inline constexpr uint32_t INDEX_VERSION = 1;
+inline constexpr uint16_t INDEX_MAX_PLY = 0xFFFF; // later plies of a longer game are not indexed
+
+struct IndexBuildOptions {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t memoryBytes = size_t(1) << 30; // for the in-memory runs of all threads together
+    std::string tempDir;                  // for the runs; the output's directory when empty
+    size_t mergeFanIn = 256;              // runs open at once while merging, merged in passes beyond it
+    bool packed = false;                  // inputs are SelfPlay game files (packGame) rather than PGN
+    std::vector<std::string> openings;    // FENs a packed game's index picks from, the start position when empty
+};
+
+struct IndexBuildStats {
+    uint64_t games = 0;
+    uint64_t failed = 0; // PGN: indexed up to the move that did not resolve; packed: not indexed
+    uint64_t entries = 0;
+    size_t runs = 0;
+};
+
+// Replays every game of the inputs (PGN, or packed games from their openings through
+// unpackGame) through Board::move() and writes the sorted index to out. Each replay thread fills
+// its share of memoryBytes with entries, sorts it and writes it out as a run; the runs are then
+// merged into the index, in passes of at most mergeFanIn runs, so a corpus needs disk rather than
+// memory or file descriptors in proportion to its size. False if an input cannot be mapped or a
+// file cannot be written.
+bool buildPositionIndex(const std::vector<std::string>& inputs, const std::string& out,
+                        const IndexBuildOptions& options, IndexBuildStats& stats);
+
+// A memory-mapped index; find() is a binary search over the entries
+class PositionIndex {
+public:
+    PositionIndex() = default;
+    ~PositionIndex();
+    PositionIndex(const PositionIndex&) = delete;
+    PositionIndex& operator=(const PositionIndex&) = delete;
+
+    // False if the file cannot be mapped, or was written in another format or under other keys
+    bool open(const std::string& path);
+
+    // Every (game, ply) that reached key, by game then ply
+    std::span<const IndexEntry> find(uint64_t key) const;
+    size_t size() const { return entries.size(); }
+    uint64_t games() const { return gameCount; }
+
+private:
+    void close();
+
+    void* map = nullptr;
+    size_t bytes = 0;
+    std::span<const IndexEntry> entries;
+    uint64_t gameCount = 0;
+};
+
+#endif //TEMPO_POSITIONINDEX_H
@@ -0,0 +1,113 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "counters.h"
+#include <cstdio>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+
+// type and config of each PerfEvent
+static constexpr std::array<std::pair<uint32_t, uint64_t>, NUM_PERF_EVENTS> EVENT_CONFIGS = {{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+}};
+
+PerfCounters::PerfCounters(bool inheritThreads) {
+    for (size_t i = 0; i < NUM_PERF_EVENTS; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = EVENT_CONFIGS[i].first;
+        attr.config = EVENT_CONFIGS[i].second;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // allowed at the default perf_event_paranoid level
+        attr.exclude_hv = 1;
+        attr.inherit = inheritThreads; // reads and ioctls then cover the inherited counters too
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds)
+        if (fd >= 0) close(fd);
+}
+
+void PerfCounters::start() {
+    for (int fd : fds) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::stop() {
+    for (int fd : fds)
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    for (size_t i = 0; i < NUM_PERF_EVENTS; ++i) {
+        counts[i].reset();
+        uint64_t data[3]; // value, time enabled, time running
+        if (fds[i] < 0 || read(fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0) continue;
+        counts[i] = data[2] < data[1] ? uint64_t(double(data[0]) * double(data[1]) / double(data[2])) : data[0];
+    }
+}
+
+#else // no perf_event_open: nothing is ever available
+
+PerfCounters::PerfCounters(bool) { fds.fill(-1); }
+PerfCounters::~PerfCounters() = default;
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+
+#endif
+
+bool PerfCounters::available() const {
+    for (int fd : fds)
+        if (fd >= 0) return true;
+    return false;
+}
+
+std::optional<uint64_t> PerfCounters::value(PerfEvent event) const { return counts[static_cast<size_t>(event)]; }
+
+std::string_view PerfCounters::name(PerfEvent event) {
+    static constexpr std::array<std::string_view, NUM_PERF_EVENTS> NAMES = {
+        "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses", "dTLB-misses"
+    };
+    return NAMES[static_cast<size_t>(event)];
+}
+
+void PerfCounters::report(std::ostream& out, uint64_t nodes, uint64_t moves) const {
+    if (!available()) {
+        out << "hardware counters unavailable (perf_event_open refused)" << std::endl;
+        return;
+    }
+    char line[128];
+    for (size_t i = 0; i < NUM_PERF_EVENTS; ++i) {
+        const auto event = static_cast<PerfEvent>(i);
+        if (!counts[i]) {
+            std::snprintf(line, sizeof(line), "%-14s %16s", name(event).data(), "n/a");
+        } else {
+            const double count = double(*counts[i]);
+            int len = std::snprintf(line, sizeof(line), "%-14s %16llu", name(event).data(), static_cast<unsigned long long>(*counts[i]));
+            if (nodes) len += std::snprintf(line + len, sizeof(line) - len, " %10.2f /node", count / double(nodes));
+            if (moves) std::snprintf(line + len, sizeof(line) - len, " %10.2f /move", count / double(moves));
+        }
+        out << line << '\n';
+    }
+    const auto cycles = value(PerfEvent::Cycles), instructions = value(PerfEvent::Instructions);
+    if (cycles && instructions && *cycles) {
+        std::snprintf(line, sizeof(line), "%-14s %16.2f", "IPC", double(*instructions) / double(*cycles));
+        out << line << '\n';
+    }
+    out.flush();
+}
@@ -0,0 +1,45 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_COUNTERS_H
+#define TEMPO_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+enum class PerfEvent : uint8_t { Cycles, Instructions, BranchMisses, L1dMisses, LLCMisses, DTLBMisses, COUNT };
+inline constexpr size_t NUM_PERF_EVENTS = static_cast<size_t>(PerfEvent::COUNT);
+
+// Hardware counters around a measured region, read through Linux perf_event_open and counting this
+// thread in user space only, or with inheritThreads also every thread it starts after opening
+// them. Each event is opened on its own, so one the machine lacks (LLC misses in many VMs) only
+// drops that line, and in a container that forbids perf nothing is counted at all.
+class PerfCounters {
+public:
+    explicit PerfCounters(bool inheritThreads = false); // opens the counters, stopped
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const; // at least one counter opened
+    void start();           // resets and enables every counter
+    void stop();            // disables them and reads the counts
+
+    // Count over the last start/stop, scaled up when the kernel multiplexed the counter;
+    // nullopt when the event could not be opened
+    std::optional<uint64_t> value(PerfEvent event) const;
+    static std::string_view name(PerfEvent event);
+
+    // One line per counter with its total and its rate per node and per generated move (0 omits it)
+    void report(std::ostream& out, uint64_t nodes, uint64_t moves) const;
+
+private:
+    std::array<int, NUM_PERF_EVENTS> fds;
+    std::array<std::optional<uint64_t>, NUM_PERF_EVENTS> counts;
+};
+
+#endif //TEMPO_COUNTERS_H
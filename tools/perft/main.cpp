@@ -0,0 +1,290 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "board.h"
+#include "attacks.h"
+#include "counters.h"
+#include "fill.h"
+#include "hashtable.h"
+#include "largepages.h"
+#include "perft.h"
+#include "search.h"
+#include "stats.h"
+#include "threadpool.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Positions searched by bench: the usual perft suite, openings to endings
+static const char* BENCH_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+// Perft that also counts the moves generated (or counted, at the leaves) as in Perft()
+static uint64_t countedPerft(Board& board, int depth, uint64_t& generated) {
+    if (depth == 0) return 1;
+    if (depth == 1) {
+        const int count = board.countLegalMoves();
+        generated += count;
+        return count;
+    }
+    MoveList moves;
+    board.genLegalMoves(moves);
+    generated += moves.size();
+    uint64_t nodes = 0;
+    for (auto m : moves) {
+        board.move(m);
+        nodes += countedPerft(board, depth - 1, generated);
+        board.undoMove(m);
+    }
+    return nodes;
+}
+
+// Dependent random probes into a table of 64-bit keys: each probe's slot comes from the key the
+// previous one loaded, so the loop measures latency rather than memory-level parallelism
+static void fillKeys(const LargeAllocation& table) {
+    std::mt19937_64 rng(1);
+    for (size_t i = 0; i < table.size() / sizeof(uint64_t); ++i) table.as<uint64_t>()[i] = rng();
+}
+
+// The key the chain ends on goes to last, which keeps the loads live and lets runs be compared
+static double probeLatencyNs(const LargeAllocation& table, size_t probes, uint64_t& last) {
+    const uint64_t* slots = table.as<uint64_t>();
+    const size_t n = table.size() / sizeof(uint64_t);
+    uint64_t key = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t p = 0; p < probes; ++p)
+        key = slots[static_cast<uint64_t>((static_cast<unsigned __int128>(key + p) * n) >> 64)];
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    last = key;
+    return ns / double(probes);
+}
+
+// Slider sets of both sides in every position a short perft from each bench position reaches
+struct SliderSets { uint64_t rookLike, bishopLike, occ; };
+
+static void collectSliderSets(Board& board, int depth, std::vector<SliderSets>& out) {
+    const uint64_t occ = board.occAll;
+    out.push_back({ board.bb[WR_CODE] | board.bb[WQ_CODE], board.bb[WB_CODE] | board.bb[WQ_CODE], occ });
+    out.push_back({ board.bb[BR_CODE] | board.bb[BQ_CODE], board.bb[BB_CODE] | board.bb[BQ_CODE], occ });
+    if (depth == 0) return;
+    MoveList moves;
+    board.genLegalMoves(moves);
+    for (auto m : moves) {
+        board.move(m);
+        collectSliderSets(board, depth - 1, out);
+        board.undoMove(m);
+    }
+}
+
+static uint64_t loopedSlidingAttacks(uint64_t rookLike, uint64_t bishopLike, uint64_t occ) {
+    uint64_t attacks = 0;
+    forEachSetBit(rookLike, [&](uint8_t from) { attacks |= rookAttacks(from, occ); });
+    forEachSetBit(bishopLike, [&](uint8_t from) { attacks |= bishopAttacks(from, occ); });
+    return attacks;
+}
+
+// ns per side for one way of computing all slider attacks, checksum folded into check
+template <typename Kernel>
+static double timeSlidingAttacks(const std::vector<SliderSets>& sets, int rounds, uint64_t& check, Kernel kernel) {
+    uint64_t sum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        for (const auto& s : sets) sum += kernel(s.rookLike, s.bishopLike, s.occ);
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    check = sum;
+    return ns / double(sets.size() * rounds);
+}
+
+static void printRate(uint64_t nodes, int64_t us) {
+    std::cout << "nodes " << nodes << " time " << us / 1000 << " ms nps " << (us ? nodes * 1000000 / us : 0) << std::endl;
+}
+
+// Parallel perft on a pool, with the nodes each NUMA node's workers counted. perf, when given, must
+// have been opened to count the pool's threads.
+static void perftOnPool(Board& board, int depth, ThreadPool& pool, PerfCounters* perf = nullptr) {
+    std::vector<uint64_t> perWorker;
+    const auto begin = std::chrono::steady_clock::now();
+    if (perf) perf->start();
+    const uint64_t nodes = ParallelPerft(board, uint8_t(depth), pool, &perWorker);
+    if (perf) perf->stop();
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << pool.size() << " threads on " << pool.nodesUsed() << " node(s): ";
+    printRate(nodes, us);
+    std::vector<uint64_t> perNode(pool.topology().nodes.size());
+    std::vector<unsigned> workers(perNode.size());
+    for (unsigned w = 0; w < pool.size(); ++w) {
+        perNode[pool.nodeOf(w)] += perWorker[w];
+        ++workers[pool.nodeOf(w)];
+    }
+    for (size_t n = 0; n < perNode.size(); ++n)
+        if (workers[n])
+            std::cout << "  node " << pool.topology().nodes[n].id << ": " << workers[n] << " threads nps "
+                      << (us ? perNode[n] * 1000000 / us : 0) << std::endl;
+    if (perf) perf->report(std::cout, nodes, 0);
+}
+
+// Times perft of a position, or searches every bench position to a fixed depth, optionally under
+// hardware counters, e.g. `PerftBench -c perft 5` or `PerftBench -c bench 6`. `PerftBench probe 512`
+// compares random probe latency into a 512 MB table on normal and on huge pages. `PerftBench fill`
+// times whole-side slider attacks by Kogge-Stone fills against a lookup per piece. `-h file` runs
+// perft through a hash file that later runs reuse, e.g. `PerftBench -h perft.tth perft 7`; `-t n`
+// splits it over n workers pinned NUMA node by node. `PerftBench scale 6` runs parallel perft on one
+// thread, one node's CPUs, two nodes' and so on, to show the scaling per socket. `PerftBench fen`
+// times loading and writing back the bench positions.
+int main(int argc, char** argv) {
+    bool counters = false;
+    unsigned threads = 0;
+    std::string hashFile;
+    int i = 1;
+    for (; i < argc; ++i) {
+        const std::string flag = argv[i];
+        if (flag == "-c") counters = true;
+        else if (flag == "-h" && i + 1 < argc) hashFile = argv[++i];
+        else if (flag == "-t" && i + 1 < argc) threads = std::stoul(argv[++i]);
+        else break;
+    }
+    const std::string mode = i < argc ? argv[i++] : "";
+    if (mode != "perft" && mode != "bench" && mode != "probe" && mode != "fill" && mode != "scale" &&
+        mode != "fen") {
+        std::cerr << "usage: PerftBench [-c] [-h file | -t threads] perft <depth> [fen]\n       PerftBench scale <depth> [fen]\n       PerftBench [-c] bench [depth]\n"
+                     "       PerftBench [-c] probe [MB]\n       PerftBench fill\n       PerftBench fen" << std::endl;
+        return 1;
+    }
+    if (mode == "probe") {
+        const size_t mb = i < argc ? std::stoul(argv[i]) : 256;
+        constexpr size_t PROBES = 20'000'000;
+        uint64_t last[2];
+        for (bool huge : { false, true }) {
+            const LargeAllocation table(mb << 20, huge);
+            fillKeys(table);
+            PerfCounters perf;
+            if (counters) perf.start();
+            const double ns = probeLatencyNs(table, PROBES, last[huge]);
+            if (counters) perf.stop();
+            std::cout << pageModeName(table.mode()) << ": " << ns << " ns/probe" << std::endl;
+            if (counters) perf.report(std::cout, PROBES, 0);
+        }
+        if (last[0] != last[1]) {
+            std::cerr << "probe mismatch" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (mode == "fill") {
+        std::vector<SliderSets> sets;
+        for (auto fen : BENCH_FENS) {
+            Board board = Board();
+            board.setFromFEN(fen);
+            collectSliderSets(board, 2, sets);
+        }
+        constexpr int ROUNDS = 50;
+        uint64_t looped, scalar, fill;
+        std::cout << sets.size() << " side sets" << std::endl;
+        std::cout << "per piece:   " << timeSlidingAttacks(sets, ROUNDS, looped, loopedSlidingAttacks) << " ns" << std::endl;
+        std::cout << "fill scalar: " << timeSlidingAttacks(sets, ROUNDS, scalar, slidingAttacksScalar) << " ns" << std::endl;
+        std::cout << "fill " << (slidingAttacksVectorized() ? "avx2:   " : "(same): ")
+                  << timeSlidingAttacks(sets, ROUNDS, fill, slidingAttacks) << " ns" << std::endl;
+        if (looped != scalar || looped != fill) {
+            std::cerr << "fill mismatch" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (mode == "fen") {
+        constexpr size_t ROUNDS = 1'000'000;
+        Board board = Board();
+        char out[Board::MAX_FEN_LENGTH];
+        size_t loaded = 0, written = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < ROUNDS; ++r)
+            for (auto fen : BENCH_FENS) {
+                loaded += board.setFromFEN(fen);
+                written += board.writeFEN(out);
+            }
+        const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        const size_t positions = ROUNDS * std::size(BENCH_FENS);
+        if (loaded != positions) {
+            std::cerr << "bad bench FEN" << std::endl;
+            return 1;
+        }
+        std::cout << positions << " positions, " << ns / positions << " ns per load and write (" << written << " chars)"
+                  << std::endl;
+        return 0;
+    }
+    const int depth = i < argc ? std::stoi(argv[i++]) : 5;
+
+    PerfCounters perf(threads > 0); // opened before any pool, so it counts the workers
+    uint64_t nodes = 0, generated = 0;
+    std::chrono::steady_clock::time_point begin;
+#ifdef TEMPO_STATS
+    stats::reset();
+#endif
+
+    if (mode == "perft" || mode == "scale") {
+        std::string fen;
+        for (; i < argc; ++i) fen += std::string(argv[i]) + ' ';
+        Board board = Board();
+        if (!fen.empty() && !board.setFromFEN(fen)) {
+            std::cerr << "bad FEN: " << fen << std::endl;
+            return 1;
+        }
+        if (mode == "scale") {
+            const CpuTopology topology = CpuTopology::detect();
+            std::vector<unsigned> counts { 1 };
+            size_t cpus = 0;
+            for (const auto& node : topology.nodes)
+                if ((cpus += node.cpus.size()) > counts.back()) counts.push_back(unsigned(cpus));
+            for (unsigned n : counts) {
+                ThreadPool pool(n, topology);
+                perftOnPool(board, depth, pool);
+            }
+            return 0;
+        }
+        if (threads) {
+            ThreadPool pool(threads);
+            perftOnPool(board, depth, pool, counters ? &perf : nullptr);
+#ifdef TEMPO_STATS
+            stats::dump(std::cout);
+#endif
+            return 0;
+        }
+        HashTable table;
+        if (!hashFile.empty() && !table.open(hashFile, 256)) {
+            std::cerr << "cannot use hash file " << hashFile << " (written with other keys or format?)" << std::endl;
+            return 1;
+        }
+        begin = std::chrono::steady_clock::now();
+        if (counters) perf.start();
+        nodes = table.persistent() ? HashedPerft(board, depth, table) : countedPerft(board, depth, generated);
+    } else {
+        Search search;
+        SearchLimits limits;
+        limits.depth = depth;
+        begin = std::chrono::steady_clock::now();
+        if (counters) perf.start();
+        for (auto fen : BENCH_FENS) {
+            Board board = Board();
+            board.setFromFEN(fen);
+            search.think(board, limits);
+            nodes += search.nodes();
+        }
+    }
+
+    if (counters) perf.stop();
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    printRate(nodes, us);
+    if (counters) perf.report(std::cout, nodes, generated);
+#ifdef TEMPO_STATS
+    stats::dump(std::cout);
+#endif
+    return 0;
+}
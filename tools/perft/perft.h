@@ -6,18 +6,22 @@
 #define TEMPO_PERFT_H
 
 #include "Board.h"
+#include "hashtable.h"
+#include "threadpool.h"
+#include <memory>
+#include <vector>
 
 // Used to verify the total number of legal positions (nodes) reachable
 // from a starting position to a specified depth (debugging/testing)
-uint64_t Perft(Board& board, uint8_t depth) {
+inline uint64_t Perft(Board& board, uint8_t depth) {
     if (depth == 0) return 1;
+    if (depth == 1) return board.countLegalMoves(); // leaves are counted, not generated
 
     MoveList moves;
     board.genLegalMoves(moves);
     uint64_t nMoves = moves.size();
     uint64_t nodes = 0;
 
-    if (depth == 1) return nMoves;
     for (size_t i = 0; i < nMoves; ++i) {
         board.move(moves[i]);
         nodes += Perft(board, depth - 1);
@@ -26,4 +30,67 @@ uint64_t Perft(Board& board, uint8_t depth) {
     return nodes;
 }
 
+// Perft with subtree counts cached by key and depth. With a file-backed table the counts carry
+// over to later runs, so a repeated or deeper perft of a known position starts warm.
+inline uint64_t HashedPerft(Board& board, uint8_t depth, HashTable& table) {
+    if (depth == 0) return 1;
+    if (depth == 1) return board.countLegalMoves();
+
+    uint64_t nodes = 0;
+    if (table.probe(board.key, depth, nodes)) return nodes;
+
+    MoveList moves;
+    board.genLegalMoves(moves);
+    for (size_t i = 0; i < moves.size(); ++i) {
+        board.move(moves[i]);
+        nodes += HashedPerft(board, depth - 1, table);
+        board.undoMove(moves[i]);
+    }
+    table.store(board.key, depth, nodes);
+    return nodes;
+}
+
+// Perft with the positions two plies down shared out over the pool. Each worker builds its own
+// board, so the board lives on the worker's NUMA node. perWorker, if given, receives the nodes
+// each worker counted.
+inline uint64_t ParallelPerft(Board& board, uint8_t depth, ThreadPool& pool, std::vector<uint64_t>* perWorker = nullptr) {
+    struct alignas(64) Count { uint64_t nodes = 0; }; // one cache line per worker
+    std::vector<Count> counts(pool.size());
+    if (perWorker) perWorker->assign(pool.size(), 0);
+    if (depth < 3 || pool.size() == 0) return Perft(board, depth);
+
+    struct Split { uint32_t first, second; };
+    std::vector<Split> splits;
+    MoveList moves, replies;
+    board.genLegalMoves(moves);
+    for (auto m : moves) {
+        board.move(m);
+        board.genLegalMoves(replies);
+        for (auto r : replies) splits.push_back({ m, r });
+        board.undoMove(m);
+    }
+
+    const Position root = board;
+    std::vector<std::unique_ptr<Board>> boards(pool.size());
+    pool.onEachWorker([&](unsigned w) {
+        boards[w] = std::make_unique<Board>();
+        boards[w]->setPosition(root);
+    });
+    pool.forEach(splits.size(), [&](unsigned w, size_t i) {
+        Board& b = *boards[w];
+        b.move(splits[i].first);
+        b.move(splits[i].second);
+        counts[w].nodes += Perft(b, depth - 2);
+        b.undoMove(splits[i].second);
+        b.undoMove(splits[i].first);
+    });
+
+    uint64_t nodes = 0;
+    for (unsigned w = 0; w < pool.size(); ++w) {
+        nodes += counts[w].nodes;
+        if (perWorker) (*perWorker)[w] = counts[w].nodes;
+    }
+    return nodes;
+}
+
 #endif //TEMPO_PERFT_H
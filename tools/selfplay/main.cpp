@@ -0,0 +1,76 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "match.h"
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+// Plays the engine against itself on every core, e.g.
+// `SelfPlay -g 1000 -n 20000 -b openings.txt -o games.bin`. Openings are FENs, one per line, used in
+// turn. Each game is written packed as match.h lays it out, in completion order; without -b every
+// game starts from the initial position (add -r for variety).
+int main(int argc, char** argv) {
+    const auto usage = [] {
+        std::cerr << "usage: SelfPlay [-g games] [-t threads] [-d depth | -n nodes | -m movetime ms] "
+                     "[-p maxPlies] [-r randomPlies] [-b openings.txt] [-o games.bin]" << std::endl;
+        return 1;
+    };
+    MatchOptions options;
+    SearchLimits limits;
+    limits.depth = 6;
+    std::string openingsPath, outPath;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) return usage();
+        const std::string arg = argv[i], value = argv[i + 1];
+        if (arg == "-g") options.games = std::stoul(value);
+        else if (arg == "-t") options.threads = std::stoul(value);
+        else if (arg == "-p") options.maxPlies = std::stoul(value);
+        else if (arg == "-r") options.randomPlies = std::stoul(value);
+        else if (arg == "-d") limits.depth = std::stoi(value);
+        else if (arg == "-n") { limits.nodes = std::stoull(value); limits.depth = MAX_PLY; }
+        else if (arg == "-m") { limits.moveTime = std::stoll(value); limits.depth = MAX_PLY; }
+        else if (arg == "-b") openingsPath = value;
+        else if (arg == "-o") outPath = value;
+        else return usage();
+    }
+    options.maxPlies = std::min<size_t>(options.maxPlies, UINT16_MAX); // plies are counted in 16 bits
+
+    std::vector<std::string> openings;
+    if (!openingsPath.empty()) {
+        std::ifstream in(openingsPath);
+        if (!in) { std::cerr << "could not open " << openingsPath << std::endl; return 1; }
+        Board check = Board();
+        for (std::string line; std::getline(in, line);) {
+            if (line.empty()) continue;
+            if (!check.setFromFEN(line)) { std::cerr << "bad FEN: " << line << std::endl; return 1; }
+            openings.push_back(line);
+        }
+    }
+
+    std::ofstream out;
+    if (!outPath.empty()) {
+        out.open(outPath, std::ios::binary);
+        if (!out) { std::cerr << "could not open " << outPath << std::endl; return 1; }
+    }
+    std::mutex outMutex;
+    const auto sink = [&](const GameRecord& game) {
+        if (outPath.empty()) return;
+        std::string packed;
+        packGame(game, packed);
+        std::lock_guard lock(outMutex);
+        out.write(packed.data(), std::streamsize(packed.size()));
+    };
+
+    const MatchStats stats = playMatch(openings, options, searchSelector(limits), sink);
+    std::cout << "games " << stats.games << " +" << stats.whiteWins << " -" << stats.blackWins << " =" << stats.draws
+              << " in " << int(stats.seconds) << " s: " << uint64_t(stats.games * 60 / stats.seconds) << " games/min "
+              << uint64_t(stats.plies / stats.seconds) << " positions/s "
+              << uint64_t(stats.nodes / stats.seconds) << " nps on " << options.threads << " threads" << std::endl;
+    if (!outPath.empty() && !out.flush()) {
+        std::cerr << "could not write " << outPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "match.h"
+#include "polyglot.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+
+std::string_view resultName(GameResult result) {
+    static constexpr std::string_view NAMES[] = { "1-0", "0-1", "1/2-1/2" };
+    return NAMES[static_cast<size_t>(result)];
+}
+
+std::string_view terminationName(Termination termination) {
+    static constexpr std::string_view NAMES[] = { "mate", "stalemate", "repetition", "fifty", "maxplies", "nomove" };
+    return NAMES[static_cast<size_t>(termination)];
+}
+
+SelectorFactory searchSelector(const SearchLimits& limits) {
+    return [limits](unsigned) {
+        auto search = std::make_shared<Search>();
+        return MoveSelector([search, limits](Board& board, const MoveList&) {
+            int score = 0;
+            const uint32_t move = search->think(board, limits, [&](const SearchReport& r) { score = r.score; });
+            return MoveChoice{ move, score, search->nodes() };
+        });
+    };
+}
+
+static GameResult lossFor(bool white) { return white ? GameResult::BlackWins : GameResult::WhiteWins; }
+
+void playGame(Board& board, GameRecord& game, const MoveSelector& select, const MatchOptions& options) {
+    game.moves.clear();
+    game.scores.clear();
+    game.nodes = 0;
+    game.result = GameResult::Draw;
+    game.termination = Termination::MaxPlies;
+    if (!board.setFromFEN(game.opening)) board.setFromFEN(START_FEN);
+
+    MoveList legal;
+    std::mt19937_64 rng(game.index);
+    while (game.moves.size() < options.maxPlies) {
+        board.genLegalMoves(legal);
+        if (legal.empty()) {
+            game.termination = board.inCheck() ? Termination::Checkmate : Termination::Stalemate;
+            game.result = board.inCheck() ? lossFor(board.whiteToMove) : GameResult::Draw;
+            return;
+        }
+        if (board.repetitions() >= 2) { game.termination = Termination::Repetition; return; }
+        if (board.isFiftyMoveDraw()) { game.termination = Termination::FiftyMoves; return; }
+
+        MoveChoice choice{ Move::NONE, 0, 0 };
+        if (game.moves.size() < options.randomPlies) choice.move = legal[rng() % legal.size()];
+        else choice = select(board, legal);
+        game.nodes += choice.nodes;
+        if (std::find(legal.begin(), legal.end(), choice.move) == legal.end()) {
+            game.termination = Termination::NoMove;
+            game.result = lossFor(board.whiteToMove);
+            return;
+        }
+        board.move(choice.move);
+        game.moves.push_back(choice.move);
+        game.scores.push_back(choice.score);
+    }
+}
+
+void packGame(const GameRecord& game, std::string& out) {
+    const size_t plies = std::min<size_t>(game.moves.size(), UINT16_MAX);
+    const PackedGameHeader header{ uint32_t(game.index), uint8_t(game.result), uint8_t(game.termination), uint16_t(plies) };
+    out.append(reinterpret_cast<const char*>(&header), sizeof header);
+    for (size_t i = 0; i < plies; ++i) {
+        const uint16_t move = moveToPolyglot(game.moves[i]);
+        out.append(reinterpret_cast<const char*>(&move), sizeof move);
+    }
+}
+
+bool unpackGame(std::string_view& data, std::string_view opening, GameRecord& game) {
+    PackedGameHeader header;
+    if (data.size() < sizeof header) return false;
+    std::memcpy(&header, data.data(), sizeof header);
+    const size_t bytes = sizeof header + header.plies * sizeof(uint16_t);
+    if (data.size() < bytes || header.result > uint8_t(GameResult::Draw) || header.termination > uint8_t(Termination::NoMove))
+        return false;
+
+    Board board = Board();
+    if (!board.setFromFEN(opening)) return false;
+    game.index = header.index;
+    game.opening = opening;
+    game.result = GameResult(header.result);
+    game.termination = Termination(header.termination);
+    game.moves.clear();
+    game.scores.assign(header.plies, 0);
+    game.nodes = 0;
+    MoveList legal;
+    for (size_t i = 0; i < header.plies; ++i) {
+        uint16_t packed;
+        std::memcpy(&packed, data.data() + sizeof header + i * sizeof packed, sizeof packed);
+        const uint32_t move = polyglotToMove(board, packed);
+        board.genLegalMoves(legal);
+        if (std::find(legal.begin(), legal.end(), move) == legal.end()) return false;
+        board.move(move);
+        game.moves.push_back(move);
+    }
+    data.remove_prefix(bytes);
+    return true;
+}
+
+MatchStats playMatch(const std::vector<std::string>& openings, const MatchOptions& options,
+                     const SelectorFactory& factory, const std::function<void(const GameRecord&)>& sink) {
+    static const std::string START(START_FEN);
+    const unsigned threads = std::max(1u, options.threads);
+    const auto begin = std::chrono::steady_clock::now();
+    std::atomic<size_t> next{0};
+    std::vector<MatchStats> partial(threads);
+    std::vector<std::thread> pool;
+
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            Board board = Board();
+            const MoveSelector select = factory(t);
+            GameRecord game;
+            MatchStats& stats = partial[t];
+            for (size_t index; (index = next.fetch_add(1)) < options.games;) {
+                game.index = index;
+                game.opening = openings.empty() ? START : openings[index % openings.size()];
+                playGame(board, game, select, options);
+                ++stats.games;
+                stats.whiteWins += game.result == GameResult::WhiteWins;
+                stats.blackWins += game.result == GameResult::BlackWins;
+                stats.draws += game.result == GameResult::Draw;
+                stats.plies += game.moves.size();
+                stats.nodes += game.nodes;
+                if (sink) sink(game);
+            }
+        });
+    for (auto& thread : pool) thread.join();
+
+    MatchStats total;
+    for (const auto& s : partial) {
+        total.games += s.games;
+        total.whiteWins += s.whiteWins;
+        total.blackWins += s.blackWins;
+        total.draws += s.draws;
+        total.plies += s.plies;
+        total.nodes += s.nodes;
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return total;
+}
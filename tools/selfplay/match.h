@@ -0,0 +1,90 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_MATCH_H
+#define TEMPO_MATCH_H
+
+#include "board.h"
+#include "search.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class GameResult : uint8_t { WhiteWins, BlackWins, Draw };
+enum class Termination : uint8_t { Checkmate, Stalemate, Repetition, FiftyMoves, MaxPlies, NoMove };
+
+std::string_view resultName(GameResult result);           // 1-0, 0-1, 1/2-1/2
+std::string_view terminationName(Termination termination); // mate, stalemate, ...
+
+// What a selector decided in one position
+struct MoveChoice {
+    uint32_t move;
+    int score;      // from the mover's point of view, 0 when the selector has none
+    uint64_t nodes; // searched for this move
+};
+
+// Picks the move to play; legal holds the legal moves of board and is never empty. board must be
+// left as it was given.
+using MoveSelector = std::function<MoveChoice(Board& board, const MoveList& legal)>;
+
+// Built once per worker thread, so a selector may keep state such as a Search
+using SelectorFactory = std::function<MoveSelector(unsigned worker)>;
+
+// Plays every move through a Search with fixed limits (depth, nodes or movetime)
+SelectorFactory searchSelector(const SearchLimits& limits);
+
+struct MatchOptions {
+    size_t games = 100;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxPlies = 400;  // a game still running after this many plies is adjudicated a draw
+    size_t randomPlies = 0; // uniformly random opening moves after the opening position, seeded by game index
+};
+
+struct GameRecord {
+    size_t index;             // game number, fixes the opening (index modulo the list) and the random plies
+    std::string_view opening; // FEN the game started from
+    MoveList moves;           // including the random plies
+    std::vector<int> scores;  // one per move, 0 for the random ones
+    GameResult result;
+    Termination termination;
+    uint64_t nodes;
+};
+
+// Plays one game in board from opening. Adjudication: checkmate and stalemate when no legal move is
+// left, threefold repetition, the fifty-move rule (mate on the last ply wins) and maxPlies.
+// NoMove when the selector returned an illegal move, scored as a loss for its side.
+void playGame(Board& board, GameRecord& game, const MoveSelector& select, const MatchOptions& options);
+
+struct MatchStats {
+    size_t games = 0;
+    size_t whiteWins = 0, blackWins = 0, draws = 0;
+    uint64_t plies = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+};
+
+// Plays options.games games, one game at a time on each of options.threads workers. sink sees each
+// finished game on its worker, so concurrently; the record is reused once it returns.
+MatchStats playMatch(const std::vector<std::string>& openings, const MatchOptions& options,
+                     const SelectorFactory& factory, const std::function<void(const GameRecord&)>& sink);
+
+// A game in a SelfPlay file: this header, then plies moves of 16 bits in Polyglot's encoding
+// (polyglot.h). The opening is the one the index picked from the match's list.
+struct PackedGameHeader {
+    uint32_t index;
+    uint8_t result;      // GameResult
+    uint8_t termination; // Termination
+    uint16_t plies;
+};
+
+// Appends the game to out, at most UINT16_MAX plies of it
+void packGame(const GameRecord& game, std::string& out);
+// Reads the game at the front of data and drops it from data, replaying the moves from opening to
+// get them back as Board moves. False, data untouched, if the game is cut short or does not replay.
+bool unpackGame(std::string_view& data, std::string_view opening, GameRecord& game);
+
+#endif //TEMPO_MATCH_H
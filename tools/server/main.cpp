@@ -0,0 +1,61 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "server.h"
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+static AnalysisServer* running = nullptr;
+
+static void onSignal(int) {
+    if (running) running->stop();
+}
+
+// Serves analysis requests until interrupted, e.g. `tempo-server -u /tmp/tempo.sock -t 8` or
+// `tempo-server -p 7878`. One JSON object per line in, one per line out:
+//   {"id":1,"op":"perft","fen":"<fen>","depth":5}        -> {"id":1,"ok":true,"nodes":4865609}
+//   {"id":2,"op":"legal","moves":["e2e4"]}               -> {"id":2,"ok":true,"moves":["b8a6",...]}
+//   {"id":3,"op":"validate","moves":"e2e4 e7e5 e1e3"}    -> {"id":3,"ok":true,"valid":false,"applied":2,...}
+//   {"id":4,"op":"eval","depth":8}                       -> {"id":4,"ok":true,"depth":8,"score":..,"best":..}
+//   {"op":"stats"}                                       -> queue depth, batches, busy, p50/p99 latency per op
+// Once -q requests are waiting, new ones get {"id":..,"ok":false,"error":"busy"}.
+int main(int argc, char** argv) {
+    const auto usage = [] {
+        std::cerr << "usage: tempo-server (-u socket | -p port) [-t threads] [-b batch] [-q queue] [-d max perft depth]" << std::endl;
+        return 1;
+    };
+    ServerOptions options;
+    std::string socketPath;
+    int port = -1;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) return usage();
+        const std::string arg = argv[i], value = argv[i + 1];
+        if (arg == "-u") socketPath = value;
+        else if (arg == "-p") port = std::stoi(value);
+        else if (arg == "-t") options.threads = std::stoul(value);
+        else if (arg == "-b") options.maxBatch = std::stoul(value);
+        else if (arg == "-q") options.maxQueue = std::stoul(value);
+        else if (arg == "-d") options.maxPerftDepth = std::stoi(value);
+        else return usage();
+    }
+    if (socketPath.empty() == (port < 0)) return usage();
+
+    AnalysisServer server(options);
+    const bool listening = socketPath.empty() ? server.listenTcp(uint16_t(port)) : server.listenUnix(socketPath);
+    if (!listening) {
+        std::cerr << "cannot listen on " << (socketPath.empty() ? "port " + std::to_string(port) : socketPath)
+                  << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    std::cout << "listening on " << (socketPath.empty() ? "127.0.0.1:" + std::to_string(server.port()) : socketPath)
+              << " with " << options.threads << " threads" << std::endl;
+
+    running = &server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    server.serve();
+    running = nullptr;
+    return 0;
+}
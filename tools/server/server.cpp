@@ -0,0 +1,512 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "server.h"
+#include "eval.h"
+#include "notation.h"
+#include "perft.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static constexpr size_t MAX_LINE = 1 << 16; // longer lines close the connection
+
+static constexpr std::string_view OP_NAMES[] = { "legal", "perft", "validate", "eval", "stats" };
+
+std::string_view opName(ServerOp op) { return OP_NAMES[size_t(op)]; }
+
+// ---------- JSON ----------
+
+namespace {
+
+// Just enough JSON for one flat request object; nested values under unknown keys are skipped
+struct JsonReader {
+    std::string_view s;
+    size_t i = 0;
+
+    void space() { while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) ++i; }
+    bool peek(char c) { space(); return i < s.size() && s[i] == c; }
+    bool eat(char c) {
+        if (!peek(c)) return false;
+        ++i;
+        return true;
+    }
+    bool atEnd() { space(); return i == s.size(); }
+
+    bool string(std::string& out) {
+        out.clear();
+        if (!eat('"')) return false;
+        while (i < s.size()) {
+            const char c = s[i++];
+            if (c == '"') return true;
+            if (uint8_t(c) < 0x20) return false;
+            if (c != '\\') { out += c; continue; }
+            if (i == s.size()) return false;
+            switch (const char e = s[i++]) {
+                case '"': case '\\': case '/': out += e; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    if (i + 4 > s.size() || std::from_chars(s.data() + i, s.data() + i + 4, code, 16).ptr != s.data() + i + 4)
+                        return false;
+                    i += 4;
+                    if (code < 0x80) out += char(code); // nothing here needs more than ASCII
+                    else out += '?';
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    // A number, true, false or null, as written
+    bool scalar(std::string_view& raw) {
+        space();
+        const size_t begin = i;
+        while (i < s.size() && (std::isalnum(uint8_t(s[i])) || s[i] == '-' || s[i] == '+' || s[i] == '.')) ++i;
+        raw = s.substr(begin, i - begin);
+        if (raw.empty()) return false;
+        if (raw == "true" || raw == "false" || raw == "null") return true;
+        double value;
+        return std::from_chars(raw.data(), raw.data() + raw.size(), value).ptr == raw.data() + raw.size();
+    }
+
+    bool skip(int nesting = 0) {
+        if (nesting > 16) return false;
+        std::string text;
+        std::string_view raw;
+        if (peek('"')) return string(text);
+        const char open = peek('{') ? '}' : peek('[') ? ']' : 0;
+        if (!open) return scalar(raw);
+        ++i;
+        if (eat(open)) return true;
+        do {
+            if (open == '}' && !(string(text) && eat(':'))) return false;
+            if (!skip(nesting + 1)) return false;
+        } while (eat(','));
+        return eat(open);
+    }
+};
+
+void appendEscaped(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (uint8_t(c) < 0x20) out += ' ';
+        else out += c;
+    }
+    out += '"';
+}
+
+std::string head(std::string_view id) {
+    std::string out = "{\"id\":";
+    out += id;
+    out += ",\"ok\":true";
+    return out;
+}
+
+}
+
+std::string parseRequest(std::string_view line, ServerRequest& request) {
+    request = ServerRequest();
+    JsonReader json { line };
+    if (!json.eat('{')) return "expected a JSON object";
+    std::string key, text, op;
+    std::string_view raw;
+    if (!json.eat('}')) {
+        do {
+            if (!json.string(key) || !json.eat(':')) return "malformed JSON";
+            if (key == "id") {
+                const size_t begin = (json.space(), json.i);
+                if (json.peek('"') ? !json.string(text) : !json.scalar(raw) || raw == "true" || raw == "false")
+                    return "id must be a number, string or null";
+                request.id = std::string(line.substr(begin, json.i - begin));
+            } else if (key == "op") {
+                if (!json.string(op)) return "op must be a string";
+            } else if (key == "fen") {
+                if (!json.string(request.fen)) return "fen must be a string";
+            } else if (key == "depth") {
+                if (!json.scalar(raw) || std::from_chars(raw.data(), raw.data() + raw.size(), request.depth).ptr !=
+                                         raw.data() + raw.size() || request.depth < 0)
+                    return "depth must be a non-negative integer";
+            } else if (key == "moves") {
+                // ["e2e4", "e7e5"] or "e2e4 e7e5"
+                if (json.peek('"')) {
+                    if (!json.string(text)) return "malformed JSON";
+                    for (size_t pos = 0; (pos = text.find_first_not_of(' ', pos)) != std::string::npos;) {
+                        const size_t end = std::min(text.find(' ', pos), text.size());
+                        request.moves.push_back(text.substr(pos, end - pos));
+                        pos = end;
+                    }
+                } else {
+                    if (!json.eat('[')) return "moves must be an array of strings";
+                    if (!json.eat(']')) {
+                        do {
+                            if (!json.string(text)) return "moves must be an array of strings";
+                            request.moves.push_back(text);
+                        } while (json.eat(','));
+                        if (!json.eat(']')) return "malformed JSON";
+                    }
+                }
+            } else if (!json.skip()) {
+                return "malformed JSON";
+            }
+        } while (json.eat(','));
+        if (!json.eat('}')) return "malformed JSON";
+    }
+    if (!json.atEnd()) return "trailing characters after the object";
+    const auto it = std::find(std::begin(OP_NAMES), std::end(OP_NAMES), op);
+    if (it == std::end(OP_NAMES)) return "unknown op";
+    request.op = ServerOp(it - std::begin(OP_NAMES));
+    return "";
+}
+
+// ---------- Answers ----------
+
+std::string errorResponse(std::string_view id, std::string_view error) {
+    std::string out = "{\"id\":";
+    out += id;
+    out += ",\"ok\":false,\"error\":";
+    appendEscaped(out, error);
+    out += '}';
+    return out;
+}
+
+std::string respond(const ServerRequest& request, ServerWorker& worker, const ServerOptions& options) {
+    Board& board = worker.board;
+    if (!board.setFromFEN(request.fen.empty() ? START_FEN : request.fen)) return errorResponse(request.id, "bad FEN");
+
+    size_t applied = 0;
+    const std::string* illegal = nullptr;
+    for (const auto& uci : request.moves) {
+        const uint32_t m = moveFromUCI(board, uci);
+        if (m == Move::NONE) { illegal = &uci; break; }
+        board.move(m);
+        ++applied;
+    }
+
+    std::string out = head(request.id);
+    if (request.op == ServerOp::Validate) {
+        out += ",\"valid\":";
+        out += illegal ? "false" : "true";
+        out += ",\"applied\":" + std::to_string(applied);
+        if (illegal) {
+            out += ",\"illegal\":";
+            appendEscaped(out, *illegal);
+        }
+        return out + '}';
+    }
+    if (illegal) return errorResponse(request.id, "illegal move " + *illegal);
+
+    switch (request.op) {
+        case ServerOp::Legal: {
+            board.genLegalMoves(worker.moves);
+            out += ",\"moves\":[";
+            for (size_t i = 0; i < worker.moves.size(); ++i) {
+                if (i) out += ',';
+                out += '"' + moveToUCI(worker.moves[i]) + '"';
+            }
+            out += ']';
+            break;
+        }
+        case ServerOp::Perft: {
+            if (request.depth < 0 || request.depth > options.maxPerftDepth)
+                return errorResponse(request.id, "perft needs a depth from 0 to " + std::to_string(options.maxPerftDepth));
+            out += ",\"nodes\":" + std::to_string(Perft(board, uint8_t(request.depth)));
+            break;
+        }
+        case ServerOp::Eval: {
+            if (request.depth < 0) {
+                out += ",\"score\":" + std::to_string(evaluate(board));
+                break;
+            }
+            SearchLimits limits;
+            limits.depth = std::clamp(request.depth, 1, options.maxSearchDepth);
+            int score = 0;
+            const uint32_t best = worker.search.think(board, limits, [&](const SearchReport& r) { score = r.score; });
+            out += ",\"depth\":" + std::to_string(limits.depth) + ",\"score\":" + std::to_string(score);
+            out += ",\"best\":" + (best == Move::NONE ? std::string("null") : '"' + moveToUCI(best) + '"');
+            out += ",\"nodes\":" + std::to_string(worker.search.nodes());
+            break;
+        }
+        default:
+            return errorResponse(request.id, "unknown op");
+    }
+    return out + '}';
+}
+
+// ---------- Latency ----------
+
+// Bucket 0 holds 0 us; bucket 4 * log + q + 1 the q-th quarter of [2^log, 2^(log + 1))
+static size_t bucketOf(uint64_t us) {
+    if (us == 0) return 0;
+    const int log = std::bit_width(us) - 1;
+    const uint64_t quarter = log >= 2 ? (us >> (log - 2)) & 3 : (us << (2 - log)) & 3;
+    return std::min<size_t>(size_t(log) * 4 + quarter + 1, 127);
+}
+
+static uint64_t bucketEdge(size_t bucket) {
+    if (bucket == 0) return 0;
+    const size_t log = (bucket - 1) / 4, quarter = (bucket - 1) % 4;
+    return ((5 + quarter) << log) / 4;
+}
+
+void LatencyHistogram::record(uint64_t us) { counts[bucketOf(us)].fetch_add(1, std::memory_order_relaxed); }
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& c : counts) total += c.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p / 100 * double(total))));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKETS; ++b) {
+        seen += counts[b].load(std::memory_order_relaxed);
+        if (seen >= rank) return bucketEdge(b);
+    }
+    return bucketEdge(BUCKETS - 1);
+}
+
+// ---------- Server ----------
+
+// Closed when the reader and the last queued request of the connection are done with it
+struct AnalysisServer::Connection {
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { ::close(fd); }
+
+    // Whole lines only, so responses from several workers never interleave
+    void write(std::string_view data) {
+        std::lock_guard lock(mutex);
+        while (!data.empty()) {
+            const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return; // the client went away; its remaining answers are dropped
+            data.remove_prefix(size_t(n));
+        }
+    }
+
+    const int fd;
+    std::mutex mutex;
+};
+
+AnalysisServer::AnalysisServer(const ServerOptions& serverOptions) : options(serverOptions) {
+    options.threads = std::max(1u, options.threads);
+    options.maxBatch = std::max<size_t>(1, options.maxBatch);
+    options.maxQueue = std::max<size_t>(1, options.maxQueue);
+    for (unsigned t = 0; t < options.threads; ++t) workers.emplace_back([this] { workLoop(); });
+}
+
+AnalysisServer::~AnalysisServer() {
+    stop();
+    reapReaders(true);
+    {
+        std::lock_guard lock(queueMutex);
+        queue.clear();
+    }
+    queued.notify_all();
+    for (auto& worker : workers) worker.join();
+    if (listenFd >= 0) ::close(listenFd);
+    if (!unixPath.empty()) ::unlink(unixPath.c_str());
+}
+
+bool AnalysisServer::listenUnix(const std::string& path) {
+    sockaddr_un address {};
+    if (path.size() >= sizeof(address.sun_path)) { errno = ENAMETOOLONG; return false; }
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0 || ::listen(fd, 64) != 0) {
+        ::close(fd);
+        return false;
+    }
+    listenFd = fd;
+    unixPath = path;
+    return true;
+}
+
+bool AnalysisServer::listenTcp(uint16_t port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    const int yes = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof address;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0 || ::listen(fd, 64) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        ::close(fd);
+        return false;
+    }
+    listenFd = fd;
+    boundPort = ntohs(address.sin_port);
+    return true;
+}
+
+void AnalysisServer::stop() {
+    stopping.store(true);
+    if (listenFd >= 0) ::shutdown(listenFd, SHUT_RDWR); // wakes accept
+}
+
+void AnalysisServer::serve() {
+    while (!stopping.load()) {
+        const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        if (stopping.load()) { ::close(fd); break; }
+        reapReaders(false);
+        auto connection = std::make_shared<Connection>(fd);
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        readers.push_back({ std::thread([this, connection, done] { readLoop(connection, done); }), connection, done });
+    }
+    reapReaders(true);
+}
+
+void AnalysisServer::reapReaders(bool all) {
+    for (auto it = readers.begin(); it != readers.end();) {
+        if (!all && !it->done->load()) { ++it; continue; }
+        ::shutdown(it->connection->fd, SHUT_RD); // ends the read of a reader still waiting
+        it->thread.join();
+        it = readers.erase(it);
+    }
+}
+
+void AnalysisServer::readLoop(std::shared_ptr<Connection> connection, std::shared_ptr<std::atomic<bool>> done) {
+    std::string buffer;
+    char chunk[4096];
+    for (;;) {
+        const ssize_t n = ::recv(connection->fd, chunk, sizeof chunk, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        buffer.append(chunk, size_t(n));
+
+        size_t begin = 0;
+        std::vector<Pending> parsed;
+        for (size_t end; (end = buffer.find('\n', begin)) != std::string::npos; begin = end + 1) {
+            const std::string_view line = std::string_view(buffer).substr(begin, end - begin);
+            if (line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+            Pending pending { connection, {} };
+            if (const std::string error = parseRequest(line, pending.request); !error.empty()) {
+                connection->write(errorResponse(pending.request.id, error) + '\n');
+                continue;
+            }
+            pending.request.received = std::chrono::steady_clock::now();
+            if (pending.request.op == ServerOp::Stats) connection->write(stats(pending.request.id) + '\n');
+            else parsed.push_back(std::move(pending));
+        }
+        buffer.erase(0, begin);
+        if (buffer.size() > MAX_LINE) {
+            connection->write(errorResponse("null", "line too long") + '\n');
+            break;
+        }
+        if (!parsed.empty()) {
+            size_t pushed = 0;
+            {
+                std::lock_guard lock(queueMutex);
+                for (; pushed < parsed.size() && queue.size() < options.maxQueue; ++pushed)
+                    queue.push_back(std::move(parsed[pushed]));
+            }
+            if (pushed > 1) queued.notify_all();
+            else if (pushed) queued.notify_one();
+            if (pushed < parsed.size()) {
+                std::string busy;
+                for (size_t i = pushed; i < parsed.size(); ++i) busy += errorResponse(parsed[i].request.id, "busy") + '\n';
+                rejected.fetch_add(parsed.size() - pushed, std::memory_order_relaxed);
+                connection->write(busy);
+            }
+        }
+    }
+    done->store(true);
+}
+
+void AnalysisServer::workLoop() {
+    ServerWorker worker;
+    worker.moves.reserve(256);
+    std::vector<Pending> batch;
+    std::vector<std::string> answers;
+    const auto expensive = [&](const ServerRequest& request) {
+        return (request.op == ServerOp::Perft && request.depth > options.maxBatchedPerftDepth) ||
+               (request.op == ServerOp::Eval && request.depth > options.maxBatchedSearchDepth);
+    };
+    for (;;) {
+        batch.clear();
+        {
+            std::unique_lock lock(queueMutex);
+            queued.wait(lock, [&] { return !queue.empty() || stopping.load(); });
+            if (queue.empty()) return;
+            // A batch of cheap requests stops short of an expensive one, which goes alone
+            size_t n = 1;
+            if (!expensive(queue.front().request))
+                while (n < std::min(queue.size(), options.maxBatch) && !expensive(queue[n].request)) ++n;
+            std::move(queue.begin(), queue.begin() + n, std::back_inserter(batch));
+            queue.erase(queue.begin(), queue.begin() + n);
+        }
+        batches.fetch_add(1, std::memory_order_relaxed);
+
+        answers.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) answers[i] = respond(batch[i].request, worker, options) + '\n';
+
+        // Latency runs until the answers are ready to send, so a client that has read one already
+        // finds it in the stats
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto& p : batch) {
+            const auto us = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(now - p.request.received).count());
+            latency.record(us);
+            opLatency[size_t(p.request.op)].record(us);
+        }
+        // One write per connection in the batch
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!batch[i].connection) continue;
+            std::string out = std::move(answers[i]);
+            for (size_t j = i + 1; j < batch.size(); ++j)
+                if (batch[j].connection == batch[i].connection) { out += answers[j]; batch[j].connection.reset(); }
+            batch[i].connection->write(out);
+            batch[i].connection.reset();
+        }
+    }
+}
+
+std::string AnalysisServer::stats(std::string_view id) const {
+    size_t depth;
+    {
+        std::lock_guard lock(queueMutex);
+        depth = queue.size();
+    }
+    const auto summary = [](const LatencyHistogram& h) {
+        return "\"count\":" + std::to_string(h.count()) + ",\"p50_us\":" + std::to_string(h.percentile(50)) +
+               ",\"p99_us\":" + std::to_string(h.percentile(99));
+    };
+    std::string out = head(id);
+    out += ",\"queue\":" + std::to_string(depth) + ",\"threads\":" + std::to_string(options.threads);
+    out += ",\"batches\":" + std::to_string(batches.load(std::memory_order_relaxed));
+    out += ",\"busy\":" + std::to_string(rejected.load(std::memory_order_relaxed)) + ',' + summary(latency);
+    out += ",\"ops\":{";
+    for (size_t op = 0; op < size_t(ServerOp::Stats); ++op) {
+        if (op) out += ',';
+        out += '"' + std::string(OP_NAMES[op]) + "\":{" + summary(opLatency[op]) + '}';
+    }
+    return out + "}}";
+}
@@ -0,0 +1,137 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_SERVER_H
+#define TEMPO_SERVER_H
+
+#include "board.h"
+#include "search.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class ServerOp : uint8_t { Legal, Perft, Validate, Eval, Stats, OP_N };
+
+std::string_view opName(ServerOp op);
+
+// One line of input, e.g. {"id":7,"op":"perft","fen":"...","moves":["e2e4"],"depth":4}. The FEN
+// defaults to the initial position and moves are played on it first; validate reports how far
+// they get instead of failing.
+struct ServerRequest {
+    std::string id = "null"; // echoed as given: a JSON number, string or null
+    ServerOp op = ServerOp::OP_N;
+    std::string fen;
+    std::vector<std::string> moves;
+    int depth = -1; // perft depth, or search depth for eval (static eval when not given)
+    std::chrono::steady_clock::time_point received;
+};
+
+// Empty on success, else what is wrong with the line; id is filled in whenever it was readable
+std::string parseRequest(std::string_view line, ServerRequest& request);
+
+struct ServerOptions {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxBatch = 32;    // requests a worker takes off the queue at once
+    size_t maxQueue = 4096;  // requests waiting for a worker; more are answered "busy"
+    int maxPerftDepth = 7;
+    int maxSearchDepth = 16;
+    // Deeper perft and eval requests are taken off the queue alone rather than in a batch
+    int maxBatchedPerftDepth = 4;
+    int maxBatchedSearchDepth = 8;
+};
+
+// What a worker thread keeps between requests, so answering one allocates little
+struct ServerWorker {
+    Board board = Board();
+    Search search;
+    MoveList moves;
+};
+
+// The response line for a request, without the newline
+std::string respond(const ServerRequest& request, ServerWorker& worker, const ServerOptions& options);
+std::string errorResponse(std::string_view id, std::string_view error);
+
+// Latencies in microseconds, every power of two split into four buckets, up to about 70 minutes.
+// Lock-free; a percentile is the upper edge of the bucket it falls in, at most 25% above the truth.
+class LatencyHistogram {
+public:
+    void record(uint64_t us);
+    uint64_t count() const;
+    uint64_t percentile(double p) const;
+
+private:
+    static constexpr size_t BUCKETS = 128;
+    std::array<std::atomic<uint64_t>, BUCKETS> counts {};
+};
+
+// Newline-delimited JSON analysis over a Unix domain socket or localhost TCP. A reader thread per
+// connection parses lines onto one queue of at most maxQueue requests, answering the rest "busy";
+// worker threads, each with its own board, take up to maxBatch cheap requests at a time and write
+// the responses back as each batch finishes, one write per connection. A deep perft or eval is
+// taken alone, so the cheap answers are not held back behind it. Responses carry the request id
+// and may come back out of order. {"op":"stats"} is answered by the reader straight away, with
+// queue depth, busy answers and p50/p99 latencies overall and per op.
+class AnalysisServer {
+public:
+    explicit AnalysisServer(const ServerOptions& options = {});
+    ~AnalysisServer();
+    AnalysisServer(const AnalysisServer&) = delete;
+    AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+    // Binds the listening socket; false (and errno) on failure. A stale socket file is replaced.
+    bool listenUnix(const std::string& path);
+    bool listenTcp(uint16_t port); // 127.0.0.1 only; port 0 picks a free one, see port()
+    uint16_t port() const { return boundPort; }
+
+    // Accepts connections until stop(), then closes them. Must have returned before destruction.
+    void serve();
+    // From any thread, a signal handler included
+    void stop();
+
+    std::string stats(std::string_view id = "null") const;
+
+private:
+    struct Connection;
+    struct Pending {
+        std::shared_ptr<Connection> connection;
+        ServerRequest request;
+    };
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<Connection> connection;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    void readLoop(std::shared_ptr<Connection> connection, std::shared_ptr<std::atomic<bool>> done);
+    void workLoop();
+    void reapReaders(bool all);
+
+    ServerOptions options;
+    int listenFd = -1;
+    std::string unixPath;
+    uint16_t boundPort = 0;
+    std::atomic<bool> stopping { false };
+
+    mutable std::mutex queueMutex;
+    std::condition_variable queued;
+    std::deque<Pending> queue;
+    std::vector<std::thread> workers;
+    std::vector<Reader> readers;
+
+    std::atomic<uint64_t> batches { 0 };
+    std::atomic<uint64_t> rejected { 0 };
+    LatencyHistogram latency;
+    std::array<LatencyHistogram, size_t(ServerOp::OP_N)> opLatency;
+};
+
+#endif //TEMPO_SERVER_H
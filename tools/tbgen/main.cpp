@@ -0,0 +1,35 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "generator.h"
+#include <iostream>
+
+// Generates endgame tables, e.g. `TBGen -d tb -t 8 KQvKR KRPvKR`.
+// Tables already present in the directory are reused for captures and promotions.
+int main(int argc, char** argv) {
+    TBGenOptions options;
+    std::vector<std::string> names;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-d" && i + 1 < argc) options.dir = argv[++i];
+        else if (arg == "-t" && i + 1 < argc) options.threads = std::stoul(argv[++i]);
+        else names.push_back(arg);
+    }
+    if (names.empty()) {
+        std::cerr << "usage: TBGen [-d dir] [-t threads] KQvK KRvKN ..." << std::endl;
+        return 1;
+    }
+
+    Tablebase tb;
+    tb.openDirectory(options.dir);
+    for (const auto& name : names) {
+        TBMaterial material;
+        if (!TBMaterial::parse(name, material)) {
+            std::cerr << name << ": expected a signature such as KRPvKR of at most " << int(TB_MAX_PIECES) << " pieces" << std::endl;
+            return 1;
+        }
+        if (!generateTable(name, tb, options)) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "tuner.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// Tunes the eval weights on labeled positions, e.g. `Tune -e 50 -l 0.5 -o weights.txt data/run1-*.bin`.
+// Inputs ending in .bin are DataGen shards, anything else is text of FEN [result] or EPD c9 lines.
+// The tuned material and tables are printed in eval.cpp's layout.
+int main(int argc, char** argv) {
+    TunerOptions options;
+    unsigned threads = 0, epochs = 20;
+    std::string outPath;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) threads = std::stoul(argv[++i]);
+        else if (arg == "-e" && i + 1 < argc) epochs = std::stoul(argv[++i]);
+        else if (arg == "-r" && i + 1 < argc) options.learningRate = std::stod(argv[++i]);
+        else if (arg == "-b" && i + 1 < argc) options.batchSize = std::stoull(argv[++i]);
+        else if (arg == "-l" && i + 1 < argc) options.lambda = std::stod(argv[++i]);
+        else if (arg == "-k" && i + 1 < argc) options.scale = std::stod(argv[++i]);
+        else if (arg == "-seed" && i + 1 < argc) options.seed = std::stoull(argv[++i]);
+        else if (arg == "-o" && i + 1 < argc) outPath = argv[++i];
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        std::cerr << "usage: Tune [-t threads] [-e epochs] [-r rate] [-b batch] [-l lambda] [-k scale] [-seed n] "
+                     "[-o weights.txt] data..." << std::endl;
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    const auto seconds = [&] {
+        const auto now = std::chrono::steady_clock::now();
+        const double s = std::chrono::duration<double>(now - begin).count();
+        begin = now;
+        return s;
+    };
+    TuningSet set;
+    for (const auto& path : inputs) {
+        uint64_t skipped = 0;
+        const bool binary = path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+        if (!(binary ? set.loadRecords(path, &skipped) : set.loadText(path, &skipped))) {
+            std::cerr << "cannot read " << path << std::endl;
+            return 1;
+        }
+        if (skipped) std::cerr << path << ": " << skipped << (binary ? " records" : " lines") << " skipped" << std::endl;
+    }
+    std::cout << set.size() << " positions loaded in " << seconds() << " s" << std::endl;
+    if (set.size() == 0) return 1;
+
+    ThreadPool pool(threads);
+    Tuner tuner(set, pool, defaultEvalWeights(), options);
+    std::cout << "K " << tuner.scale() << " error " << tuner.error() << " on " << pool.size() << " threads" << std::endl;
+    seconds();
+    for (unsigned e = 1; e <= epochs; ++e) {
+        const double error = tuner.epoch();
+        std::cout << "epoch " << e << " error " << error << " in " << seconds() << " s" << std::endl;
+    }
+    std::cout << "final error " << tuner.error() << std::endl;
+
+    if (outPath.empty()) printEvalWeights(std::cout, tuner.weights());
+    else {
+        std::ofstream out(outPath);
+        printEvalWeights(out, tuner.weights());
+        if (!out) {
+            std::cerr << "cannot write " << outPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,271 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#include "tuner.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+static constexpr uint16_t WEIGHT_MASK = TuningSet::BLACK_PIECE - 1;
+
+static uint16_t feature(uint8_t code, uint8_t square) {
+    return code < PIECE_TYPE_N ? uint16_t(code * NUM_SQUARES + square)
+                               : uint16_t(TuningSet::BLACK_PIECE | ((code - PIECE_TYPE_N) * NUM_SQUARES + (square ^ 56)));
+}
+
+void TuningSet::push(const uint16_t* begin, uint8_t count, uint8_t points, int16_t whiteScore) {
+    if (counts.size() % BLOCK == 0) blockStart.push_back(features.size());
+    features.insert(features.end(), begin, begin + count);
+    for (uint8_t i = 0; i < count; ++i) ++occurrences[begin[i] & WEIGHT_MASK];
+    counts.push_back(count);
+    halfPoints.push_back(points);
+    scores.push_back(whiteScore);
+}
+
+void TuningSet::add(const Board& board, uint8_t points, int16_t whiteScore) {
+    uint16_t buffer[NUM_SQUARES];
+    uint8_t n = 0;
+    for (uint8_t code = 0; code < 2 * PIECE_TYPE_N; ++code)
+        forEachSetBit(board.bb[code], [&](uint8_t square) { buffer[n++] = feature(code, square); });
+    push(buffer, n, points, whiteScore);
+}
+
+bool TuningSet::add(const TrainingRecord& record) {
+    // Piece codes become weight indices, so a foreign or corrupt record must not get through
+    if (!isValidRecord(record)) return false;
+    uint16_t buffer[32];
+    uint8_t n = 0;
+    forEachSetBit(record.occupancy, [&](uint8_t square) {
+        buffer[n] = feature((record.pieces[n / 2] >> (n % 2 * 4)) & 0xF, square);
+        ++n;
+    });
+    push(buffer, n, record.result, record.score);
+    return true;
+}
+
+bool TuningSet::loadRecords(const std::string& path, uint64_t* skipped) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::vector<TrainingRecord> block(1 << 16);
+    uint64_t bad = 0;
+    for (size_t n; (n = std::fread(block.data(), sizeof(TrainingRecord), block.size(), file)) > 0;)
+        for (size_t i = 0; i < n; ++i) bad += !add(block[i]);
+    const bool ok = !std::ferror(file);
+    std::fclose(file);
+    if (skipped) *skipped = bad;
+    return ok;
+}
+
+// Half points for white from a result as written in the labels, -1 if unknown
+static int parseResult(std::string_view label) {
+    if (label == "1.0" || label == "1" || label == "1-0") return 2;
+    if (label == "0.5" || label == "1/2-1/2") return 1;
+    if (label == "0.0" || label == "0" || label == "0-1") return 0;
+    return -1;
+}
+
+bool TuningSet::loadText(const std::string& path, uint64_t* skipped) {
+    std::ifstream in(path);
+    if (!in) return false;
+    Board board = Board();
+    std::string line;
+    uint64_t bad = 0;
+    while (std::getline(in, line)) {
+        const std::string_view text = line;
+        if (text.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+        int points = -1;
+        if (const size_t open = text.find('['); open != std::string_view::npos) {
+            const size_t close = text.find(']', open);
+            if (close != std::string_view::npos && board.setFromFEN(text.substr(0, open)))
+                points = parseResult(text.substr(open + 1, close - open - 1));
+        } else if (std::string_view operations; board.setFromEPD(text, &operations)) {
+            const size_t c9 = operations.find("c9 \"");
+            const size_t end = c9 == std::string_view::npos ? c9 : operations.find('"', c9 + 4);
+            if (end != std::string_view::npos) points = parseResult(operations.substr(c9 + 4, end - c9 - 4));
+        }
+        if (points < 0) ++bad;
+        else add(board, uint8_t(points));
+    }
+    if (skipped) *skipped = bad;
+    return !in.bad();
+}
+
+int TuningSet::evaluate(size_t position, const EvalWeights& weights) const {
+    const size_t block = position / BLOCK;
+    uint64_t offset = blockStart[block];
+    for (size_t p = block * BLOCK; p < position; ++p) offset += counts[p];
+    int score = 0;
+    for (uint8_t i = 0; i < counts[position]; ++i) {
+        const uint16_t f = features[offset + i];
+        const size_t type = (f & WEIGHT_MASK) / NUM_SQUARES, square = f % NUM_SQUARES;
+        const int weight = weights.material[type] + weights.pst[type][square];
+        score += f & BLACK_PIECE ? -weight : weight;
+    }
+    return score;
+}
+
+// ---------- Tuner ----------
+
+static double sigmoid(double x) { return 1 / (1 + std::exp(-x)); }
+
+Tuner::Tuner(const TuningSet& set, ThreadPool& pool, const EvalWeights& start, const TunerOptions& options) :
+        set(set), pool(pool), options(options), start(start), k(options.scale), rng(options.seed),
+        order(set.blocks()), sums(pool.size()) {
+    for (size_t type = 0; type < PIECE_TYPE_N; ++type)
+        for (size_t square = 0; square < NUM_SQUARES; ++square)
+            params[type * NUM_SQUARES + square] = float(start.material[type] + start.pst[type][square]);
+    for (size_t b = 0; b < order.size(); ++b) order[b] = uint32_t(b);
+    // K is fitted to the results alone, as the score half of the target depends on it
+    if (k <= 0) {
+        computeTargets(1.0);
+        k = fitScale();
+    }
+    computeTargets(options.lambda);
+}
+
+void Tuner::computeTargets(double lambda) {
+    targets.resize(set.size());
+    for (size_t p = 0; p < set.size(); ++p) {
+        const double result = set.halfPoints[p] / 2.0;
+        targets[p] = float(set.scores[p] == NO_SCORE ? result
+                                                     : lambda * result + (1 - lambda) * sigmoid(k * set.scores[p] / 400));
+    }
+}
+
+double Tuner::pass(size_t first, size_t last, bool withGradient, uint64_t& positions) {
+    for (auto& s : sums) {
+        if (withGradient) s.gradient.fill(0);
+        s.error = 0;
+        s.positions = 0;
+    }
+    const float c = float(k / 400);
+    pool.forEach(last - first, [&](unsigned worker, size_t item) {
+        WorkerSums& s = sums[worker];
+        const size_t block = order[first + item];
+        const size_t begin = block * TuningSet::BLOCK, end = std::min(begin + TuningSet::BLOCK, set.size());
+        const uint16_t* f = set.features.data() + set.blockStart[block];
+        double error = 0;
+        for (size_t p = begin; p < end; ++p) {
+            const uint8_t n = set.counts[p];
+            float eval = 0;
+            for (uint8_t i = 0; i < n; ++i) {
+                const float w = params[f[i] & WEIGHT_MASK];
+                eval += f[i] & TuningSet::BLACK_PIECE ? -w : w;
+            }
+            const float q = 1 / (1 + std::exp(-c * eval));
+            const float d = q - targets[p];
+            error += d * d;
+            if (withGradient) {
+                // d(q - t)^2 / d eval; each feature's weight moves eval by +-1
+                const float g = 2 * d * q * (1 - q) * c;
+                for (uint8_t i = 0; i < n; ++i) s.gradient[f[i] & WEIGHT_MASK] += f[i] & TuningSet::BLACK_PIECE ? -g : g;
+            }
+            f += n;
+        }
+        s.error += error;
+        s.positions += end - begin;
+    });
+    double error = 0;
+    positions = 0;
+    if (withGradient) gradient.fill(0);
+    for (const auto& s : sums) {
+        error += s.error;
+        positions += s.positions;
+        if (withGradient)
+            for (size_t i = 0; i < TUNER_PARAMS; ++i) gradient[i] += s.gradient[i];
+    }
+    return error;
+}
+
+double Tuner::error() {
+    uint64_t positions;
+    const double sum = pass(0, order.size(), false, positions);
+    return positions ? sum / double(positions) : 0;
+}
+
+// Golden section search for the K that best fits the starting weights to the targets
+double Tuner::fitScale() {
+    const auto errorAt = [&](double scale) { k = scale; return error(); };
+    const double ratio = (std::sqrt(5.0) - 1) / 2;
+    double low = 0.05, high = 10;
+    double x1 = high - ratio * (high - low), x2 = low + ratio * (high - low);
+    double e1 = errorAt(x1), e2 = errorAt(x2);
+    for (int i = 0; i < 40; ++i) {
+        if (e1 < e2) {
+            high = x2; x2 = x1; e2 = e1;
+            x1 = high - ratio * (high - low);
+            e1 = errorAt(x1);
+        } else {
+            low = x1; x1 = x2; e1 = e2;
+            x2 = low + ratio * (high - low);
+            e2 = errorAt(x2);
+        }
+    }
+    return (low + high) / 2;
+}
+
+double Tuner::epoch() {
+    std::shuffle(order.begin(), order.end(), rng);
+    const size_t batchBlocks = options.batchSize ? (options.batchSize + TuningSet::BLOCK - 1) / TuningSet::BLOCK : order.size();
+    double error = 0;
+    uint64_t total = 0;
+    for (size_t first = 0; first < order.size(); first += batchBlocks) {
+        uint64_t positions;
+        error += pass(first, std::min(first + batchBlocks, order.size()), true, positions);
+        total += positions;
+        ++steps;
+        const double correction1 = 1 - std::pow(options.beta1, double(steps));
+        const double correction2 = 1 - std::pow(options.beta2, double(steps));
+        for (size_t i = 0; i < TUNER_PARAMS; ++i) {
+            const double g = gradient[i] / double(positions);
+            m[i] = options.beta1 * m[i] + (1 - options.beta1) * g;
+            v[i] = options.beta2 * v[i] + (1 - options.beta2) * g * g;
+            params[i] -= float(options.learningRate * (m[i] / correction1) / (std::sqrt(v[i] / correction2) + 1e-8));
+        }
+    }
+    return total ? error / double(total) : 0;
+}
+
+EvalWeights Tuner::weights() const {
+    EvalWeights out = start;
+    for (size_t type = 0; type < PIECE_TYPE_N; ++type) {
+        // Mean change of the type's weights over the squares seen, taken as the change in material
+        double change = 0;
+        size_t seen = 0;
+        for (size_t square = 0; square < NUM_SQUARES; ++square)
+            if (set.occurrences[type * NUM_SQUARES + square]) {
+                change += params[type * NUM_SQUARES + square] - (start.material[type] + start.pst[type][square]);
+                ++seen;
+            }
+        if (!seen) continue;
+        change /= double(seen);
+        // The king's weights carry a free constant, both kings always being on the board
+        const int material = type == PIECE_TYPE_N - 1 ? 0 : int(std::lround(start.material[type] + change));
+        const double shift = type == PIECE_TYPE_N - 1 ? change : material;
+        out.material[type] = int16_t(material);
+        for (size_t square = 0; square < NUM_SQUARES; ++square)
+            if (set.occurrences[type * NUM_SQUARES + square])
+                out.pst[type][square] = int16_t(std::lround(params[type * NUM_SQUARES + square] - shift));
+    }
+    return out;
+}
+
+void printEvalWeights(std::ostream& out, const EvalWeights& weights) {
+    static constexpr const char* NAMES[PIECE_TYPE_N] = { "pawn", "rook", "knight", "bishop", "queen", "king" };
+    out << "material = {";
+    for (size_t type = 0; type < PIECE_TYPE_N; ++type) out << (type ? ", " : " ") << weights.material[type];
+    out << " };\n";
+    for (size_t type = 0; type < PIECE_TYPE_N; ++type) {
+        out << "{ // " << NAMES[type] << '\n';
+        for (int rank = 7; rank >= 0; --rank) {
+            out << "    ";
+            for (int file = 7; file >= 0; --file)
+                out << std::setw(4) << weights.pst[type][sq(file, rank)] << (rank || file ? "," : " },");
+            out << '\n';
+        }
+    }
+}
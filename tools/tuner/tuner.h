@@ -0,0 +1,124 @@
+//
+// Created by Kaveh Fayyazi on 10/19/26.
+//
+
+#ifndef TEMPO_TUNER_H
+#define TEMPO_TUNER_H
+
+#include "board.h"
+#include "eval.h"
+#include "threadpool.h"
+#include "training.h"
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// The linear eval of eval.h has one weight per (piece type, square) once material is folded into
+// its piece's table: white pieces count +weight[type][square], black ones -weight[type][square ^ 56].
+inline constexpr size_t TUNER_PARAMS = PIECE_TYPE_N * NUM_SQUARES;
+inline constexpr int16_t NO_SCORE = INT16_MIN; // positions labeled with a result only
+
+// Labeled positions held as their eval features. A position is its feature count, then one
+// 16-bit feature per piece: the weight index, with the top bit set for black pieces. At about 60
+// bytes a position, tens of millions fit in a few GB. Positions are grouped into blocks of BLOCK,
+// the unit the tuner shuffles and hands to threads.
+class TuningSet {
+public:
+    static constexpr size_t BLOCK = 1024;
+    static constexpr uint16_t BLACK_PIECE = 0x8000;
+
+    // halfPoints: 0 loss, 1 draw, 2 win for white; whiteScore a search score in centipawns from
+    // white's point of view, or NO_SCORE
+    void add(const Board& board, uint8_t halfPoints, int16_t whiteScore = NO_SCORE);
+    // False, adding nothing, for a record isValidRecord rejects
+    bool add(const TrainingRecord& record);
+
+    // A shard of TrainingRecords as written by DataGen; records that do not hold a position are
+    // counted in skipped. False if the file cannot be read.
+    bool loadRecords(const std::string& path, uint64_t* skipped = nullptr);
+    // One position a line: `<fen> [1.0]` (also [0.5], [0.0], [1-0], [1/2-1/2], [0-1]), or EPD with
+    // the result in a c9 operation, `<epd> c9 "1-0";`. Lines that do not parse are counted in
+    // skipped. False if the file cannot be read.
+    bool loadText(const std::string& path, uint64_t* skipped = nullptr);
+
+    size_t size() const { return counts.size(); }
+    size_t blocks() const { return blockStart.size(); }
+    // The linear eval of a stored position, what evaluate() gives with white to move
+    int evaluate(size_t position, const EvalWeights& weights) const;
+
+private:
+    friend class Tuner;
+
+    void push(const uint16_t* begin, uint8_t count, uint8_t halfPoints, int16_t whiteScore);
+
+    std::vector<uint16_t> features;
+    std::vector<uint8_t> counts;
+    std::vector<uint64_t> blockStart; // offset into features of each block's first position
+    std::vector<uint8_t> halfPoints;
+    std::vector<int16_t> scores;
+    std::array<uint64_t, TUNER_PARAMS> occurrences{}; // positions using each weight
+};
+
+struct TunerOptions {
+    double learningRate = 1.0;      // Adam step in centipawns
+    double beta1 = 0.9, beta2 = 0.999;
+    size_t batchSize = 1 << 16;     // positions per step, rounded up to whole blocks; 0 for all
+    double lambda = 1.0;            // weight of the game result against the search score in the target
+    double scale = 0;               // K of sigmoid(K * eval / 400); 0 fits it to the starting weights
+    uint64_t seed = 0;              // block order of each epoch
+};
+
+// Texel tuning: fits the weights so that sigmoid(K * eval / 400) predicts each position's target,
+// the game result blended with the sigmoid of its search score, by Adam on the mean squared error.
+// Every step spreads the set's blocks over the pool, each worker summing its own gradient.
+class Tuner {
+public:
+    Tuner(const TuningSet& set, ThreadPool& pool, const EvalWeights& start = defaultEvalWeights(),
+          const TunerOptions& options = {});
+
+    // One pass over the set in a new random block order, an Adam step per batch. Returns the mean
+    // error seen during the pass, each batch measured just before its step.
+    double epoch();
+    // Mean error of the current weights over the whole set
+    double error();
+    double scale() const { return k; }
+
+    // The tuned weights split back into material and tables: a type's material moves by the mean
+    // change of its weights over the squares it was seen on, the king's stays 0; squares never seen
+    // keep their starting table value.
+    EvalWeights weights() const;
+
+private:
+    struct alignas(64) WorkerSums {
+        std::array<double, TUNER_PARAMS> gradient;
+        double error;
+        uint64_t positions;
+    };
+
+    double fitScale();
+    void computeTargets(double lambda);
+    // Squared error summed over the blocks order[first, last), and the gradient when asked for
+    double pass(size_t first, size_t last, bool gradient, uint64_t& positions);
+
+    const TuningSet& set;
+    ThreadPool& pool;
+    TunerOptions options;
+    EvalWeights start;
+    double k;
+    uint64_t steps = 0;
+    std::mt19937_64 rng;
+
+    std::array<float, TUNER_PARAMS> params;
+    std::array<double, TUNER_PARAMS> m{}, v{}, gradient{};
+    std::vector<float> targets;
+    std::vector<uint32_t> order;
+    std::vector<WorkerSums> sums;
+};
+
+// Weights as eval.cpp prints them, material then each table rank 8 first, to paste over its defaults
+void printEvalWeights(std::ostream& out, const EvalWeights& weights);
+
+#endif //TEMPO_TUNER_H